@@ -15,6 +15,7 @@ APU::APU(shared_ptr<Console> console)
 	_nesModel = NesModel::Auto;
 	_apuEnabled = true;
 	_needToRun = false;
+	_nextEventCycle = 0;
 
 	_console = console;
 	_mixer = _console->GetSoundMixer();
@@ -146,6 +147,9 @@ void APU::Run()
 	//-When a DMC or FrameCounter interrupt needs to be fired
 	int32_t cyclesToRun = _currentCycle - _previousCycle;
 
+	//Register writes call this before changing the channels' state, check again on the next cycle
+	_nextEventCycle = 0;
+
 	while(cyclesToRun > 0) {
 		_previousCycle += _frameCounter->Run(cyclesToRun);
 
@@ -167,6 +171,7 @@ void APU::Run()
 void APU::SetNeedToRun()
 {
 	_needToRun = true;
+	_nextEventCycle = 0;
 }
 
 bool APU::NeedToRun(uint32_t currentCycle)
@@ -182,14 +187,27 @@ bool APU::NeedToRun(uint32_t currentCycle)
 	return _frameCounter->NeedToRun(cyclesToRun) || _deltaModulationChannel->IrqPending(cyclesToRun);
 }
 
+uint32_t APU::GetNextEventCycle()
+{
+	if(_needToRun) {
+		return _currentCycle + 1;
+	}
+
+	//Both delays are relative to _previousCycle, like the cyclesToRun value given to NeedToRun/IrqPending
+	uint64_t nextCycle = (uint64_t)_previousCycle + std::min(_frameCounter->GetCyclesUntilRun(), _deltaModulationChannel->GetCyclesUntilRun());
+	nextCycle = std::max<uint64_t>(nextCycle, _currentCycle + 1);
+	return (uint32_t)std::min<uint64_t>(nextCycle, SoundMixer::CycleLength - 1);
+}
+
 void APU::Exec()
 {
-	_currentCycle++;
+	//Called by ProcessCpuClock when _currentCycle reaches _nextEventCycle
 	if(_currentCycle == SoundMixer::CycleLength - 1) {
 		EndFrame();
 	} else if(NeedToRun(_currentCycle)) {
 		Run();
 	}
+	_nextEventCycle = GetNextEventCycle();
 }
 
 void APU::EndFrame()
@@ -207,18 +225,12 @@ void APU::EndFrame()
 	_previousCycle = 0;
 }
 
-void APU::ProcessCpuClock()
-{
-	if(_apuEnabled) {
-		Exec();
-	}
-}
-
 void APU::Reset(bool softReset)
 {
 	_apuEnabled = true;
 	_currentCycle = 0;
 	_previousCycle = 0;
+	_nextEventCycle = 0;
 	_squareChannel[0]->Reset(softReset);
 	_squareChannel[1]->Reset(softReset);
 	_triangleChannel->Reset(softReset);
@@ -235,6 +247,7 @@ void APU::StreamState(bool saving)
 	} else {
 		_previousCycle = 0;
 		_currentCycle = 0;
+		_nextEventCycle = 0;
 	}
 
 	SnapshotInfo squareChannel0{ _squareChannel[0].get() };
@@ -274,6 +287,7 @@ uint16_t APU::GetDmcReadAddress()
 void APU::SetDmcReadBuffer(uint8_t value)
 {
 	_deltaModulationChannel->SetDmcReadBuffer(value);
+	_nextEventCycle = 0;
 }
 
 ApuState APU::GetState()
@@ -28,6 +28,9 @@ class APU : public Snapshotable, public IMemoryHandler
 		uint32_t _previousCycle;
 		uint32_t _currentCycle;
 
+		//Next value of _currentCycle at which the frame counter/DMC/audio buffer need to be checked (0 = next cycle)
+		uint32_t _nextEventCycle;
+
 		unique_ptr<SquareChannel> _squareChannel[2];
 		unique_ptr<TriangleChannel> _triangleChannel;
 		unique_ptr<NoiseChannel> _noiseChannel;
@@ -42,6 +45,7 @@ class APU : public Snapshotable, public IMemoryHandler
 
 	private:
 		__forceinline bool NeedToRun(uint32_t currentCycle);
+		uint32_t GetNextEventCycle();
 
 		void FrameCounterTick(FrameType type);
 		uint8_t GetStatus();
@@ -64,8 +68,17 @@ class APU : public Snapshotable, public IMemoryHandler
 		ApuState GetState();
 
 		void Exec();
-		void ProcessCpuClock();
 		void Run();
+
+		__forceinline void ProcessCpuClock()
+		{
+			if(_apuEnabled) {
+				_currentCycle++;
+				if(_currentCycle >= _nextEventCycle) {
+					Exec();
+				}
+			}
+		}
 		void EndFrame();
 
 		void AddExpansionAudioDelta(AudioChannel channel, int16_t delta);
@@ -7,6 +7,7 @@ class AXROM : public BaseMapper
 	protected:
 		virtual uint16_t GetPRGPageSize() override { return 0x8000; }
 		virtual uint16_t GetCHRPageSize() override {	return 0x2000; }
+		bool AllowPpuCatchUp() override { return true; }
 
 		void InitMapper() override 
 		{
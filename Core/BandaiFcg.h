@@ -129,6 +129,8 @@ protected:
 				_console->GetCpu()->SetIrqSource(IRQSource::External);
 			}
 			_irqCounter--;
+		} else {
+			SuspendCpuClock();
 		}
 	}
 
@@ -35,6 +35,10 @@ void BaseControlDevice::InternalSetStateFromInput()
 void BaseControlDevice::StreamState(bool saving)
 {
 	auto lock = _stateLock.AcquireSafe();
+	if(saving && !IsRawString() && !GetKeyNames().empty()) {
+		//Include all of the device's buttons, otherwise the save state's size would depend on which buttons are pressed
+		EnsureCapacity((int32_t)GetKeyNames().size() - 1);
+	}
 	VectorInfo<uint8_t> state{ &_state.State };
 	Stream(_strobe, state);
 }
@@ -4,6 +4,7 @@
 #include "../Utilities/FolderUtilities.h"
 #include "../Utilities/IpsPatcher.h"
 #include "BaseMapper.h"
+#include "DirtyPageTracker.h"
 #include "Console.h"
 #include "CheatManager.h"
 #include "Debugger.h"
@@ -145,14 +146,14 @@ void BaseMapper::SetCpuMemoryMapping(uint16_t startAddr, uint16_t endAddr, uint8
 		return;
 	}
 
-	startAddr >>= 8;
-	endAddr >>= 8;
-	for(uint16_t i = startAddr; i <= endAddr; i++) {
+	for(uint16_t i = startAddr >> 8; i <= endAddr >> 8; i++) {
 		_prgPages[i] = source;
 		_prgMemoryAccess[i] = accessType != -1 ? (MemoryAccessType)accessType : MemoryAccessType::Read;
 
 		source += 0x100;
 	}
+
+	_console->GetMemoryManager()->UpdateDirectReadPages(startAddr, endAddr);
 }
 
 void BaseMapper::RemoveCpuMemoryMapping(uint16_t startAddr, uint16_t endAddr)
@@ -478,6 +479,7 @@ void BaseMapper::AddRegisterRange(uint16_t startAddr, uint16_t endAddr, MemoryOp
 			_isWriteRegisterAddr[i] = true;
 		}
 	}
+	UpdateRegisterPages(startAddr, endAddr);
 }
 
 void BaseMapper::RemoveRegisterRange(uint16_t startAddr, uint16_t endAddr, MemoryOperation operation)
@@ -490,6 +492,22 @@ void BaseMapper::RemoveRegisterRange(uint16_t startAddr, uint16_t endAddr, Memor
 			_isWriteRegisterAddr[i] = false;
 		}
 	}
+	UpdateRegisterPages(startAddr, endAddr);
+}
+
+void BaseMapper::UpdateRegisterPages(uint16_t startAddr, uint16_t endAddr)
+{
+	for(int page = startAddr >> 8; page <= endAddr >> 8; page++) {
+		_isReadRegisterPage[page] = false;
+		for(int i = 0; i < 0x100; i++) {
+			if(_isReadRegisterAddr[(page << 8) | i]) {
+				_isReadRegisterPage[page] = true;
+				break;
+			}
+		}
+	}
+
+	_console->GetMemoryManager()->UpdateDirectReadPages(startAddr, endAddr);
 }
 
 void BaseMapper::StreamState(bool saving)
@@ -513,6 +531,7 @@ void BaseMapper::StreamState(bool saving)
 
 	if(!saving) {
 		RestorePrgChrState();
+		ResumeCpuClock();
 	}
 }
 
@@ -556,8 +575,10 @@ void BaseMapper::Initialize(RomData &romData)
 	}
 
 	_allowRegisterRead = AllowRegisterRead();
+	_allowDirectPrgReads = AllowDirectPrgReads();
 
 	memset(_isReadRegisterAddr, 0, sizeof(_isReadRegisterAddr));
+	memset(_isReadRegisterPage, 0, sizeof(_isReadRegisterPage));
 	memset(_isWriteRegisterAddr, 0, sizeof(_isWriteRegisterAddr));
 	AddRegisterRange(RegisterStartAddress(), RegisterEndAddress(), MemoryOperation::Any);
 
@@ -753,6 +774,15 @@ uint8_t BaseMapper::ReadRAM(uint16_t addr)
 	return _console->GetMemoryManager()->GetOpenBus();
 }
 
+uint8_t* BaseMapper::GetDirectReadPage(uint8_t page)
+{
+	//Pages that contain readable registers (or that are unmapped) need to go through ReadRAM
+	if(!_allowDirectPrgReads || (_allowRegisterRead && _isReadRegisterPage[page]) || !(_prgMemoryAccess[page] & MemoryAccessType::Read)) {
+		return nullptr;
+	}
+	return _prgPages[page];
+}
+
 uint8_t BaseMapper::PeekRAM(uint16_t addr)
 {
 	return DebugReadRAM(addr);
@@ -780,6 +810,7 @@ void BaseMapper::WriteRAM(uint16_t addr, uint8_t value)
 			}
 			value &= prgValue;
 		}
+		ResumeCpuClock();
 		WriteRegister(addr, value);
 	} else {
 		WritePrgRam(addr, value);
@@ -841,11 +872,17 @@ void BaseMapper::DebugWriteVRAM(uint16_t addr, uint8_t value, bool disableSideEf
 		if(_chrPages[addr >> 8]) {
 			//Always allow writes when side-effects are disabled
 			_chrPages[addr >> 8][(uint8_t)addr] = value;
+			if(_dirtyPageTracker) {
+				MarkVramPageDirty(addr);
+			}
 		}
 	} else {
 		NotifyVRAMAddressChange(addr);
 		if(_chrMemoryAccess[addr >> 8] & MemoryAccessType::Write) {
 			_chrPages[addr >> 8][(uint8_t)addr] = value;
+			if(_dirtyPageTracker) {
+				MarkVramPageDirty(addr);
+			}
 		}
 	}
 }
@@ -857,6 +894,33 @@ void BaseMapper::WriteVRAM(uint16_t addr, uint8_t value)
 	if(_chrMemoryAccess[addr >> 8] & MemoryAccessType::Write) {
 		_chrPages[addr >> 8][(uint8_t)addr] = value;
 	}
+
+	if(_dirtyPageTracker) {
+		//Flagged even if the page is write-protected, to match the debugger's PPU write stamps
+		MarkVramPageDirty(addr);
+	}
+}
+
+void BaseMapper::MarkVramPageDirty(uint16_t addr)
+{
+	PpuAddressTypeInfo addressInfo;
+	GetPpuAbsoluteAddressAndType(addr, &addressInfo);
+	if(addressInfo.Type == PpuAddressType::ChrRam) {
+		_dirtyPageTracker->MarkDirty(DebugMemoryType::ChrRam, addressInfo.Address);
+	} else if(addressInfo.Type == PpuAddressType::NametableRam) {
+		_dirtyPageTracker->MarkDirty(DebugMemoryType::NametableRam, addressInfo.Address);
+	}
+}
+
+void BaseMapper::SetDirtyPageTracker(DirtyPageTracker* tracker)
+{
+	_dirtyPageTracker = tracker;
+	if(tracker) {
+		DebugMemoryType types[] = { DebugMemoryType::WorkRam, DebugMemoryType::SaveRam, DebugMemoryType::ChrRam, DebugMemoryType::NametableRam };
+		for(DebugMemoryType type : types) {
+			tracker->SetMemorySize(type, GetMemorySize(type));
+		}
+	}
 }
 
 bool BaseMapper::IsNes20()
@@ -11,6 +11,7 @@
 #include "Console.h"
 
 class BaseControlDevice;
+class DirtyPageTracker;
 
 class BaseMapper : public IMemoryHandler, public Snapshotable, public IBattery
 {
@@ -24,17 +25,24 @@ private:
 	uint16_t InternalGetChrPageSize();
 	uint16_t InternalGetChrRamPageSize();
 	bool ValidateAddressRange(uint16_t startAddr, uint16_t endAddr);
+	void UpdateRegisterPages(uint16_t startAddr, uint16_t endAddr);
 
 	uint8_t *_nametableRam = nullptr;
 	uint8_t _nametableCount = 2;
 
 	bool _onlyChrRam = false;
 	bool _hasBusConflicts = false;
+
+	uint64_t _nextCpuClockCycle = 0;
 	
 	bool _allowRegisterRead = false;
 	bool _isReadRegisterAddr[0x10000];
+	bool _isReadRegisterPage[0x100];
+	bool _allowDirectPrgReads = true;
 	bool _isWriteRegisterAddr[0x10000];
 
+	DirtyPageTracker* _dirtyPageTracker = nullptr;
+
 	MemoryAccessType _prgMemoryAccess[0x100];
 	uint8_t* _prgPages[0x100];
 
@@ -97,10 +105,17 @@ protected:
 	virtual uint16_t RegisterEndAddress() { return 0xFFFF; }
 	virtual bool AllowRegisterRead() { return false; }
 
+	//Mappers that override ReadRAM must return false, otherwise the CPU may read PRG pages without calling ReadRAM
+	virtual bool AllowDirectPrgReads() { return true; }
+
 	virtual uint32_t GetDipSwitchCount() { return 0; }
 	
 	virtual bool HasBusConflicts() { return false; }
 
+	//Stops ProcessCpuClock from being called until the given CPU cycle is reached, or until the next register write (whichever comes first)
+	//Used by mappers whose CPU clock logic (e.g IRQ counters) has nothing to do until the game writes to them again
+	void SuspendCpuClock(uint64_t untilCycle = UINT64_MAX) { _nextCpuClockCycle = untilCycle; }
+
 	uint8_t InternalReadRam(uint16_t addr);
 
 	virtual void WriteRegister(uint16_t addr, uint8_t value);
@@ -164,8 +179,18 @@ public:
 	virtual ConsoleFeatures GetAvailableFeatures();
 
 	virtual void SetNesModel(NesModel model) { }
-	virtual void ProcessCpuClock() { }
+	//Mappers that don't override this are never clocked again after the first call
+	virtual void ProcessCpuClock() { SuspendCpuClock(); }
+	void ResumeCpuClock() { _nextCpuClockCycle = 0; }
+	__forceinline bool NeedCpuClock(uint64_t cycle) { return cycle >= _nextCpuClockCycle; }
 	virtual void NotifyVRAMAddressChange(uint16_t addr);
+
+	//Mappers that never observe the PPU's bus (no A12/scanline IRQs, no PPU read/write hooks) can let the CPU run the PPU lazily
+	virtual bool AllowPpuCatchUp() { return false; }
+
+	//Number of bytes the mapper's save state can grow by while the game runs (e.g FDS disk writes)
+	virtual uint32_t GetMaxStateSizeGrowth() { return 0; }
+
 	virtual void GetMemoryRanges(MemoryRanges &ranges) override;
 	
 	virtual void SaveBattery() override;
@@ -181,6 +206,7 @@ public:
 	uint8_t ReadRAM(uint16_t addr) override;
 	uint8_t PeekRAM(uint16_t addr) override;
 	uint8_t DebugReadRAM(uint16_t addr);
+	uint8_t* GetDirectReadPage(uint8_t page);
 	void WriteRAM(uint16_t addr, uint8_t value) override;
 	void DebugWriteRAM(uint16_t addr, uint8_t value);
 	void WritePrgRam(uint16_t addr, uint8_t value);
@@ -196,6 +222,10 @@ public:
 
 	void DebugWriteVRAM(uint16_t addr, uint8_t value, bool disableSideEffects = true);
 	void WriteVRAM(uint16_t addr, uint8_t value);
+	void MarkVramPageDirty(uint16_t addr);
+
+	//Flags the CHR RAM/nametable pages modified by VRAM writes in the tracker (nullptr disables tracking)
+	void SetDirtyPageTracker(DirtyPageTracker* tracker);
 
 	uint8_t DebugReadVRAM(uint16_t addr, bool disableSideEffects = true);
 
@@ -98,7 +98,7 @@ void BaseVideoFilter::TakeScreenshot(VideoFilterType filterType, string filename
 
 		shared_ptr<ScaleFilter> scaleFilter = ScaleFilter::GetScaleFilter(filterType);
 		if(scaleFilter) {
-			pngBuffer = scaleFilter->ApplyFilter(pngBuffer, frameInfo.Width, frameInfo.Height, _console->GetSettings()->GetPictureSettings().ScanlineIntensity);
+			pngBuffer = scaleFilter->ApplyFilter(pngBuffer, frameInfo.Width, frameInfo.Height, _console->GetSettings()->GetPictureSettings().ScanlineIntensity, _console->GetSettings()->GetVideoFilterThreadCount());
 			frameInfo = scaleFilter->GetFrameInfo(frameInfo);
 		}
 
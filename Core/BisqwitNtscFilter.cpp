@@ -3,16 +3,22 @@
 //http://forums.nesdev.com/viewtopic.php?p=172329
 #include "stdafx.h"
 #include <cmath>
+#include <algorithm>
 #include "BisqwitNtscFilter.h"
 #include "PPU.h"
 #include "EmulationSettings.h"
 #include "Console.h"
+#include "WorkerPool.h"
+#include "../Utilities/PlatformUtilities.h"
+
+#ifdef HAS_AVX2_TARGET
+	#include <immintrin.h>
+#endif
 
 BisqwitNtscFilter::BisqwitNtscFilter(shared_ptr<Console> console, int resDivider) : BaseVideoFilter(console)
 {
 	_resDivider = resDivider;
-	_stopThread = false;
-	_workDone = false;
+	_useAvx2 = PlatformUtilities::IsAvx2Supported();
 
 	const int8_t signalLumaLow[4] = { -29, -15, 22, 71 };
 	const int8_t signalLumaHigh[4] = { 32, 66, 105, 105 };
@@ -32,45 +38,37 @@ BisqwitNtscFilter::BisqwitNtscFilter(shared_ptr<Console> console, int resDivider
 		_signalHigh[i] = q;
 	}
 
-	_extraThread = std::thread([=]() {
-		//Worker thread to improve decode speed
-		while(!_stopThread) {
-			_waitWork.Wait();
-			if(_stopThread) {
-				break;
-			}
-
-			uint32_t* outputBuffer = GetOutputBuffer();
-
-			//Adjust outputbuffer to start at the middle of the picture
-			if(_keepVerticalRes) {
-				outputBuffer += GetOverscan().GetScreenWidth() * 8 / _resDivider * (120 - GetOverscan().Top);
-			} else {
-				outputBuffer += GetOverscan().GetScreenWidth() * 64 / _resDivider / _resDivider * (120 - GetOverscan().Top);
-			}
-
-			DecodeFrame(120, 239 - GetOverscan().Bottom, _ppuOutputBuffer, outputBuffer, (IsOddFrame() ? 8 : 0) + 327360); 
-
-			_workDone = true;
-		}
-	});
 }
 
 BisqwitNtscFilter::~BisqwitNtscFilter()
 {
-	_stopThread = true;
-	_waitWork.Signal();
-	_extraThread.join();
 }
 
 void BisqwitNtscFilter::ApplyFilter(uint16_t *ppuOutputBuffer)
 {
 	_ppuOutputBuffer = ppuOutputBuffer;
 
-	_workDone = false;
-	_waitWork.Signal();
-	DecodeFrame(GetOverscan().Top, 120, ppuOutputBuffer, GetOutputBuffer(), (IsOddFrame() ? 8 : 0) + GetOverscan().Top*341*8);
-	while(!_workDone) {}
+	OverscanDimensions overscan = GetOverscan();
+	int firstRow = overscan.Top;
+	int rowCount = 240 - overscan.Bottom - overscan.Top;
+	uint32_t rowPixelGap = overscan.GetScreenWidth() * 8 / _resDivider;
+	if(!_keepVerticalRes) {
+		rowPixelGap *= 8 / _resDivider;
+	}
+
+	shared_ptr<WorkerPool> pool = WorkerPool::GetVideoFilterPool(_console->GetSettings()->GetVideoFilterThreadCount());
+	uint32_t bandCount = std::max<uint32_t>(1, std::min<uint32_t>(pool->GetThreadCount(), rowCount / _minBandHeight));
+	if(_bandBuffers.size() < bandCount) {
+		_bandBuffers.resize(bandCount);
+	}
+
+	uint32_t* outputBuffer = GetOutputBuffer();
+	int phase = IsOddFrame() ? 8 : 0;
+	pool->Run(bandCount, [=](uint32_t band) {
+		int startRow = firstRow + rowCount * band / bandCount;
+		int endRow = firstRow + rowCount * (band + 1) / bandCount - 1;
+		DecodeFrame(startRow, endRow, outputBuffer + (startRow - firstRow) * rowPixelGap, phase + startRow * 341 * _signalsPerPixel, _bandBuffers[band]);
+	});
 }
 
 FrameInfo BisqwitNtscFilter::GetFrameInfo()
@@ -89,6 +87,9 @@ void BisqwitNtscFilter::OnBeforeApplyFilter()
 	NtscFilterSettings ntscSettings = _console->GetSettings()->GetNtscFilterSettings();
 
 	_keepVerticalRes = ntscSettings.KeepVerticalResolution;
+	_verticalBlend = ntscSettings.VerticalBlend;
+	_brightness = (int)(pictureSettings.Brightness * 750);
+	_scanlineIntensity = 1.0 - pictureSettings.ScanlineIntensity;
 
 	const double pi = std::atan(1.0) * 4;
 	int contrast = (int)((pictureSettings.Contrast + 1.0) * (pictureSettings.Contrast + 1.0) * 167941);
@@ -118,7 +119,7 @@ void BisqwitNtscFilter::RecursiveBlend(int iterationCount, uint64_t *output, uin
 	//Blend 2 pixels at once
 	uint32_t width = GetOverscan().GetScreenWidth() * pixelsPerCycle / 2;
 
-	double scanlineIntensity = 1.0 - _console->GetSettings()->GetPictureSettings().ScanlineIntensity;
+	double scanlineIntensity = _scanlineIntensity;
 	if(scanlineIntensity < 1.0 && (iterationCount == 2 || _resDivider == 4)) {
 		//Most likely extremely inefficient scanlines, but works
 		for(uint32_t x = 0; x < width; x++) {
@@ -192,12 +193,23 @@ void BisqwitNtscFilter::GenerateNtscSignal(int8_t *ntscSignal, int &phase, int r
 	phase += (341 - 256 - _paddingSize * 2) * _signalsPerPixel;
 }
 
-void BisqwitNtscFilter::DecodeFrame(int startRow, int endRow, uint16_t *ppuOutputBuffer, uint32_t* outputBuffer, int startPhase)
+void BisqwitNtscFilter::DecodeRow(int row, int &phase, uint32_t* target, NtscBandBuffers &buffers)
 {
-	int pixelsPerCycle = 8 / _resDivider;
-	int phase = startPhase;
 	constexpr int lineWidth = 256 + _paddingSize * 2;
 	int8_t rowSignal[lineWidth * _signalsPerPixel];
+	int startCycle = phase % 12;
+
+	//Convert the PPU's output to an NTSC signal
+	GenerateNtscSignal(rowSignal, phase, row);
+
+	//Convert the NTSC signal to RGB
+	NtscDecodeLine(lineWidth * _signalsPerPixel, rowSignal, target, (startCycle + 7) % 12, buffers.PrefixSums);
+}
+
+void BisqwitNtscFilter::DecodeFrame(int startRow, int endRow, uint32_t* outputBuffer, int startPhase, NtscBandBuffers &buffers)
+{
+	int pixelsPerCycle = 8 / _resDivider;
+	int phase = startPhase;
 	uint32_t rowPixelGap = GetOverscan().GetScreenWidth() * pixelsPerCycle;
 	if(!_keepVerticalRes) {
 		rowPixelGap *= pixelsPerCycle;
@@ -206,34 +218,86 @@ void BisqwitNtscFilter::DecodeFrame(int startRow, int endRow, uint16_t *ppuOutpu
 	uint32_t* orgBuffer = outputBuffer;
 
 	for(int y = startRow; y <= endRow; y++) {
-		int startCycle = phase % 12;
-		
-		//Convert the PPU's output to an NTSC signal
-		GenerateNtscSignal(rowSignal, phase, y);
-
-		//Convert the NTSC signal to RGB
-		NtscDecodeLine(lineWidth * _signalsPerPixel, rowSignal, outputBuffer, (startCycle + 7) % 12);
-
+		DecodeRow(y, phase, outputBuffer, buffers);
 		outputBuffer += rowPixelGap;
 	}
 
 	if(!_keepVerticalRes) {
+		int lastRow = 239 - GetOverscan().Bottom;
+		uint64_t* bandNextLine = nullptr;
+		if(endRow < lastRow) {
+			//The first row of the next band is being decoded by another thread, decode a private copy of it to blend with
+			buffers.NextLine.resize(GetOverscan().GetScreenWidth() * pixelsPerCycle);
+			DecodeRow(endRow + 1, phase, buffers.NextLine.data(), buffers);
+			bandNextLine = (uint64_t*)buffers.NextLine.data();
+		}
+
 		//Generate the missing vertical lines
 		outputBuffer = orgBuffer;
-		int lastRow = 239 - GetOverscan().Bottom;
-		bool verticalBlend = _console->GetSettings()->GetNtscFilterSettings().VerticalBlend;
 		for(int y = startRow; y <= endRow; y++) {
 			uint64_t* currentLine = (uint64_t*)outputBuffer;
-			uint64_t* nextLine = y == lastRow ? currentLine : (uint64_t*)(outputBuffer + rowPixelGap);
+			uint64_t* nextLine;
+			if(y == lastRow) {
+				nextLine = currentLine;
+			} else if(y == endRow) {
+				nextLine = bandNextLine;
+			} else {
+				nextLine = (uint64_t*)(outputBuffer + rowPixelGap);
+			}
 			uint64_t* buffer = (uint64_t*)(outputBuffer + rowPixelGap / 2);
 
-			RecursiveBlend(4 / _resDivider, buffer, currentLine, nextLine, pixelsPerCycle, verticalBlend);
+			RecursiveBlend(4 / _resDivider, buffer, currentLine, nextLine, pixelsPerCycle, _verticalBlend);
 
 			outputBuffer += rowPixelGap;
 		}
 	}
 }
 
+#ifdef HAS_AVX2_TARGET
+//Converts the YIQ window sums of 8 output samples at a time to RGB - same results as the scalar code in NtscDecodeLine
+AVX2_TARGET static int NtscDecodeSamplesAvx2(const int32_t* sums[3], const int widths[3], int first, int count, int stride, const int coefficients[8], uint32_t* target)
+{
+	__m256i indexes = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	__m256i brightness = _mm256_set1_epi32(coefficients[0]);
+	__m256i y = _mm256_set1_epi32(coefficients[1]);
+	__m256i ir = _mm256_set1_epi32(coefficients[2]), ig = _mm256_set1_epi32(coefficients[3]), ib = _mm256_set1_epi32(coefficients[4]);
+	__m256i qr = _mm256_set1_epi32(coefficients[5]), qg = _mm256_set1_epi32(coefficients[6]), qb = _mm256_set1_epi32(coefficients[7]);
+	__m256i zero = _mm256_setzero_si256();
+	__m256i max = _mm256_set1_epi32(255);
+	__m256i alpha = _mm256_set1_epi32(0xFF000000);
+
+	int n = 0;
+	for(; n + 8 <= count; n += 8) {
+		int s = first + n * stride;
+		__m256i windowSums[3];
+		for(int i = 0; i < 3; i++) {
+			__m256i current, previous;
+			if(stride == 1) {
+				current = _mm256_loadu_si256((const __m256i*)(sums[i] + s));
+				previous = _mm256_loadu_si256((const __m256i*)(sums[i] + s - widths[i]));
+			} else {
+				current = _mm256_i32gather_epi32((const int*)(sums[i] + s), indexes, 4);
+				previous = _mm256_i32gather_epi32((const int*)(sums[i] + s - widths[i]), indexes, 4);
+			}
+			windowSums[i] = _mm256_sub_epi32(current, previous);
+		}
+		__m256i ys = _mm256_mullo_epi32(_mm256_add_epi32(windowSums[0], brightness), y);
+
+		//Arithmetic shifts round down instead of towards zero, this only matters for negative values, which are clamped to 0 either way
+		__m256i r = _mm256_add_epi32(ys, _mm256_add_epi32(_mm256_mullo_epi32(windowSums[1], ir), _mm256_mullo_epi32(windowSums[2], qr)));
+		__m256i g = _mm256_add_epi32(ys, _mm256_add_epi32(_mm256_mullo_epi32(windowSums[1], ig), _mm256_mullo_epi32(windowSums[2], qg)));
+		__m256i b = _mm256_add_epi32(ys, _mm256_add_epi32(_mm256_mullo_epi32(windowSums[1], ib), _mm256_mullo_epi32(windowSums[2], qb)));
+		r = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(r, 16), zero), max);
+		g = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(g, 16), zero), max);
+		b = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(b, 16), zero), max);
+
+		__m256i argb = _mm256_or_si256(_mm256_or_si256(alpha, _mm256_slli_epi32(r, 16)), _mm256_or_si256(_mm256_slli_epi32(g, 8), b));
+		_mm256_storeu_si256((__m256i*)(target + n), argb);
+	}
+	return n;
+}
+#endif
+
 /**
 * NTSC_DecodeLine(Width, Signal, Target, Phase0)
 *
@@ -264,30 +328,69 @@ void BisqwitNtscFilter::DecodeFrame(int startRow, int endRow, uint16_t *ppuOutpu
 *         In essence it conveys in one integer the same information that real NTSC signal
 *         would convey in the colorburst period in the beginning of each scanline.
 */
-void BisqwitNtscFilter::NtscDecodeLine(int width, const int8_t* signal, uint32_t* target, int phase0)
+void BisqwitNtscFilter::NtscDecodeLine(int width, const int8_t* signal, uint32_t* target, int phase0, vector<int32_t> &prefixSums)
 {
-	auto Read = [=](int pos) -> char { return pos >= 0 ? signal[pos] : 0; };
-	auto Cos = [=](int pos) -> char { return _sinetable[(pos + 36) % 12 + phase0]; };
-	auto Sin = [=](int pos) -> char { return _sinetable[(pos + 36) % 12 + 3 + phase0]; };
-
-	int brightness = (int)(_console->GetSettings()->GetPictureSettings().Brightness * 750);
-	int ysum = brightness, isum = 0, qsum = 0;
 	int offset = _resDivider + 4;
 	int leftOverscan = (GetOverscan().Left + _paddingSize) * 8 + offset;
 	int rightOverscan = width - (GetOverscan().Right + _paddingSize) * 8 + offset;
 
-	for(int s = 0; s < rightOverscan; s++) {
-		ysum += Read(s) - Read(s - _yWidth);
-		isum += Read(s) * Cos(s) - Read(s - _iWidth) * Cos(s - _iWidth);
-		qsum += Read(s) * Sin(s) - Read(s - _qWidth) * Sin(s - _qWidth);
-
-		if(!(s % _resDivider) && s >= leftOverscan) {
-			int r = std::min(255, std::max(0, (ysum*_y + isum*_ir + qsum*_qr) / 65536));
-			int g = std::min(255, std::max(0, (ysum*_y + isum*_ig + qsum*_qg) / 65536));
-			int b = std::min(255, std::max(0, (ysum*_y + isum*_ib + qsum*_qb) / 65536));
+	//Each Y/I/Q sum is calculated over a window of the previous samples (samples before the start of the line are 0).
+	//Prefix sums of the signal are calculated first, each window's sum is then the difference between 2 of them.
+	int padding = std::max(_yWidth, std::max(_iWidth, _qWidth));
+	int length = padding + rightOverscan;
+	if(prefixSums.size() < (size_t)length * 3) {
+		prefixSums.resize(length * 3);
+	}
+	int32_t* ySums = prefixSums.data() + padding;
+	int32_t* iSums = ySums + length;
+	int32_t* qSums = iSums + length;
+	std::fill(ySums - padding, ySums, 0);
+	std::fill(iSums - padding, iSums, 0);
+	std::fill(qSums - padding, qSums, 0);
+
+	int8_t cosTable[12], sinTable[12];
+	for(int i = 0; i < 12; i++) {
+		cosTable[i] = _sinetable[i + phase0];
+		sinTable[i] = _sinetable[i + 3 + phase0];
+	}
 
-			*target = 0xFF000000 | (r << 16) | (g << 8) | b;
-			target++;
+	int ysum = 0, isum = 0, qsum = 0;
+	for(int s = 0, cycle = 0; s < rightOverscan; s++) {
+		ysum += signal[s];
+		isum += signal[s] * cosTable[cycle];
+		qsum += signal[s] * sinTable[cycle];
+		ySums[s] = ysum;
+		iSums[s] = isum;
+		qSums[s] = qsum;
+		if(++cycle == 12) {
+			cycle = 0;
 		}
 	}
+
+	//Output a pixel for every _resDivider samples within the visible area
+	int first = (leftOverscan + _resDivider - 1) / _resDivider * _resDivider;
+	int count = first < rightOverscan ? (rightOverscan - first + _resDivider - 1) / _resDivider : 0;
+
+	int n = 0;
+#ifdef HAS_AVX2_TARGET
+	if(_useAvx2) {
+		const int32_t* sums[3] = { ySums, iSums, qSums };
+		const int widths[3] = { _yWidth, _iWidth, _qWidth };
+		const int coefficients[8] = { _brightness, _y, _ir, _ig, _ib, _qr, _qg, _qb };
+		n = NtscDecodeSamplesAvx2(sums, widths, first, count, _resDivider, coefficients, target);
+	}
+#endif
+
+	for(; n < count; n++) {
+		int s = first + n * _resDivider;
+		int ys = ySums[s] - ySums[s - _yWidth] + _brightness;
+		int is = iSums[s] - iSums[s - _iWidth];
+		int qs = qSums[s] - qSums[s - _qWidth];
+
+		int r = std::min(255, std::max(0, (ys*_y + is*_ir + qs*_qr) / 65536));
+		int g = std::min(255, std::max(0, (ys*_y + is*_ig + qs*_qg) / 65536));
+		int b = std::min(255, std::max(0, (ys*_y + is*_ib + qs*_qb) / 65536));
+
+		target[n] = 0xFF000000 | (r << 16) | (g << 8) | b;
+	}
 }
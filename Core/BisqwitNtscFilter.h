@@ -4,7 +4,6 @@
 #pragma once
 #include "stdafx.h"
 #include "BaseVideoFilter.h"
-#include "../Utilities/AutoResetEvent.h"
 
 class BisqwitNtscFilter : public BaseVideoFilter
 {
@@ -13,13 +12,22 @@ private:
 	static constexpr int _paddingSize = 6;
 	static constexpr int _signalsPerPixel = 8;
 	static constexpr int _signalWidth = 258;
+	static constexpr int _minBandHeight = 8;
 
-	std::thread _extraThread;
-	AutoResetEvent _waitWork;
-	atomic<bool> _stopThread;
-	atomic<bool> _workDone;
+	struct NtscBandBuffers
+	{
+		vector<int32_t> PrefixSums;
+		vector<uint32_t> NextLine;
+	};
+
+	//Each horizontal band of the picture is decoded by a different thread, with its own buffers
+	vector<NtscBandBuffers> _bandBuffers;
 
 	bool _keepVerticalRes = false;
+	bool _verticalBlend = false;
+	bool _useAvx2 = false;
+	int _brightness = 0;
+	double _scanlineIntensity = 1.0;
 
 	int _resDivider = 1;
 	uint16_t *_ppuOutputBuffer = nullptr;
@@ -43,10 +51,11 @@ private:
 
 	void RecursiveBlend(int iterationCount, uint64_t *output, uint64_t *currentLine, uint64_t *nextLine, int pixelsPerCycle, bool verticalBlend);
 	
-	void NtscDecodeLine(int width, const int8_t* signal, uint32_t* target, int phase0);
+	void NtscDecodeLine(int width, const int8_t* signal, uint32_t* target, int phase0, vector<int32_t> &prefixSums);
 	
 	void GenerateNtscSignal(int8_t *ntscSignal, int &phase, int rowNumber);
-	void DecodeFrame(int startRow, int endRow, uint16_t *ppuOutputBuffer, uint32_t* outputBuffer, int startPhase);
+	void DecodeRow(int row, int &phase, uint32_t* target, NtscBandBuffers &buffers);
+	void DecodeFrame(int startRow, int endRow, uint32_t* outputBuffer, int startPhase, NtscBandBuffers &buffers);
 	void OnBeforeApplyFilter();
 
 public:
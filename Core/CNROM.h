@@ -10,6 +10,7 @@ private:
 protected:
 	virtual uint16_t GetPRGPageSize() override { return 0x8000; }
 	virtual uint16_t GetCHRPageSize() override { return 0x2000; }
+	bool AllowPpuCatchUp() override { return true; }
 
 	void InitMapper() override
 	{
@@ -14,26 +14,6 @@ CPU::CPU(shared_ptr<Console> console)
 	_console = console;
 	_memoryManager = _console->GetMemoryManager();
 
-	Func opTable[] = { 
-	//	0				1				2				3				4				5				6						7				8				9				A						B				C						D				E						F
-		&CPU::BRK,	&CPU::ORA,	&CPU::HLT,	&CPU::SLO,	&CPU::NOP,	&CPU::ORA,	&CPU::ASL_Memory,	&CPU::SLO,	&CPU::PHP,	&CPU::ORA,	&CPU::ASL_Acc,		&CPU::AAC,	&CPU::NOP,			&CPU::ORA,	&CPU::ASL_Memory,	&CPU::SLO, //0
-		&CPU::BPL,	&CPU::ORA,	&CPU::HLT,	&CPU::SLO,	&CPU::NOP,	&CPU::ORA,	&CPU::ASL_Memory,	&CPU::SLO,	&CPU::CLC,	&CPU::ORA,	&CPU::NOP,			&CPU::SLO,	&CPU::NOP,			&CPU::ORA,	&CPU::ASL_Memory,	&CPU::SLO, //1
-		&CPU::JSR,	&CPU::AND,	&CPU::HLT,	&CPU::RLA,	&CPU::BIT,	&CPU::AND,	&CPU::ROL_Memory,	&CPU::RLA,	&CPU::PLP,	&CPU::AND,	&CPU::ROL_Acc,		&CPU::AAC,	&CPU::BIT,			&CPU::AND,	&CPU::ROL_Memory,	&CPU::RLA, //2
-		&CPU::BMI,	&CPU::AND,	&CPU::HLT,	&CPU::RLA,	&CPU::NOP,	&CPU::AND,	&CPU::ROL_Memory,	&CPU::RLA,	&CPU::SEC,	&CPU::AND,	&CPU::NOP,			&CPU::RLA,	&CPU::NOP,			&CPU::AND,	&CPU::ROL_Memory,	&CPU::RLA, //3
-		&CPU::RTI,	&CPU::EOR,	&CPU::HLT,	&CPU::SRE,	&CPU::NOP,	&CPU::EOR,	&CPU::LSR_Memory,	&CPU::SRE,	&CPU::PHA,	&CPU::EOR,	&CPU::LSR_Acc,		&CPU::ASR,	&CPU::JMP_Abs,		&CPU::EOR,	&CPU::LSR_Memory,	&CPU::SRE, //4
-		&CPU::BVC,	&CPU::EOR,	&CPU::HLT,	&CPU::SRE,	&CPU::NOP,	&CPU::EOR,	&CPU::LSR_Memory,	&CPU::SRE,	&CPU::CLI,	&CPU::EOR,	&CPU::NOP,			&CPU::SRE,	&CPU::NOP,			&CPU::EOR,	&CPU::LSR_Memory,	&CPU::SRE, //5
-		&CPU::RTS,	&CPU::ADC,	&CPU::HLT,	&CPU::RRA,	&CPU::NOP,	&CPU::ADC,	&CPU::ROR_Memory,	&CPU::RRA,	&CPU::PLA,	&CPU::ADC,	&CPU::ROR_Acc,		&CPU::ARR,	&CPU::JMP_Ind,		&CPU::ADC,	&CPU::ROR_Memory,	&CPU::RRA, //6
-		&CPU::BVS,	&CPU::ADC,	&CPU::HLT,	&CPU::RRA,	&CPU::NOP,	&CPU::ADC,	&CPU::ROR_Memory,	&CPU::RRA,	&CPU::SEI,	&CPU::ADC,	&CPU::NOP,			&CPU::RRA,	&CPU::NOP,			&CPU::ADC,	&CPU::ROR_Memory,	&CPU::RRA, //7
-		&CPU::NOP,	&CPU::STA,	&CPU::NOP,	&CPU::SAX,	&CPU::STY,	&CPU::STA,	&CPU::STX,			&CPU::SAX,	&CPU::DEY,	&CPU::NOP,	&CPU::TXA,			&CPU::UNK,	&CPU::STY,			&CPU::STA,	&CPU::STX,			&CPU::SAX, //8
-		&CPU::BCC,	&CPU::STA,	&CPU::HLT,	&CPU::AXA,	&CPU::STY,	&CPU::STA,	&CPU::STX,			&CPU::SAX,	&CPU::TYA,	&CPU::STA,	&CPU::TXS,			&CPU::TAS,	&CPU::SYA,			&CPU::STA,	&CPU::SXA,			&CPU::AXA, //9
-		&CPU::LDY,	&CPU::LDA,	&CPU::LDX,	&CPU::LAX,	&CPU::LDY,	&CPU::LDA,	&CPU::LDX,			&CPU::LAX,	&CPU::TAY,	&CPU::LDA,	&CPU::TAX,			&CPU::ATX,	&CPU::LDY,			&CPU::LDA,	&CPU::LDX,			&CPU::LAX, //A
-		&CPU::BCS,	&CPU::LDA,	&CPU::HLT,	&CPU::LAX,	&CPU::LDY,	&CPU::LDA,	&CPU::LDX,			&CPU::LAX,	&CPU::CLV,	&CPU::LDA,	&CPU::TSX,			&CPU::LAS,	&CPU::LDY,			&CPU::LDA,	&CPU::LDX,			&CPU::LAX, //B
-		&CPU::CPY,	&CPU::CPA,	&CPU::NOP,	&CPU::DCP,	&CPU::CPY,	&CPU::CPA,	&CPU::DEC,			&CPU::DCP,	&CPU::INY,	&CPU::CPA,	&CPU::DEX,			&CPU::AXS,	&CPU::CPY,			&CPU::CPA,	&CPU::DEC,			&CPU::DCP, //C
-		&CPU::BNE,	&CPU::CPA,	&CPU::HLT,	&CPU::DCP,	&CPU::NOP,	&CPU::CPA,	&CPU::DEC,			&CPU::DCP,	&CPU::CLD,	&CPU::CPA,	&CPU::NOP,			&CPU::DCP,	&CPU::NOP,			&CPU::CPA,	&CPU::DEC,			&CPU::DCP, //D
-		&CPU::CPX,	&CPU::SBC,	&CPU::NOP,	&CPU::ISB,	&CPU::CPX,	&CPU::SBC,	&CPU::INC,			&CPU::ISB,	&CPU::INX,	&CPU::SBC,	&CPU::NOP,			&CPU::SBC,	&CPU::CPX,			&CPU::SBC,	&CPU::INC,			&CPU::ISB, //E
-		&CPU::BEQ,	&CPU::SBC,	&CPU::HLT,	&CPU::ISB,	&CPU::NOP,	&CPU::SBC,	&CPU::INC,			&CPU::ISB,	&CPU::SED,	&CPU::SBC,	&CPU::NOP,			&CPU::ISB,	&CPU::NOP,			&CPU::SBC,	&CPU::INC,			&CPU::ISB  //F
-	};
-
 	typedef AddrMode M;
 	AddrMode addrMode[] = {
 	//	0			1				2			3				4				5				6				7				8			9			A			B			C			D			E			F
@@ -55,9 +35,13 @@ CPU::CPU(shared_ptr<Console> console)
 		M::Rel,	M::IndY,		M::None,	M::IndYW,	M::ZeroX,	M::ZeroX,	M::ZeroX,	M::ZeroX,	M::Imp,	M::AbsY,	M::Imp,	M::AbsYW,M::AbsX,	M::AbsX,	M::AbsXW,M::AbsXW,//F
 	};
 	
-	memcpy(_opTable, opTable, sizeof(opTable));
 	memcpy(_addrMode, addrMode, sizeof(addrMode));
 
+	InitOpTable<CpuFeatures::None>();
+	InitOpTable<CpuFeatures::Debugger>();
+	InitOpTable<CpuFeatures::Cheats>();
+	InitOpTable<CpuFeatures::All>();
+
 	_instAddrMode = AddrMode::None;
 	_state = {};
 	_cycleCount = 0;
@@ -77,6 +61,32 @@ CPU::CPU(shared_ptr<Console> console)
 	_runIrq = false;
 }
 
+template<uint8_t F>
+void CPU::InitOpTable()
+{
+	Func opTable[] = { 
+	//	0				1				2				3				4				5				6						7				8				9				A						B				C						D				E						F
+		&CPU::BRK<F>,	&CPU::ORA<F>,	&CPU::HLT<F>,	&CPU::SLO<F>,	&CPU::NOP<F>,	&CPU::ORA<F>,	&CPU::ASL_Memory<F>,	&CPU::SLO<F>,	&CPU::PHP<F>,	&CPU::ORA<F>,	&CPU::ASL_Acc,		&CPU::AAC<F>,	&CPU::NOP<F>,			&CPU::ORA<F>,	&CPU::ASL_Memory<F>,	&CPU::SLO<F>, //0
+		&CPU::BPL<F>,	&CPU::ORA<F>,	&CPU::HLT<F>,	&CPU::SLO<F>,	&CPU::NOP<F>,	&CPU::ORA<F>,	&CPU::ASL_Memory<F>,	&CPU::SLO<F>,	&CPU::CLC,	&CPU::ORA<F>,	&CPU::NOP<F>,			&CPU::SLO<F>,	&CPU::NOP<F>,			&CPU::ORA<F>,	&CPU::ASL_Memory<F>,	&CPU::SLO<F>, //1
+		&CPU::JSR<F>,	&CPU::AND<F>,	&CPU::HLT<F>,	&CPU::RLA<F>,	&CPU::BIT<F>,	&CPU::AND<F>,	&CPU::ROL_Memory<F>,	&CPU::RLA<F>,	&CPU::PLP<F>,	&CPU::AND<F>,	&CPU::ROL_Acc,		&CPU::AAC<F>,	&CPU::BIT<F>,			&CPU::AND<F>,	&CPU::ROL_Memory<F>,	&CPU::RLA<F>, //2
+		&CPU::BMI<F>,	&CPU::AND<F>,	&CPU::HLT<F>,	&CPU::RLA<F>,	&CPU::NOP<F>,	&CPU::AND<F>,	&CPU::ROL_Memory<F>,	&CPU::RLA<F>,	&CPU::SEC,	&CPU::AND<F>,	&CPU::NOP<F>,			&CPU::RLA<F>,	&CPU::NOP<F>,			&CPU::AND<F>,	&CPU::ROL_Memory<F>,	&CPU::RLA<F>, //3
+		&CPU::RTI<F>,	&CPU::EOR<F>,	&CPU::HLT<F>,	&CPU::SRE<F>,	&CPU::NOP<F>,	&CPU::EOR<F>,	&CPU::LSR_Memory<F>,	&CPU::SRE<F>,	&CPU::PHA<F>,	&CPU::EOR<F>,	&CPU::LSR_Acc,		&CPU::ASR<F>,	&CPU::JMP_Abs,		&CPU::EOR<F>,	&CPU::LSR_Memory<F>,	&CPU::SRE<F>, //4
+		&CPU::BVC<F>,	&CPU::EOR<F>,	&CPU::HLT<F>,	&CPU::SRE<F>,	&CPU::NOP<F>,	&CPU::EOR<F>,	&CPU::LSR_Memory<F>,	&CPU::SRE<F>,	&CPU::CLI,	&CPU::EOR<F>,	&CPU::NOP<F>,			&CPU::SRE<F>,	&CPU::NOP<F>,			&CPU::EOR<F>,	&CPU::LSR_Memory<F>,	&CPU::SRE<F>, //5
+		&CPU::RTS<F>,	&CPU::ADC<F>,	&CPU::HLT<F>,	&CPU::RRA<F>,	&CPU::NOP<F>,	&CPU::ADC<F>,	&CPU::ROR_Memory<F>,	&CPU::RRA<F>,	&CPU::PLA<F>,	&CPU::ADC<F>,	&CPU::ROR_Acc,		&CPU::ARR<F>,	&CPU::JMP_Ind<F>,		&CPU::ADC<F>,	&CPU::ROR_Memory<F>,	&CPU::RRA<F>, //6
+		&CPU::BVS<F>,	&CPU::ADC<F>,	&CPU::HLT<F>,	&CPU::RRA<F>,	&CPU::NOP<F>,	&CPU::ADC<F>,	&CPU::ROR_Memory<F>,	&CPU::RRA<F>,	&CPU::SEI,	&CPU::ADC<F>,	&CPU::NOP<F>,			&CPU::RRA<F>,	&CPU::NOP<F>,			&CPU::ADC<F>,	&CPU::ROR_Memory<F>,	&CPU::RRA<F>, //7
+		&CPU::NOP<F>,	&CPU::STA<F>,	&CPU::NOP<F>,	&CPU::SAX<F>,	&CPU::STY<F>,	&CPU::STA<F>,	&CPU::STX<F>,			&CPU::SAX<F>,	&CPU::DEY,	&CPU::NOP<F>,	&CPU::TXA,			&CPU::UNK<F>,	&CPU::STY<F>,			&CPU::STA<F>,	&CPU::STX<F>,			&CPU::SAX<F>, //8
+		&CPU::BCC<F>,	&CPU::STA<F>,	&CPU::HLT<F>,	&CPU::AXA<F>,	&CPU::STY<F>,	&CPU::STA<F>,	&CPU::STX<F>,			&CPU::SAX<F>,	&CPU::TYA,	&CPU::STA<F>,	&CPU::TXS,			&CPU::TAS<F>,	&CPU::SYA<F>,			&CPU::STA<F>,	&CPU::SXA<F>,			&CPU::AXA<F>, //9
+		&CPU::LDY<F>,	&CPU::LDA<F>,	&CPU::LDX<F>,	&CPU::LAX<F>,	&CPU::LDY<F>,	&CPU::LDA<F>,	&CPU::LDX<F>,			&CPU::LAX<F>,	&CPU::TAY,	&CPU::LDA<F>,	&CPU::TAX,			&CPU::ATX<F>,	&CPU::LDY<F>,			&CPU::LDA<F>,	&CPU::LDX<F>,			&CPU::LAX<F>, //A
+		&CPU::BCS<F>,	&CPU::LDA<F>,	&CPU::HLT<F>,	&CPU::LAX<F>,	&CPU::LDY<F>,	&CPU::LDA<F>,	&CPU::LDX<F>,			&CPU::LAX<F>,	&CPU::CLV,	&CPU::LDA<F>,	&CPU::TSX,			&CPU::LAS<F>,	&CPU::LDY<F>,			&CPU::LDA<F>,	&CPU::LDX<F>,			&CPU::LAX<F>, //B
+		&CPU::CPY<F>,	&CPU::CPA<F>,	&CPU::NOP<F>,	&CPU::DCP<F>,	&CPU::CPY<F>,	&CPU::CPA<F>,	&CPU::DEC<F>,			&CPU::DCP<F>,	&CPU::INY,	&CPU::CPA<F>,	&CPU::DEX,			&CPU::AXS<F>,	&CPU::CPY<F>,			&CPU::CPA<F>,	&CPU::DEC<F>,			&CPU::DCP<F>, //C
+		&CPU::BNE<F>,	&CPU::CPA<F>,	&CPU::HLT<F>,	&CPU::DCP<F>,	&CPU::NOP<F>,	&CPU::CPA<F>,	&CPU::DEC<F>,			&CPU::DCP<F>,	&CPU::CLD,	&CPU::CPA<F>,	&CPU::NOP<F>,			&CPU::DCP<F>,	&CPU::NOP<F>,			&CPU::CPA<F>,	&CPU::DEC<F>,			&CPU::DCP<F>, //D
+		&CPU::CPX<F>,	&CPU::SBC<F>,	&CPU::NOP<F>,	&CPU::ISB<F>,	&CPU::CPX<F>,	&CPU::SBC<F>,	&CPU::INC<F>,			&CPU::ISB<F>,	&CPU::INX,	&CPU::SBC<F>,	&CPU::NOP<F>,			&CPU::SBC<F>,	&CPU::CPX<F>,			&CPU::SBC<F>,	&CPU::INC<F>,			&CPU::ISB<F>, //E
+		&CPU::BEQ<F>,	&CPU::SBC<F>,	&CPU::HLT<F>,	&CPU::ISB<F>,	&CPU::NOP<F>,	&CPU::SBC<F>,	&CPU::INC<F>,			&CPU::ISB<F>,	&CPU::SED,	&CPU::SBC<F>,	&CPU::NOP<F>,			&CPU::ISB<F>,	&CPU::NOP<F>,			&CPU::SBC<F>,	&CPU::INC<F>,			&CPU::ISB<F>  //F
+	};
+
+	memcpy(_opTable[F], opTable, sizeof(opTable));
+}
+
 void CPU::Reset(bool softReset, NesModel model)
 {
 	_state.NMIFlag = false;
@@ -160,72 +170,365 @@ void CPU::Reset(bool softReset, NesModel model)
 
 void CPU::Exec()
 {
-	uint8_t opCode = GetOPCode();
+	switch(_features) {
+		case CpuFeatures::None: ExecInstruction<CpuFeatures::None>(); break;
+		case CpuFeatures::Debugger: ExecInstruction<CpuFeatures::Debugger>(); break;
+		case CpuFeatures::Cheats: ExecInstruction<CpuFeatures::Cheats>(); break;
+		default: ExecInstruction<CpuFeatures::All>(); break;
+	}
+}
+
+template<uint8_t F>
+void CPU::ExecInstruction()
+{
+	uint8_t opCode = GetOPCode<F>();
+#ifdef CPU_SWITCH_DISPATCH
+	ExecOpCode<F>(opCode);
+#else
 	_instAddrMode = _addrMode[opCode];
-	_operand = FetchOperand();
-	(this->*_opTable[opCode])();
+	_operand = FetchOperand<F>();
+	(this->*_opTable[F][opCode])();
+#endif
 	
 	if(_prevRunIrq || _prevNeedNmi) {
-		IRQ();
+		IRQ<F>();
 	}
 }
 
+#ifdef CPU_SWITCH_DISPATCH
+template<uint8_t F>
+void CPU::ExecOpCode(uint8_t opCode)
+{
+	//Same handlers and addressing modes as the opcode tables, but the operand fetch for each opcode is resolved at compile time
+	#define CPU_OP(code, mode, op) case code: _instAddrMode = AddrMode::mode; _operand = FetchOperand<F, AddrMode::mode>(); op(); break
+	switch(opCode) {
+		CPU_OP(0x00, Imp, BRK<F>);
+		CPU_OP(0x01, IndX, ORA<F>);
+		CPU_OP(0x02, None, HLT<F>);
+		CPU_OP(0x03, IndX, SLO<F>);
+		CPU_OP(0x04, Zero, NOP<F>);
+		CPU_OP(0x05, Zero, ORA<F>);
+		CPU_OP(0x06, Zero, ASL_Memory<F>);
+		CPU_OP(0x07, Zero, SLO<F>);
+		CPU_OP(0x08, Imp, PHP<F>);
+		CPU_OP(0x09, Imm, ORA<F>);
+		CPU_OP(0x0A, Acc, ASL_Acc);
+		CPU_OP(0x0B, Imm, AAC<F>);
+		CPU_OP(0x0C, Abs, NOP<F>);
+		CPU_OP(0x0D, Abs, ORA<F>);
+		CPU_OP(0x0E, Abs, ASL_Memory<F>);
+		CPU_OP(0x0F, Abs, SLO<F>);
+		CPU_OP(0x10, Rel, BPL<F>);
+		CPU_OP(0x11, IndY, ORA<F>);
+		CPU_OP(0x12, None, HLT<F>);
+		CPU_OP(0x13, IndYW, SLO<F>);
+		CPU_OP(0x14, ZeroX, NOP<F>);
+		CPU_OP(0x15, ZeroX, ORA<F>);
+		CPU_OP(0x16, ZeroX, ASL_Memory<F>);
+		CPU_OP(0x17, ZeroX, SLO<F>);
+		CPU_OP(0x18, Imp, CLC);
+		CPU_OP(0x19, AbsY, ORA<F>);
+		CPU_OP(0x1A, Imp, NOP<F>);
+		CPU_OP(0x1B, AbsYW, SLO<F>);
+		CPU_OP(0x1C, AbsX, NOP<F>);
+		CPU_OP(0x1D, AbsX, ORA<F>);
+		CPU_OP(0x1E, AbsXW, ASL_Memory<F>);
+		CPU_OP(0x1F, AbsXW, SLO<F>);
+		CPU_OP(0x20, Abs, JSR<F>);
+		CPU_OP(0x21, IndX, AND<F>);
+		CPU_OP(0x22, None, HLT<F>);
+		CPU_OP(0x23, IndX, RLA<F>);
+		CPU_OP(0x24, Zero, BIT<F>);
+		CPU_OP(0x25, Zero, AND<F>);
+		CPU_OP(0x26, Zero, ROL_Memory<F>);
+		CPU_OP(0x27, Zero, RLA<F>);
+		CPU_OP(0x28, Imp, PLP<F>);
+		CPU_OP(0x29, Imm, AND<F>);
+		CPU_OP(0x2A, Acc, ROL_Acc);
+		CPU_OP(0x2B, Imm, AAC<F>);
+		CPU_OP(0x2C, Abs, BIT<F>);
+		CPU_OP(0x2D, Abs, AND<F>);
+		CPU_OP(0x2E, Abs, ROL_Memory<F>);
+		CPU_OP(0x2F, Abs, RLA<F>);
+		CPU_OP(0x30, Rel, BMI<F>);
+		CPU_OP(0x31, IndY, AND<F>);
+		CPU_OP(0x32, None, HLT<F>);
+		CPU_OP(0x33, IndYW, RLA<F>);
+		CPU_OP(0x34, ZeroX, NOP<F>);
+		CPU_OP(0x35, ZeroX, AND<F>);
+		CPU_OP(0x36, ZeroX, ROL_Memory<F>);
+		CPU_OP(0x37, ZeroX, RLA<F>);
+		CPU_OP(0x38, Imp, SEC);
+		CPU_OP(0x39, AbsY, AND<F>);
+		CPU_OP(0x3A, Imp, NOP<F>);
+		CPU_OP(0x3B, AbsYW, RLA<F>);
+		CPU_OP(0x3C, AbsX, NOP<F>);
+		CPU_OP(0x3D, AbsX, AND<F>);
+		CPU_OP(0x3E, AbsXW, ROL_Memory<F>);
+		CPU_OP(0x3F, AbsXW, RLA<F>);
+		CPU_OP(0x40, Imp, RTI<F>);
+		CPU_OP(0x41, IndX, EOR<F>);
+		CPU_OP(0x42, None, HLT<F>);
+		CPU_OP(0x43, IndX, SRE<F>);
+		CPU_OP(0x44, Zero, NOP<F>);
+		CPU_OP(0x45, Zero, EOR<F>);
+		CPU_OP(0x46, Zero, LSR_Memory<F>);
+		CPU_OP(0x47, Zero, SRE<F>);
+		CPU_OP(0x48, Imp, PHA<F>);
+		CPU_OP(0x49, Imm, EOR<F>);
+		CPU_OP(0x4A, Acc, LSR_Acc);
+		CPU_OP(0x4B, Imm, ASR<F>);
+		CPU_OP(0x4C, Abs, JMP_Abs);
+		CPU_OP(0x4D, Abs, EOR<F>);
+		CPU_OP(0x4E, Abs, LSR_Memory<F>);
+		CPU_OP(0x4F, Abs, SRE<F>);
+		CPU_OP(0x50, Rel, BVC<F>);
+		CPU_OP(0x51, IndY, EOR<F>);
+		CPU_OP(0x52, None, HLT<F>);
+		CPU_OP(0x53, IndYW, SRE<F>);
+		CPU_OP(0x54, ZeroX, NOP<F>);
+		CPU_OP(0x55, ZeroX, EOR<F>);
+		CPU_OP(0x56, ZeroX, LSR_Memory<F>);
+		CPU_OP(0x57, ZeroX, SRE<F>);
+		CPU_OP(0x58, Imp, CLI);
+		CPU_OP(0x59, AbsY, EOR<F>);
+		CPU_OP(0x5A, Imp, NOP<F>);
+		CPU_OP(0x5B, AbsYW, SRE<F>);
+		CPU_OP(0x5C, AbsX, NOP<F>);
+		CPU_OP(0x5D, AbsX, EOR<F>);
+		CPU_OP(0x5E, AbsXW, LSR_Memory<F>);
+		CPU_OP(0x5F, AbsXW, SRE<F>);
+		CPU_OP(0x60, Imp, RTS<F>);
+		CPU_OP(0x61, IndX, ADC<F>);
+		CPU_OP(0x62, None, HLT<F>);
+		CPU_OP(0x63, IndX, RRA<F>);
+		CPU_OP(0x64, Zero, NOP<F>);
+		CPU_OP(0x65, Zero, ADC<F>);
+		CPU_OP(0x66, Zero, ROR_Memory<F>);
+		CPU_OP(0x67, Zero, RRA<F>);
+		CPU_OP(0x68, Imp, PLA<F>);
+		CPU_OP(0x69, Imm, ADC<F>);
+		CPU_OP(0x6A, Acc, ROR_Acc);
+		CPU_OP(0x6B, Imm, ARR<F>);
+		CPU_OP(0x6C, Ind, JMP_Ind<F>);
+		CPU_OP(0x6D, Abs, ADC<F>);
+		CPU_OP(0x6E, Abs, ROR_Memory<F>);
+		CPU_OP(0x6F, Abs, RRA<F>);
+		CPU_OP(0x70, Rel, BVS<F>);
+		CPU_OP(0x71, IndY, ADC<F>);
+		CPU_OP(0x72, None, HLT<F>);
+		CPU_OP(0x73, IndYW, RRA<F>);
+		CPU_OP(0x74, ZeroX, NOP<F>);
+		CPU_OP(0x75, ZeroX, ADC<F>);
+		CPU_OP(0x76, ZeroX, ROR_Memory<F>);
+		CPU_OP(0x77, ZeroX, RRA<F>);
+		CPU_OP(0x78, Imp, SEI);
+		CPU_OP(0x79, AbsY, ADC<F>);
+		CPU_OP(0x7A, Imp, NOP<F>);
+		CPU_OP(0x7B, AbsYW, RRA<F>);
+		CPU_OP(0x7C, AbsX, NOP<F>);
+		CPU_OP(0x7D, AbsX, ADC<F>);
+		CPU_OP(0x7E, AbsXW, ROR_Memory<F>);
+		CPU_OP(0x7F, AbsXW, RRA<F>);
+		CPU_OP(0x80, Imm, NOP<F>);
+		CPU_OP(0x81, IndX, STA<F>);
+		CPU_OP(0x82, Imm, NOP<F>);
+		CPU_OP(0x83, IndX, SAX<F>);
+		CPU_OP(0x84, Zero, STY<F>);
+		CPU_OP(0x85, Zero, STA<F>);
+		CPU_OP(0x86, Zero, STX<F>);
+		CPU_OP(0x87, Zero, SAX<F>);
+		CPU_OP(0x88, Imp, DEY);
+		CPU_OP(0x89, Imm, NOP<F>);
+		CPU_OP(0x8A, Imp, TXA);
+		CPU_OP(0x8B, Imm, UNK<F>);
+		CPU_OP(0x8C, Abs, STY<F>);
+		CPU_OP(0x8D, Abs, STA<F>);
+		CPU_OP(0x8E, Abs, STX<F>);
+		CPU_OP(0x8F, Abs, SAX<F>);
+		CPU_OP(0x90, Rel, BCC<F>);
+		CPU_OP(0x91, IndYW, STA<F>);
+		CPU_OP(0x92, None, HLT<F>);
+		CPU_OP(0x93, IndYW, AXA<F>);
+		CPU_OP(0x94, ZeroX, STY<F>);
+		CPU_OP(0x95, ZeroX, STA<F>);
+		CPU_OP(0x96, ZeroY, STX<F>);
+		CPU_OP(0x97, ZeroY, SAX<F>);
+		CPU_OP(0x98, Imp, TYA);
+		CPU_OP(0x99, AbsYW, STA<F>);
+		CPU_OP(0x9A, Imp, TXS);
+		CPU_OP(0x9B, AbsYW, TAS<F>);
+		CPU_OP(0x9C, AbsXW, SYA<F>);
+		CPU_OP(0x9D, AbsXW, STA<F>);
+		CPU_OP(0x9E, AbsYW, SXA<F>);
+		CPU_OP(0x9F, AbsYW, AXA<F>);
+		CPU_OP(0xA0, Imm, LDY<F>);
+		CPU_OP(0xA1, IndX, LDA<F>);
+		CPU_OP(0xA2, Imm, LDX<F>);
+		CPU_OP(0xA3, IndX, LAX<F>);
+		CPU_OP(0xA4, Zero, LDY<F>);
+		CPU_OP(0xA5, Zero, LDA<F>);
+		CPU_OP(0xA6, Zero, LDX<F>);
+		CPU_OP(0xA7, Zero, LAX<F>);
+		CPU_OP(0xA8, Imp, TAY);
+		CPU_OP(0xA9, Imm, LDA<F>);
+		CPU_OP(0xAA, Imp, TAX);
+		CPU_OP(0xAB, Imm, ATX<F>);
+		CPU_OP(0xAC, Abs, LDY<F>);
+		CPU_OP(0xAD, Abs, LDA<F>);
+		CPU_OP(0xAE, Abs, LDX<F>);
+		CPU_OP(0xAF, Abs, LAX<F>);
+		CPU_OP(0xB0, Rel, BCS<F>);
+		CPU_OP(0xB1, IndY, LDA<F>);
+		CPU_OP(0xB2, None, HLT<F>);
+		CPU_OP(0xB3, IndY, LAX<F>);
+		CPU_OP(0xB4, ZeroX, LDY<F>);
+		CPU_OP(0xB5, ZeroX, LDA<F>);
+		CPU_OP(0xB6, ZeroY, LDX<F>);
+		CPU_OP(0xB7, ZeroY, LAX<F>);
+		CPU_OP(0xB8, Imp, CLV);
+		CPU_OP(0xB9, AbsY, LDA<F>);
+		CPU_OP(0xBA, Imp, TSX);
+		CPU_OP(0xBB, AbsY, LAS<F>);
+		CPU_OP(0xBC, AbsX, LDY<F>);
+		CPU_OP(0xBD, AbsX, LDA<F>);
+		CPU_OP(0xBE, AbsY, LDX<F>);
+		CPU_OP(0xBF, AbsY, LAX<F>);
+		CPU_OP(0xC0, Imm, CPY<F>);
+		CPU_OP(0xC1, IndX, CPA<F>);
+		CPU_OP(0xC2, Imm, NOP<F>);
+		CPU_OP(0xC3, IndX, DCP<F>);
+		CPU_OP(0xC4, Zero, CPY<F>);
+		CPU_OP(0xC5, Zero, CPA<F>);
+		CPU_OP(0xC6, Zero, DEC<F>);
+		CPU_OP(0xC7, Zero, DCP<F>);
+		CPU_OP(0xC8, Imp, INY);
+		CPU_OP(0xC9, Imm, CPA<F>);
+		CPU_OP(0xCA, Imp, DEX);
+		CPU_OP(0xCB, Imm, AXS<F>);
+		CPU_OP(0xCC, Abs, CPY<F>);
+		CPU_OP(0xCD, Abs, CPA<F>);
+		CPU_OP(0xCE, Abs, DEC<F>);
+		CPU_OP(0xCF, Abs, DCP<F>);
+		CPU_OP(0xD0, Rel, BNE<F>);
+		CPU_OP(0xD1, IndY, CPA<F>);
+		CPU_OP(0xD2, None, HLT<F>);
+		CPU_OP(0xD3, IndYW, DCP<F>);
+		CPU_OP(0xD4, ZeroX, NOP<F>);
+		CPU_OP(0xD5, ZeroX, CPA<F>);
+		CPU_OP(0xD6, ZeroX, DEC<F>);
+		CPU_OP(0xD7, ZeroX, DCP<F>);
+		CPU_OP(0xD8, Imp, CLD);
+		CPU_OP(0xD9, AbsY, CPA<F>);
+		CPU_OP(0xDA, Imp, NOP<F>);
+		CPU_OP(0xDB, AbsYW, DCP<F>);
+		CPU_OP(0xDC, AbsX, NOP<F>);
+		CPU_OP(0xDD, AbsX, CPA<F>);
+		CPU_OP(0xDE, AbsXW, DEC<F>);
+		CPU_OP(0xDF, AbsXW, DCP<F>);
+		CPU_OP(0xE0, Imm, CPX<F>);
+		CPU_OP(0xE1, IndX, SBC<F>);
+		CPU_OP(0xE2, Imm, NOP<F>);
+		CPU_OP(0xE3, IndX, ISB<F>);
+		CPU_OP(0xE4, Zero, CPX<F>);
+		CPU_OP(0xE5, Zero, SBC<F>);
+		CPU_OP(0xE6, Zero, INC<F>);
+		CPU_OP(0xE7, Zero, ISB<F>);
+		CPU_OP(0xE8, Imp, INX);
+		CPU_OP(0xE9, Imm, SBC<F>);
+		CPU_OP(0xEA, Imp, NOP<F>);
+		CPU_OP(0xEB, Imm, SBC<F>);
+		CPU_OP(0xEC, Abs, CPX<F>);
+		CPU_OP(0xED, Abs, SBC<F>);
+		CPU_OP(0xEE, Abs, INC<F>);
+		CPU_OP(0xEF, Abs, ISB<F>);
+		CPU_OP(0xF0, Rel, BEQ<F>);
+		CPU_OP(0xF1, IndY, SBC<F>);
+		CPU_OP(0xF2, None, HLT<F>);
+		CPU_OP(0xF3, IndYW, ISB<F>);
+		CPU_OP(0xF4, ZeroX, NOP<F>);
+		CPU_OP(0xF5, ZeroX, SBC<F>);
+		CPU_OP(0xF6, ZeroX, INC<F>);
+		CPU_OP(0xF7, ZeroX, ISB<F>);
+		CPU_OP(0xF8, Imp, SED);
+		CPU_OP(0xF9, AbsY, SBC<F>);
+		CPU_OP(0xFA, Imp, NOP<F>);
+		CPU_OP(0xFB, AbsYW, ISB<F>);
+		CPU_OP(0xFC, AbsX, NOP<F>);
+		CPU_OP(0xFD, AbsX, SBC<F>);
+		CPU_OP(0xFE, AbsXW, INC<F>);
+		CPU_OP(0xFF, AbsXW, ISB<F>);
+	}
+	#undef CPU_OP
+}
+#endif
+
+template<uint8_t F>
 void CPU::IRQ() 
 {
 #ifndef DUMMYCPU
 	uint16_t originalPc = PC();
 #endif
 
-	DummyRead();  //fetch opcode (and discard it - $00 (BRK) is forced into the opcode register instead)
-	DummyRead();  //read next instruction byte (actually the same as above, since PC increment is suppressed. Also discarded.)
-	Push((uint16_t)(PC()));
+	DummyRead<F>();  //fetch opcode (and discard it - $00 (BRK) is forced into the opcode register instead)
+	DummyRead<F>();  //read next instruction byte (actually the same as above, since PC increment is suppressed. Also discarded.)
+	Push<F>((uint16_t)(PC()));
 
 	if(_needNmi) {
 		_needNmi = false;
-		Push((uint8_t)(PS() | PSFlags::Reserved));
+		Push<F>((uint8_t)(PS() | PSFlags::Reserved));
 		SetFlags(PSFlags::Interrupt);
 
-		SetPC(MemoryReadWord(CPU::NMIVector));
+		SetPC(MemoryReadWord<F>(CPU::NMIVector));
 
 		#ifndef DUMMYCPU
-		_console->DebugAddTrace("NMI");
-		_console->DebugProcessInterrupt(originalPc, _state.PC, true);
+		if(F & CpuFeatures::Debugger) {
+			_console->DebugAddTrace("NMI");
+			_console->DebugProcessInterrupt(originalPc, _state.PC, true);
+		}
 		#endif
 	} else {
-		Push((uint8_t)(PS() | PSFlags::Reserved));
+		Push<F>((uint8_t)(PS() | PSFlags::Reserved));
 		SetFlags(PSFlags::Interrupt);
 
-		SetPC(MemoryReadWord(CPU::IRQVector));
+		SetPC(MemoryReadWord<F>(CPU::IRQVector));
 
 		#ifndef DUMMYCPU
-		_console->DebugAddTrace("IRQ");
-		_console->DebugProcessInterrupt(originalPc, _state.PC, false);
+		if(F & CpuFeatures::Debugger) {
+			_console->DebugAddTrace("IRQ");
+			_console->DebugProcessInterrupt(originalPc, _state.PC, false);
+		}
 		#endif
 	}
 }
 
+template<uint8_t F>
 void CPU::BRK() {
-	Push((uint16_t)(PC() + 1));
+	Push<F>((uint16_t)(PC() + 1));
 
 	uint8_t flags = PS() | PSFlags::Break | PSFlags::Reserved;
 	if(_needNmi) {
 		_needNmi = false;
-		Push((uint8_t)flags);
+		Push<F>((uint8_t)flags);
 		SetFlags(PSFlags::Interrupt);
 
-		SetPC(MemoryReadWord(CPU::NMIVector));
+		SetPC(MemoryReadWord<F>(CPU::NMIVector));
 
 		#ifndef DUMMYCPU
-		_console->DebugAddTrace("NMI");
+		if(F & CpuFeatures::Debugger) {
+			_console->DebugAddTrace("NMI");
+		}
 		#endif
 	} else {
-		Push((uint8_t)flags);
+		Push<F>((uint8_t)flags);
 		SetFlags(PSFlags::Interrupt);
 
-		SetPC(MemoryReadWord(CPU::IRQVector));
+		SetPC(MemoryReadWord<F>(CPU::IRQVector));
 
 		#ifndef DUMMYCPU
-		_console->DebugAddTrace("IRQ");
+		if(F & CpuFeatures::Debugger) {
+			_console->DebugAddTrace("IRQ");
+		}
 		#endif
 	}
 
@@ -233,6 +536,7 @@ void CPU::BRK() {
 	_prevNeedNmi = false;
 }
 
+template<uint8_t F>
 void CPU::MemoryWrite(uint16_t addr, uint8_t value, MemoryOperationType operationType)
 {
 #ifdef DUMMYCPU
@@ -245,12 +549,14 @@ void CPU::MemoryWrite(uint16_t addr, uint8_t value, MemoryOperationType operatio
 #else
 	_cpuWrite = true;
 	StartCpuCycle(false);
-	_memoryManager->Write(addr, value, operationType);
+	SyncPpuForAccess(addr, true);
+	_memoryManager->Write<F>(addr, value, operationType);
 	EndCpuCycle(false);
 	_cpuWrite = false;
 #endif
 }
 
+template<uint8_t F>
 uint8_t CPU::MemoryRead(uint16_t addr, MemoryOperationType operationType) {
 #ifdef DUMMYCPU
 	uint8_t value = _memoryManager->DebugRead(addr);
@@ -265,31 +571,57 @@ uint8_t CPU::MemoryRead(uint16_t addr, MemoryOperationType operationType) {
 	ProcessPendingDma(addr);
 
 	StartCpuCycle(true);
-	uint8_t value = _memoryManager->Read(addr, operationType);
+	SyncPpuForAccess(addr, false);
+	uint8_t value = _memoryManager->Read<F>(addr, operationType);
 	EndCpuCycle(true);
 	return value;
 #endif
 }
 
+template<uint8_t F, AddrMode mode>
+uint16_t CPU::FetchOperand()
+{
+	switch(mode) {
+		case AddrMode::Acc:
+		case AddrMode::Imp: DummyRead<F>(); return 0;
+		case AddrMode::Imm:
+		case AddrMode::Rel: return GetImmediate<F>();
+		case AddrMode::Zero: return GetZeroAddr<F>();
+		case AddrMode::ZeroX: return GetZeroXAddr<F>();
+		case AddrMode::ZeroY: return GetZeroYAddr<F>();
+		case AddrMode::Ind: return GetIndAddr<F>();
+		case AddrMode::IndX: return GetIndXAddr<F>();
+		case AddrMode::IndY: return GetIndYAddr<F>(false);
+		case AddrMode::IndYW: return GetIndYAddr<F>(true);
+		case AddrMode::Abs: return GetAbsAddr<F>();
+		case AddrMode::AbsX: return GetAbsXAddr<F>(false);
+		case AddrMode::AbsXW: return GetAbsXAddr<F>(true);
+		case AddrMode::AbsY: return GetAbsYAddr<F>(false);
+		case AddrMode::AbsYW: return GetAbsYAddr<F>(true);
+		default: return FetchOperand<F>(); //Invalid opcode, let the generic version handle the crash
+	}
+}
+
+template<uint8_t F>
 uint16_t CPU::FetchOperand()
 {
 	switch(_instAddrMode) {
 		case AddrMode::Acc:
-		case AddrMode::Imp: DummyRead(); return 0;
+		case AddrMode::Imp: DummyRead<F>(); return 0;
 		case AddrMode::Imm:
-		case AddrMode::Rel: return GetImmediate();
-		case AddrMode::Zero: return GetZeroAddr();
-		case AddrMode::ZeroX: return GetZeroXAddr();
-		case AddrMode::ZeroY: return GetZeroYAddr();
-		case AddrMode::Ind: return GetIndAddr();
-		case AddrMode::IndX: return GetIndXAddr();
-		case AddrMode::IndY: return GetIndYAddr(false);
-		case AddrMode::IndYW: return GetIndYAddr(true);
-		case AddrMode::Abs: return GetAbsAddr();
-		case AddrMode::AbsX: return GetAbsXAddr(false);
-		case AddrMode::AbsXW: return GetAbsXAddr(true);
-		case AddrMode::AbsY: return GetAbsYAddr(false);
-		case AddrMode::AbsYW: return GetAbsYAddr(true);
+		case AddrMode::Rel: return GetImmediate<F>();
+		case AddrMode::Zero: return GetZeroAddr<F>();
+		case AddrMode::ZeroX: return GetZeroXAddr<F>();
+		case AddrMode::ZeroY: return GetZeroYAddr<F>();
+		case AddrMode::Ind: return GetIndAddr<F>();
+		case AddrMode::IndX: return GetIndXAddr<F>();
+		case AddrMode::IndY: return GetIndYAddr<F>(false);
+		case AddrMode::IndYW: return GetIndYAddr<F>(true);
+		case AddrMode::Abs: return GetAbsAddr<F>();
+		case AddrMode::AbsX: return GetAbsXAddr<F>(false);
+		case AddrMode::AbsXW: return GetAbsXAddr<F>(true);
+		case AddrMode::AbsY: return GetAbsYAddr<F>(false);
+		case AddrMode::AbsYW: return GetAbsYAddr<F>(true);
 		default: break;
 	}
 	
@@ -319,7 +651,7 @@ uint16_t CPU::FetchOperand()
 void CPU::EndCpuCycle(bool forRead)
 {
 	_masterClock += forRead ? (_endClockCount + 1) : (_endClockCount - 1);
-	_console->GetPpu()->Run(_masterClock - _ppuOffset);
+	RunPpu();
 
 	//"The internal signal goes high during φ1 of the cycle that follows the one where the edge is detected,
 	//and stays high until the NMI has been handled. "
@@ -343,10 +675,47 @@ void CPU::StartCpuCycle(bool forRead)
 {
 	_masterClock += forRead ? (_startClockCount - 1) : (_startClockCount + 1);
 	_cycleCount++;
-	_console->GetPpu()->Run(_masterClock - _ppuOffset);
+	RunPpu();
 	_console->ProcessCpuClock();
 }
 
+void CPU::RunPpu()
+{
+	PPU* ppu = _console->GetPpu();
+	if(!_ppuCatchUp) {
+		ppu->Run(_masterClock - _ppuOffset);
+	} else if(_masterClock - _ppuOffset >= ppu->GetCatchUpDeadline()) {
+		ppu->CatchUp(_masterClock - _ppuOffset);
+	}
+}
+
+void CPU::SyncPpuForAccess(uint16_t addr, bool forWrite)
+{
+	if(_ppuCatchUp) {
+		//Reads: PPU registers, and $4016/$4017 (light guns read the PPU's output)
+		//Writes: anything outside of internal RAM (PPU registers, OAM DMA, mapper registers that can switch CHR banks/mirroring)
+		if(forWrite ? addr >= 0x2000 : ((addr & 0xE000) == 0x2000 || addr == 0x4016 || addr == 0x4017)) {
+			_console->GetPpu()->CatchUp(_masterClock - _ppuOffset);
+		}
+	}
+}
+
+void CPU::CatchUpPpu()
+{
+	if(_ppuCatchUp) {
+		_console->GetPpu()->CatchUp(_masterClock - _ppuOffset);
+	}
+}
+
+void CPU::SetPpuCatchUpMode(bool enabled)
+{
+	if(_ppuCatchUp != enabled) {
+		//Bring the PPU up to date before switching modes
+		CatchUpPpu();
+		_ppuCatchUp = enabled;
+	}
+}
+
 void CPU::ProcessPendingDma(uint16_t readAddress)
 {
 	if(!_needHalt) {
@@ -354,6 +723,10 @@ void CPU::ProcessPendingDma(uint16_t readAddress)
 	}
 
 	//"If this cycle is a read, hijack the read, discard the value, and prevent all other actions that occur on this cycle (PC not incremented, etc)"
+	//DMA cycles can read/write PPU registers, run the PPU in lockstep until the transfer is over
+	bool ppuCatchUp = _ppuCatchUp;
+	SetPpuCatchUpMode(false);
+
 	StartCpuCycle(true);
 	_memoryManager->Read(readAddress, MemoryOperationType::DummyRead);
 	EndCpuCycle(true);
@@ -420,6 +793,8 @@ void CPU::ProcessPendingDma(uint16_t readAddress)
 			}
 		}
 	}
+
+	SetPpuCatchUpMode(ppuCatchUp);
 }
 
 void CPU::RunDMATransfer(uint8_t offsetValue)
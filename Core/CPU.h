@@ -38,8 +38,10 @@ private:
 	uint8_t _endClockCount;
 	uint16_t _operand;
 
-	Func _opTable[256];
+	//One opcode table per CpuFeatures combination, see ExecInstruction()
+	Func _opTable[CpuFeatures::All + 1][256];
 	AddrMode _addrMode[256];
+	uint8_t _features = CpuFeatures::None;
 	AddrMode _instAddrMode;
 
 	bool _needHalt = false;
@@ -65,6 +67,9 @@ private:
 
 	uint64_t _lastCrashWarning = 0;
 
+	//Catch-up mode: the PPU only runs when the CPU accesses it (or something it can affect), or when it reaches the end of frame/NMI window
+	bool _ppuCatchUp = false;
+
 #ifdef DUMMYCPU
 	uint32_t _writeCounter = 0;
 	uint16_t _writeAddresses[10];
@@ -77,34 +82,49 @@ private:
 	bool _isDummyRead[10];
 #endif
 
+	//The instruction set is instantiated once for each combination of CpuFeatures, so that
+	//the debugger/cheat hooks are compiled out of memory accesses when they are not in use
+	template<uint8_t F> void InitOpTable();
+	template<uint8_t F> void ExecInstruction();
+#ifdef CPU_SWITCH_DISPATCH
+	template<uint8_t F> void ExecOpCode(uint8_t opCode);
+#endif
+
 	__forceinline void StartCpuCycle(bool forRead);
 	__forceinline void ProcessPendingDma(uint16_t readAddress);
-	__forceinline uint16_t FetchOperand();
+	template<uint8_t F> __forceinline uint16_t FetchOperand();
+	template<uint8_t F, AddrMode mode> __forceinline uint16_t FetchOperand();
 	__forceinline void EndCpuCycle(bool forRead);
-	void IRQ();
+	__forceinline void RunPpu();
+	__forceinline void SyncPpuForAccess(uint16_t addr, bool forWrite);
+	template<uint8_t F> void IRQ();
 
+	template<uint8_t F>
 	uint8_t GetOPCode()
 	{
-		uint8_t opCode = MemoryRead(_state.PC, MemoryOperationType::ExecOpCode);
+		uint8_t opCode = MemoryRead<F>(_state.PC, MemoryOperationType::ExecOpCode);
 		_state.PC++;
 		return opCode;
 	}
 
+	template<uint8_t F>
 	void DummyRead()
 	{
-		MemoryRead(_state.PC, MemoryOperationType::DummyRead);
+		MemoryRead<F>(_state.PC, MemoryOperationType::DummyRead);
 	}
 	
+	template<uint8_t F>
 	uint8_t ReadByte()
 	{
-		uint8_t value = MemoryRead(_state.PC, MemoryOperationType::ExecOperand);
+		uint8_t value = MemoryRead<F>(_state.PC, MemoryOperationType::ExecOperand);
 		_state.PC++;
 		return value;
 	}
 
+	template<uint8_t F>
 	uint16_t ReadWord()
 	{
-		uint16_t value = MemoryReadWord(_state.PC, MemoryOperationType::ExecOperand);
+		uint16_t value = MemoryReadWord<F>(_state.PC, MemoryOperationType::ExecOperand);
 		_state.PC += 2;
 		return value;
 	}
@@ -143,12 +163,13 @@ private:
 		return ((valA + valB) & 0xFF00) != (valA & 0xFF00);
 	}
 
-	void MemoryWrite(uint16_t addr, uint8_t value, MemoryOperationType operationType = MemoryOperationType::Write);
-	uint8_t MemoryRead(uint16_t addr, MemoryOperationType operationType = MemoryOperationType::Read);
+	template<uint8_t F> void MemoryWrite(uint16_t addr, uint8_t value, MemoryOperationType operationType = MemoryOperationType::Write);
+	template<uint8_t F> uint8_t MemoryRead(uint16_t addr, MemoryOperationType operationType = MemoryOperationType::Read);
 
+	template<uint8_t F>
 	uint16_t MemoryReadWord(uint16_t addr, MemoryOperationType operationType = MemoryOperationType::Read) {
-		uint8_t lo = MemoryRead(addr, operationType);
-		uint8_t hi = MemoryRead(addr + 1, operationType);
+		uint8_t lo = MemoryRead<F>(addr, operationType);
+		uint8_t hi = MemoryRead<F>(addr + 1, operationType);
 		return lo | hi << 8;
 	}
 
@@ -158,24 +179,28 @@ private:
 		reg = value;
 	}
 
+	template<uint8_t F>
 	void Push(uint8_t value) {
-		MemoryWrite(SP() + 0x100, value);
+		MemoryWrite<F>(SP() + 0x100, value);
 		SetSP(SP() - 1);
 	}
 
+	template<uint8_t F>
 	void Push(uint16_t value) {
-		Push((uint8_t)(value >> 8));
-		Push((uint8_t)value);
+		Push<F>((uint8_t)(value >> 8));
+		Push<F>((uint8_t)value);
 	}
 
+	template<uint8_t F>
 	uint8_t Pop() {
 		SetSP(SP() + 1);
-		return MemoryRead(0x100 + SP());
+		return MemoryRead<F>(0x100 + SP());
 	}
 
+	template<uint8_t F>
 	uint16_t PopWord() {
-		uint8_t lo = Pop();
-		uint8_t hi = Pop();
+		uint8_t lo = Pop<F>();
+		uint8_t hi = Pop<F>();
 		
 		return lo | hi << 8;
 	}
@@ -198,102 +223,110 @@ private:
 		return _operand;
 	}
 
+	template<uint8_t F>
 	uint8_t GetOperandValue()
 	{
 		if(_instAddrMode >= AddrMode::Zero) {
-			return MemoryRead(GetOperand());
+			return MemoryRead<F>(GetOperand());
 		} else {
 			return (uint8_t)GetOperand();
 		}
 	}
 
-	uint16_t GetIndAddr() { return ReadWord(); }
-	uint8_t GetImmediate() { return ReadByte(); }
-	uint8_t GetZeroAddr() { return ReadByte(); }
+	template<uint8_t F> uint16_t GetIndAddr() { return ReadWord<F>(); }
+	template<uint8_t F> uint8_t GetImmediate() { return ReadByte<F>(); }
+	template<uint8_t F> uint8_t GetZeroAddr() { return ReadByte<F>(); }
+	template<uint8_t F>
 	uint8_t GetZeroXAddr() { 
-		uint8_t value = ReadByte();
-		MemoryRead(value, MemoryOperationType::DummyRead); //Dummy read
+		uint8_t value = ReadByte<F>();
+		MemoryRead<F>(value, MemoryOperationType::DummyRead); //Dummy read
 		return value + X();
 	}
+	template<uint8_t F>
 	uint8_t GetZeroYAddr() { 
-		uint8_t value = ReadByte();
-		MemoryRead(value, MemoryOperationType::DummyRead); //Dummy read
+		uint8_t value = ReadByte<F>();
+		MemoryRead<F>(value, MemoryOperationType::DummyRead); //Dummy read
 		return value + Y();
 	}
-	uint16_t GetAbsAddr() { return ReadWord(); }
+	template<uint8_t F> uint16_t GetAbsAddr() { return ReadWord<F>(); }
 
+	template<uint8_t F>
 	uint16_t GetAbsXAddr(bool dummyRead = true) { 
-		uint16_t baseAddr = ReadWord();
+		uint16_t baseAddr = ReadWord<F>();
 		bool pageCrossed = CheckPageCrossed(baseAddr, X());
 
 		if(pageCrossed || dummyRead) {
 			//Dummy read done by the processor (only when page is crossed for READ instructions)
-			MemoryRead(baseAddr + X() - (pageCrossed ? 0x100 : 0), MemoryOperationType::DummyRead);
+			MemoryRead<F>(baseAddr + X() - (pageCrossed ? 0x100 : 0), MemoryOperationType::DummyRead);
 		}
 		return baseAddr + X(); 
 	}
 
+	template<uint8_t F>
 	uint16_t GetAbsYAddr(bool dummyRead = true) { 
-		uint16_t baseAddr = ReadWord();
+		uint16_t baseAddr = ReadWord<F>();
 		bool pageCrossed = CheckPageCrossed(baseAddr, Y());
 		
 		if(pageCrossed || dummyRead) {
 			//Dummy read done by the processor (only when page is crossed for READ instructions)
-			MemoryRead(baseAddr + Y() - (pageCrossed ? 0x100 : 0), MemoryOperationType::DummyRead);
+			MemoryRead<F>(baseAddr + Y() - (pageCrossed ? 0x100 : 0), MemoryOperationType::DummyRead);
 		}
 
 		return baseAddr + Y(); 
 	}
 
+	template<uint8_t F>
 	uint16_t GetInd() { 
 		uint16_t addr = GetOperand();
 		if((addr & 0xFF) == 0xFF) {
-			auto lo = MemoryRead(addr);
-			auto hi = MemoryRead(addr - 0xFF);
+			auto lo = MemoryRead<F>(addr);
+			auto hi = MemoryRead<F>(addr - 0xFF);
 			return (lo | hi << 8);
 		} else {
-			return MemoryReadWord(addr);
+			return MemoryReadWord<F>(addr);
 		}
 	}
 
+	template<uint8_t F>
 	uint16_t GetIndXAddr() {
-		uint8_t zero = ReadByte();
+		uint8_t zero = ReadByte<F>();
 		
 		//Dummy read
-		MemoryRead(zero, MemoryOperationType::DummyRead);
+		MemoryRead<F>(zero, MemoryOperationType::DummyRead);
 
 		zero += X();
 		
 		uint16_t addr;
 		if(zero == 0xFF) {
-			addr = MemoryRead(0xFF) | MemoryRead(0x00) << 8;
+			addr = MemoryRead<F>(0xFF) | MemoryRead<F>(0x00) << 8;
 		} else {
-			addr = MemoryReadWord(zero);
+			addr = MemoryReadWord<F>(zero);
 		}
 		return addr;
 	}
 
+	template<uint8_t F>
 	uint16_t GetIndYAddr(bool dummyRead = true) {
-		uint8_t zero = ReadByte();
+		uint8_t zero = ReadByte<F>();
 		
 		uint16_t addr;
 		if(zero == 0xFF) {
-			addr = MemoryRead(0xFF) | MemoryRead(0x00) << 8;
+			addr = MemoryRead<F>(0xFF) | MemoryRead<F>(0x00) << 8;
 		} else {
-			addr = MemoryReadWord(zero);
+			addr = MemoryReadWord<F>(zero);
 		}
 
 		bool pageCrossed = CheckPageCrossed(addr, Y());			
 		if(pageCrossed || dummyRead) {
 			//Dummy read done by the processor (only when page is crossed for READ instructions)
-			MemoryRead(addr + Y() - (pageCrossed ? 0x100 : 0), MemoryOperationType::DummyRead);
+			MemoryRead<F>(addr + Y() - (pageCrossed ? 0x100 : 0), MemoryOperationType::DummyRead);
 		}
 		return addr + Y();
 	}
 
-	void AND() { SetA(A() & GetOperandValue()); }
-	void EOR() { SetA(A() ^ GetOperandValue()); }
-	void ORA() { SetA(A() | GetOperandValue()); }
+	template<uint8_t F> void AND() { SetA(A() & GetOperandValue<F>()); }
+	template<uint8_t F> void EOR() { SetA(A() ^ GetOperandValue<F>()); }
+	template<uint8_t F> void ORA() { SetA(A() | GetOperandValue<F>()); }
 
 	void ADD(uint8_t value)
 	{
@@ -310,8 +343,8 @@ private:
 		SetA((uint8_t)result);
 	}
 
-	void ADC() { ADD(GetOperandValue()); }
-	void SBC() { ADD(GetOperandValue() ^ 0xFF); }
+	template<uint8_t F> void ADC() { ADD(GetOperandValue<F>()); }
+	template<uint8_t F> void SBC() { ADD(GetOperandValue<F>() ^ 0xFF); }
 
 	void CMP(uint8_t reg, uint8_t value) 
 	{
@@ -330,33 +363,35 @@ private:
 		}
 	}
 
-	void CPA() { CMP(A(), GetOperandValue()); }
-	void CPX() { CMP(X(), GetOperandValue()); }
-	void CPY() { CMP(Y(), GetOperandValue()); }
+	template<uint8_t F> void CPA() { CMP(A(), GetOperandValue<F>()); }
+	template<uint8_t F> void CPX() { CMP(X(), GetOperandValue<F>()); }
+	template<uint8_t F> void CPY() { CMP(Y(), GetOperandValue<F>()); }
 
+	template<uint8_t F>
 	void INC() 
 	{
 		uint16_t addr = GetOperand();
 		ClearFlags(PSFlags::Negative | PSFlags::Zero);
-		uint8_t value = MemoryRead(addr);		
+		uint8_t value = MemoryRead<F>(addr);		
 		
-		MemoryWrite(addr, value, MemoryOperationType::DummyWrite); //Dummy write
+		MemoryWrite<F>(addr, value, MemoryOperationType::DummyWrite); //Dummy write
 		
 		value++;
 		SetZeroNegativeFlags(value);
-		MemoryWrite(addr, value);
+		MemoryWrite<F>(addr, value);
 	}
 
+	template<uint8_t F>
 	void DEC() 
 	{
 		uint16_t addr = GetOperand();
 		ClearFlags(PSFlags::Negative | PSFlags::Zero);
-		uint8_t value = MemoryRead(addr);
-		MemoryWrite(addr, value, MemoryOperationType::DummyWrite); //Dummy write
+		uint8_t value = MemoryRead<F>(addr);
+		MemoryWrite<F>(addr, value, MemoryOperationType::DummyWrite); //Dummy write
 		
 		value--;
 		SetZeroNegativeFlags(value);
-		MemoryWrite(addr, value);
+		MemoryWrite<F>(addr, value);
 	}
 
 	uint8_t ASL(uint8_t value)
@@ -407,38 +442,43 @@ private:
 		return result;
 	}
 
+	template<uint8_t F>
 	void ASLAddr() {
 		uint16_t addr = GetOperand();
-		uint8_t value = MemoryRead(addr);
-		MemoryWrite(addr, value, MemoryOperationType::DummyWrite); //Dummy write
-		MemoryWrite(addr, ASL(value));
+		uint8_t value = MemoryRead<F>(addr);
+		MemoryWrite<F>(addr, value, MemoryOperationType::DummyWrite); //Dummy write
+		MemoryWrite<F>(addr, ASL(value));
 	}
 
+	template<uint8_t F>
 	void LSRAddr() {
 		uint16_t addr = GetOperand();
-		uint8_t value = MemoryRead(addr);
-		MemoryWrite(addr, value, MemoryOperationType::DummyWrite); //Dummy write
-		MemoryWrite(addr, LSR(value));
+		uint8_t value = MemoryRead<F>(addr);
+		MemoryWrite<F>(addr, value, MemoryOperationType::DummyWrite); //Dummy write
+		MemoryWrite<F>(addr, LSR(value));
 	}
 
+	template<uint8_t F>
 	void ROLAddr() {
 		uint16_t addr = GetOperand();
-		uint8_t value = MemoryRead(addr);
-		MemoryWrite(addr, value, MemoryOperationType::DummyWrite); //Dummy write
-		MemoryWrite(addr, ROL(value));
+		uint8_t value = MemoryRead<F>(addr);
+		MemoryWrite<F>(addr, value, MemoryOperationType::DummyWrite); //Dummy write
+		MemoryWrite<F>(addr, ROL(value));
 	}
 
+	template<uint8_t F>
 	void RORAddr() {
 		uint16_t addr = GetOperand();
-		uint8_t value = MemoryRead(addr);
-		MemoryWrite(addr, value, MemoryOperationType::DummyWrite); //Dummy write
-		MemoryWrite(addr, ROR(value));
+		uint8_t value = MemoryRead<F>(addr);
+		MemoryWrite<F>(addr, value, MemoryOperationType::DummyWrite); //Dummy write
+		MemoryWrite<F>(addr, ROR(value));
 	}
 
 	void JMP(uint16_t addr) {
 		SetPC(addr);
 	}
 
+	template<uint8_t F>
 	void BranchRelative(bool branch) {
 		int8_t offset = (int8_t)GetOperand();
 		if(branch) {
@@ -447,18 +487,19 @@ private:
 			if(_runIrq && !_prevRunIrq) {
 				_runIrq = false;
 			}
-			DummyRead();
+			DummyRead<F>();
 
 			if(CheckPageCrossed(PC(), offset)) {
-				DummyRead();
+				DummyRead<F>();
 			}
 
 			SetPC(PC() + offset);
 		}
 	}
 
+	template<uint8_t F>
 	void BIT() {
-		uint8_t value = GetOperandValue();
+		uint8_t value = GetOperandValue<F>();
 		ClearFlags(PSFlags::Zero | PSFlags::Overflow | PSFlags::Negative);
 		if((A() & value) == 0) {
 			SetFlags(PSFlags::Zero);
@@ -472,13 +513,13 @@ private:
 	}
 
 	//OP Codes
-	void LDA() { SetA(GetOperandValue()); }
-	void LDX() { SetX(GetOperandValue()); }
-	void LDY() { SetY(GetOperandValue()); }
+	template<uint8_t F> void LDA() { SetA(GetOperandValue<F>()); }
+	template<uint8_t F> void LDX() { SetX(GetOperandValue<F>()); }
+	template<uint8_t F> void LDY() { SetY(GetOperandValue<F>()); }
 
-	void STA() { MemoryWrite(GetOperand(), A()); }
-	void STX() { MemoryWrite(GetOperand(), X()); }
-	void STY() { MemoryWrite(GetOperand(), Y()); }
+	template<uint8_t F> void STA() { MemoryWrite<F>(GetOperand(), A()); }
+	template<uint8_t F> void STX() { MemoryWrite<F>(GetOperand(), X()); }
+	template<uint8_t F> void STY() { MemoryWrite<F>(GetOperand(), Y()); }
 
 	void TAX() { SetX(A()); }
 	void TAY() { SetY(A()); }
@@ -487,18 +528,21 @@ private:
 	void TXS() { SetSP(X()); }
 	void TYA() { SetA(Y()); }
 
-	void PHA() { Push(A()); }
+	template<uint8_t F> void PHA() { Push<F>(A()); }
+	template<uint8_t F>
 	void PHP() {
 		uint8_t flags = PS() | PSFlags::Break | PSFlags::Reserved;
-		Push((uint8_t)flags);
+		Push<F>((uint8_t)flags);
 	}
+	template<uint8_t F>
 	void PLA() { 
-		DummyRead();
-		SetA(Pop()); 
+		DummyRead<F>();
+		SetA(Pop<F>()); 
 	}
+	template<uint8_t F>
 	void PLP() { 
-		DummyRead();
-		SetPS(Pop()); 
+		DummyRead<F>();
+		SetPS(Pop<F>()); 
 	}
 
 	void INX() { SetX(X() + 1); }
@@ -508,64 +552,74 @@ private:
 	void DEY() { SetY(Y() - 1); }
 
 	void ASL_Acc() { SetA(ASL(A())); }
-	void ASL_Memory() { ASLAddr(); }
+	template<uint8_t F> void ASL_Memory() { ASLAddr<F>(); }
 
 	void LSR_Acc() { SetA(LSR(A())); }
-	void LSR_Memory() { LSRAddr(); }
+	template<uint8_t F> void LSR_Memory() { LSRAddr<F>(); }
 
 	void ROL_Acc() { SetA(ROL(A())); }
-	void ROL_Memory() { ROLAddr(); }
+	template<uint8_t F> void ROL_Memory() { ROLAddr<F>(); }
 
 	void ROR_Acc() { SetA(ROR(A())); }
-	void ROR_Memory() { RORAddr(); }
+	template<uint8_t F> void ROR_Memory() { RORAddr<F>(); }
 
 	void JMP_Abs() {
 		JMP(GetOperand());
 	}
-	void JMP_Ind() { JMP(GetInd()); }
+	template<uint8_t F> void JMP_Ind() { JMP(GetInd<F>()); }
+	template<uint8_t F>
 	void JSR() {
 		uint16_t addr = GetOperand();
-		DummyRead();
-		Push((uint16_t)(PC() - 1));
+		DummyRead<F>();
+		Push<F>((uint16_t)(PC() - 1));
 		JMP(addr);
 	}
+	template<uint8_t F>
 	void RTS() {
-		uint16_t addr = PopWord();
-		DummyRead();
-		DummyRead();
+		uint16_t addr = PopWord<F>();
+		DummyRead<F>();
+		DummyRead<F>();
 		SetPC(addr + 1);
 	}
 
+	template<uint8_t F>
 	void BCC() {
-		BranchRelative(!CheckFlag(PSFlags::Carry));
+		BranchRelative<F>(!CheckFlag(PSFlags::Carry));
 	}
 
+	template<uint8_t F>
 	void BCS() {
-		BranchRelative(CheckFlag(PSFlags::Carry));
+		BranchRelative<F>(CheckFlag(PSFlags::Carry));
 	}
 
+	template<uint8_t F>
 	void BEQ() {
-		BranchRelative(CheckFlag(PSFlags::Zero));
+		BranchRelative<F>(CheckFlag(PSFlags::Zero));
 	}
 
+	template<uint8_t F>
 	void BMI() {
-		BranchRelative(CheckFlag(PSFlags::Negative));
+		BranchRelative<F>(CheckFlag(PSFlags::Negative));
 	}
 
+	template<uint8_t F>
 	void BNE() {
-		BranchRelative(!CheckFlag(PSFlags::Zero));
+		BranchRelative<F>(!CheckFlag(PSFlags::Zero));
 	}
 
+	template<uint8_t F>
 	void BPL() {
-		BranchRelative(!CheckFlag(PSFlags::Negative));
+		BranchRelative<F>(!CheckFlag(PSFlags::Negative));
 	}
 
+	template<uint8_t F>
 	void BVC() {
-		BranchRelative(!CheckFlag(PSFlags::Overflow));
+		BranchRelative<F>(!CheckFlag(PSFlags::Overflow));
 	}
 
+	template<uint8_t F>
 	void BVS() {
-		BranchRelative(CheckFlag(PSFlags::Overflow));
+		BranchRelative<F>(CheckFlag(PSFlags::Overflow));
 	}
 
 	void CLC() { ClearFlags(PSFlags::Carry); }
@@ -576,98 +630,109 @@ private:
 	void SED() { SetFlags(PSFlags::Decimal); }
 	void SEI() { SetFlags(PSFlags::Interrupt); }
 
-	void BRK();
+	template<uint8_t F> void BRK();
 	
+	template<uint8_t F>
 	void RTI() {
-		DummyRead();
-		SetPS(Pop());
-		SetPC(PopWord());
+		DummyRead<F>();
+		SetPS(Pop<F>());
+		SetPC(PopWord<F>());
 	}
 
+	template<uint8_t F>
 	void NOP() {
 		//Make sure the nop operation takes as many cycles as meant to
-		GetOperandValue();
+		GetOperandValue<F>();
 	}
 
 	
 	//Unofficial OpCodes
+	template<uint8_t F>
 	void SLO()
 	{
 		//ASL & ORA
-		uint8_t value = GetOperandValue();
-		MemoryWrite(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
+		uint8_t value = GetOperandValue<F>();
+		MemoryWrite<F>(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
 		uint8_t shiftedValue = ASL(value);
 		SetA(A() | shiftedValue);
-		MemoryWrite(GetOperand(), shiftedValue);
+		MemoryWrite<F>(GetOperand(), shiftedValue);
 	}
 	
+	template<uint8_t F>
 	void SRE()
 	{
 		//ROL & AND
-		uint8_t value = GetOperandValue();
-		MemoryWrite(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
+		uint8_t value = GetOperandValue<F>();
+		MemoryWrite<F>(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
 		uint8_t shiftedValue = LSR(value);
 		SetA(A() ^ shiftedValue);
-		MemoryWrite(GetOperand(), shiftedValue);
+		MemoryWrite<F>(GetOperand(), shiftedValue);
 	}
 	
+	template<uint8_t F>
 	void RLA()
 	{
 		//LSR & EOR
-		uint8_t value = GetOperandValue();
-		MemoryWrite(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
+		uint8_t value = GetOperandValue<F>();
+		MemoryWrite<F>(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
 		uint8_t shiftedValue = ROL(value);
 		SetA(A() & shiftedValue);
-		MemoryWrite(GetOperand(), shiftedValue);
+		MemoryWrite<F>(GetOperand(), shiftedValue);
 	}
 
+	template<uint8_t F>
 	void RRA()
 	{
 		//ROR & ADC
-		uint8_t value = GetOperandValue();
-		MemoryWrite(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
+		uint8_t value = GetOperandValue<F>();
+		MemoryWrite<F>(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
 		uint8_t shiftedValue = ROR(value);
 		ADD(shiftedValue);
-		MemoryWrite(GetOperand(), shiftedValue);
+		MemoryWrite<F>(GetOperand(), shiftedValue);
 	}
 
+	template<uint8_t F>
 	void SAX()
 	{
 		//STA & STX
-		MemoryWrite(GetOperand(), A() & X());
+		MemoryWrite<F>(GetOperand(), A() & X());
 	}
 
+	template<uint8_t F>
 	void LAX()
 	{
 		//LDA & LDX
-		uint8_t value = GetOperandValue();
+		uint8_t value = GetOperandValue<F>();
 		SetX(value);
 		SetA(value);
 	}
 
+	template<uint8_t F>
 	void DCP()
 	{
 		//DEC & CMP
-		uint8_t value = GetOperandValue();
-		MemoryWrite(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
+		uint8_t value = GetOperandValue<F>();
+		MemoryWrite<F>(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
 		value--;
 		CMP(A(), value);
-		MemoryWrite(GetOperand(), value);
+		MemoryWrite<F>(GetOperand(), value);
 	}
 
+	template<uint8_t F>
 	void ISB()
 	{
 		//INC & SBC
-		uint8_t value = GetOperandValue();
-		MemoryWrite(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
+		uint8_t value = GetOperandValue<F>();
+		MemoryWrite<F>(GetOperand(), value, MemoryOperationType::DummyWrite); //Dummy write
 		value++;
 		ADD(value ^ 0xFF);
-		MemoryWrite(GetOperand(), value);
+		MemoryWrite<F>(GetOperand(), value);
 	}
 
+	template<uint8_t F>
 	void AAC()
 	{
-		SetA(A() & GetOperandValue());
+		SetA(A() & GetOperandValue<F>());
 
 		ClearFlags(PSFlags::Carry);
 		if(CheckFlag(PSFlags::Negative)) {
@@ -675,19 +740,21 @@ private:
 		}
 	}
 
+	template<uint8_t F>
 	void ASR()
 	{
 		ClearFlags(PSFlags::Carry);
-		SetA(A() & GetOperandValue());
+		SetA(A() & GetOperandValue<F>());
 		if(A() & 0x01) {
 			SetFlags(PSFlags::Carry);
 		}
 		SetA(A() >> 1);
 	}
 
+	template<uint8_t F>
 	void ARR()
 	{
-		SetA(((A() & GetOperandValue()) >> 1) | (CheckFlag(PSFlags::Carry) ? 0x80 : 0x00));
+		SetA(((A() & GetOperandValue<F>()) >> 1) | (CheckFlag(PSFlags::Carry) ? 0x80 : 0x00));
 		ClearFlags(PSFlags::Carry | PSFlags::Overflow);
 		if(A() & 0x40) {
 			SetFlags(PSFlags::Carry);
@@ -697,19 +764,21 @@ private:
 		}
 	}
 
+	template<uint8_t F>
 	void ATX()
 	{
 		//LDA & TAX
-		uint8_t value = GetOperandValue();
+		uint8_t value = GetOperandValue<F>();
 		SetA(value); //LDA
 		SetX(A()); //TAX
 		SetA(A()); //Update flags based on A
 	}
 
+	template<uint8_t F>
 	void AXS()
 	{
 		//CMP & DEX
-		uint8_t opValue = GetOperandValue();
+		uint8_t opValue = GetOperandValue<F>();
 		uint8_t value = (A() & X()) - opValue;
 		
 		ClearFlags(PSFlags::Carry);
@@ -720,6 +789,7 @@ private:
 		SetX(value);
 	}
 
+	template<uint8_t F>
 	void SYA()
 	{
 		uint8_t addrHigh = GetOperand() >> 8;
@@ -729,39 +799,44 @@ private:
 		//From here: http://forums.nesdev.com/viewtopic.php?f=3&t=3831&start=30
 		//Unsure if this is accurate or not
 		//"the target address for e.g. SYA becomes ((y & (addr_high + 1)) << 8) | addr_low instead of the normal ((addr_high + 1) << 8) | addr_low"
-		MemoryWrite(((Y() & (addrHigh + 1)) << 8) | addrLow, value);
+		MemoryWrite<F>(((Y() & (addrHigh + 1)) << 8) | addrLow, value);
 	}
 
+	template<uint8_t F>
 	void SXA()
 	{
 		uint8_t addrHigh = GetOperand() >> 8;
 		uint8_t addrLow = GetOperand() & 0xFF;
 		uint8_t value = X() & (addrHigh + 1);
-		MemoryWrite(((X() & (addrHigh + 1)) << 8) | addrLow, value);
+		MemoryWrite<F>(((X() & (addrHigh + 1)) << 8) | addrLow, value);
 	}
 	
 	//Unimplemented/Incorrect Unofficial OP codes
+	template<uint8_t F>
 	void HLT()
 	{
 		//normally freezes the cpu, we can probably assume nothing will ever call this
-		GetOperandValue();
+		GetOperandValue<F>();
 	}
 
+	template<uint8_t F>
 	void UNK()
 	{
 		//Make sure we take the right amount of cycles (not reliable for operations that write to memory, etc.)
-		GetOperandValue();
+		GetOperandValue<F>();
 	}
 
+	template<uint8_t F>
 	void AXA()
 	{
 		uint16_t addr = GetOperand();
 		
 		//"This opcode stores the result of A AND X AND the high byte of the target address of the operand +1 in memory."	
 		//This may not be the actual behavior, but the read/write operations are needed for proper cycle counting
-		MemoryWrite(GetOperand(), ((addr >> 8) + 1) & A() & X());
+		MemoryWrite<F>(GetOperand(), ((addr >> 8) + 1) & A() & X());
 	}
 
+	template<uint8_t F>
 	void TAS()
 	{
 		//"AND X register with accumulator and store result in stack
@@ -769,13 +844,14 @@ private:
 		//target address of the argument + 1. Store result in memory."
 		uint16_t addr = GetOperand();
 		SetSP(X() & A());
-		MemoryWrite(addr, SP() & ((addr >> 8) + 1));
+		MemoryWrite<F>(addr, SP() & ((addr >> 8) + 1));
 	}
 
+	template<uint8_t F>
 	void LAS()
 	{
 		//"AND memory with stack pointer, transfer result to accumulator, X register and stack pointer."
-		uint8_t value = GetOperandValue();
+		uint8_t value = GetOperandValue<F>();
 		SetA(value & SP());
 		SetX(A());
 		SetSP(A());
@@ -799,6 +875,11 @@ public:
 	void RunDMATransfer(uint8_t offsetValue);
 	void StartDmcTransfer();
 
+	void SetPpuCatchUpMode(bool enabled);
+	void SetFeatures(uint8_t features) { _features = features; }
+	uint8_t GetFeatures() { return _features; }
+	void CatchUpPpu();
+
 	uint32_t GetClockRate(NesModel model);
 	bool IsCpuWrite() { return _cpuWrite; }
 		
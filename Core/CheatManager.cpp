@@ -100,6 +100,8 @@ void CheatManager::AddCode(CodeInfo &code)
 		_absoluteCheatCodes.push_back(code);
 	}
 	_hasCode = true;
+	_console->UpdateCpuFeatures();
+	_console->UpdateRunAheadCheats();
 	_console->GetNotificationManager()->SendNotification(ConsoleNotificationType::CheatAdded);
 }
 
@@ -140,6 +142,8 @@ void CheatManager::ClearCodes()
 	cheatRemoved |= _absoluteCheatCodes.size() > 0;
 	_absoluteCheatCodes.clear();
 	_hasCode = false;
+	_console->UpdateCpuFeatures();
+	_console->UpdateRunAheadCheats();
 
 	if(cheatRemoved) {
 		_console->GetNotificationManager()->SendNotification(ConsoleNotificationType::CheatRemoved);
@@ -63,6 +63,8 @@ protected:
 			if(_irqCounter == 0) {
 				_console->GetCpu()->SetIrqSource(IRQSource::External);
 			}
+		} else {
+			SuspendCpuClock();
 		}
 	}
 
@@ -27,6 +27,8 @@
 #include "MovieManager.h"
 #include "RewindManager.h"
 #include "SaveStateManager.h"
+#include "SaveStateContainer.h"
+#include "StateHasher.h"
 #include "HdPackBuilder.h"
 #include "HdAudioDevice.h"
 #include "FDS.h"
@@ -37,6 +39,7 @@
 #include "IBarcodeReader.h"
 #include "IBattery.h"
 #include "KeyManager.h"
+#include "GameClient.h"
 #include "BatteryManager.h"
 #include "DebugHud.h"
 #include "RomLoader.h"
@@ -49,6 +52,7 @@
 #include "ConsolePauseHelper.h"
 #include "EventManager.h"
 #include "PgoUtilities.h"
+#include "DirtyPageTracker.h"
 
 Console::Console(shared_ptr<Console> master, EmulationSettings* initialSettings)
 {
@@ -72,7 +76,9 @@ Console::Console(shared_ptr<Console> master, EmulationSettings* initialSettings)
 
 Console::~Console()
 {
-	MovieManager::Stop();
+	if(_movieManager) {
+		_movieManager->Stop();
+	}
 }
 
 void Console::Init()
@@ -84,6 +90,7 @@ void Console::Init()
 	_videoDecoder.reset(new VideoDecoder(shared_from_this()));
 
 	_saveStateManager.reset(new SaveStateManager(shared_from_this()));
+	_movieManager.reset(new MovieManager(shared_from_this()));
 	_cheatManager.reset(new CheatManager(shared_from_this()));
 	_debugHud.reset(new DebugHud());
 
@@ -97,6 +104,8 @@ void Console::Init()
 
 void Console::Release(bool forShutdown)
 {
+	ReleaseRunAheadConsole();
+
 	if(_slave) {
 		_slave->Release(true);
 		_slave.reset();
@@ -110,6 +119,8 @@ void Console::Release(bool forShutdown)
 		_videoRenderer.reset();
 
 		_debugHud.reset();
+		_movieManager->Stop();
+		_movieManager.reset();
 		_saveStateManager.reset();
 		_cheatManager.reset();
 
@@ -150,6 +161,11 @@ shared_ptr<SaveStateManager> Console::GetSaveStateManager()
 	return _saveStateManager;
 }
 
+shared_ptr<MovieManager> Console::GetMovieManager()
+{
+	return _movieManager;
+}
+
 shared_ptr<VideoDecoder> Console::GetVideoDecoder()
 {
 	return _videoDecoder;
@@ -293,13 +309,18 @@ bool Console::Initialize(VirtualFile &romFile, VirtualFile &patchFile, bool forP
 			}
 
 			_videoDecoder->StopThread();
+			ReleaseRunAheadConsole();
+			_runAheadConsoleFailed = false;
+			if(IsMaster() && !_isRunAheadConsole) {
+				_romFileData = romData.RawData;
+			}
 
 			if(isDifferentGame) {
 				_romFilepath = romFile;
 				_patchFilename = patchFile;
 				
 				//Changed game, stop all recordings
-				MovieManager::Stop();
+				_movieManager->Stop();
 				_soundMixer->StopRecording();
 				StopRecordingHdPack();
 			}
@@ -386,6 +407,9 @@ bool Console::Initialize(VirtualFile &romFile, VirtualFile &patchFile, bool forP
 				_hdAudioDevice.reset();
 			}
 
+			UpdateCpuFeatures();
+			UpdateDirtyPageTracking();
+
 			_model = NesModel::Auto;
 			UpdateNesModel(false);
 
@@ -415,7 +439,7 @@ bool Console::Initialize(VirtualFile &romFile, VirtualFile &patchFile, bool forP
 #ifndef LIBRETRO
 			//Don't use auto-save manager for libretro
 			//Only enable auto-save for the master console (VS Dualsystem)
-			if(IsMaster()) {
+			if(IsMaster() && !_isRunAheadConsole) {
 				_autoSaveManager.reset(new AutoSaveManager(shared_from_this()));
 			}
 #endif
@@ -423,7 +447,7 @@ bool Console::Initialize(VirtualFile &romFile, VirtualFile &patchFile, bool forP
 
 			FolderUtilities::AddKnownGameFolder(romFile.GetFolderPath());
 
-			if(IsMaster()) {
+			if(IsMaster() && !_isRunAheadConsole) {
 				if(!forPowerCycle) {
 					string modelName = _model == NesModel::PAL ? "PAL" : (_model == NesModel::Dendy ? "Dendy" : "NTSC");
 					string messageTitle = MessageManager::Localize("GameLoaded") + " (" + modelName + ")";
@@ -459,7 +483,10 @@ bool Console::Initialize(VirtualFile &romFile, VirtualFile &patchFile, bool forP
 
 void Console::ProcessCpuClock()
 {
-	_mapper->ProcessCpuClock();
+	//Mappers without CPU clock logic (or with an idle IRQ counter) and the APU between frame counter/DMC events are skipped here
+	if(_mapper->NeedCpuClock(_cpu->GetCycleCount())) {
+		_mapper->ProcessCpuClock();
+	}
 	_apu->ProcessCpuClock();
 }
 
@@ -617,11 +644,19 @@ void Console::ResetComponents(bool softReset)
 		_ppu->Reset();
 	}
 	_apu->Reset(softReset);
+	_mapper->ResumeCpuClock();
 	_cpu->Reset(softReset, _model);
 	_controlManager->Reset(softReset);
 
 	_resetRunTimers = true;
 
+	if(_dirtyPageTracker && !softReset) {
+		//RAM is reinitialized on power cycle
+		_dirtyPageTracker->MarkAllDirty();
+	}
+
+	_runAheadResync = true;
+
 	//This notification MUST be sent before the UpdateInputState() below to allow MovieRecorder to grab the first frame's worth of inputs
 	_notificationManager->SendNotification(softReset ? ConsoleNotificationType::GameReset : ConsoleNotificationType::GameLoaded);
 
@@ -685,15 +720,13 @@ void Console::Resume()
 void Console::RunSingleFrame()
 {
 	//Used by Libretro
-	uint32_t lastFrameNumber = _ppu->GetFrameCount();
 	_emulationThreadId = std::this_thread::get_id();
 	UpdateNesModel(true);
 
-	while(_ppu->GetFrameCount() == lastFrameNumber) {
-		_cpu->Exec();
-		if(_slave) {
-			RunSlaveCpu();
-		}
+	if(UpdateRunAheadConsole()) {
+		RunFrameWithShadowRunAhead();
+	} else {
+		RunFrame();
 	}
 
 	_settings->DisableOverclocking(_disableOcNextFrame || IsNsf());
@@ -728,6 +761,120 @@ void Console::RunFrame()
 	}
 }
 
+HeadlessRunResult Console::RunFrames(uint32_t frameCount, HeadlessRunOptions options)
+{
+	HeadlessRunResult result;
+	if(!_initialized || _running) {
+		//Can't be used while the regular emulation loop is running
+		return result;
+	}
+
+	auto lock = _runLock.AcquireSafe();
+
+	_emulationThreadId = std::this_thread::get_id();
+	if(_slave) {
+		_slave->_emulationThreadId = _emulationThreadId;
+	}
+
+	_headlessRun = true;
+	_headlessOptions = options;
+	_notificationManager->SetEnabled(options.SendNotifications);
+	if(_slave) {
+		_slave->_headlessRun = true;
+		_slave->_headlessOptions = options;
+		_slave->_notificationManager->SetEnabled(options.SendNotifications);
+	}
+
+	UpdateNesModel(options.SendNotifications);
+
+	Timer timer;
+	try {
+		for(uint32_t i = 0; i < frameCount && !_stop; i++) {
+			RunFrame();
+
+			if(!_isRunAheadConsole) {
+				_settings->DisableOverclocking(_disableOcNextFrame || IsNsf());
+				_disableOcNextFrame = false;
+			}
+
+			_systemActionManager->ProcessSystemActions();
+			_apu->EndFrame();
+			if(_slave) {
+				_slave->_apu->EndFrame();
+			}
+
+			UpdateNesModel(options.SendNotifications);
+			result.FrameCount++;
+
+			if(_pauseCounter > 0) {
+				//Let other threads perform thread-safe operations (save/load state, etc.) between frames
+				_runLock.Release();
+				while(_pauseCounter > 0) { }
+				_runLock.Acquire();
+			}
+		}
+	} catch(const std::runtime_error &ex) {
+		_stopCode = -1;
+		MessageManager::Log("[Headless] Emulation crashed: " + string(ex.what()));
+	}
+	result.ElapsedMs = timer.GetElapsedMS();
+	result.Fps = result.ElapsedMs > 0 ? result.FrameCount / (result.ElapsedMs / 1000) : 0;
+
+	_stop = false;
+	_headlessRun = false;
+	_notificationManager->SetEnabled(true);
+	if(_slave) {
+		_slave->_headlessRun = false;
+		_slave->_notificationManager->SetEnabled(true);
+	}
+
+	_emulationThreadId = std::thread::id();
+
+	return result;
+}
+
+bool Console::IsHeadlessRun()
+{
+	return _headlessRun;
+}
+
+bool Console::IsVideoDecodeEnabled()
+{
+	return !_headlessRun || _headlessOptions.DecodeVideo;
+}
+
+bool Console::IsAudioEnabled()
+{
+	return !_headlessRun || _headlessOptions.ProcessAudio;
+}
+
+bool Console::IsRunAheadConsole()
+{
+	return _isRunAheadConsole;
+}
+
+void Console::UpdateRunAheadCheats()
+{
+	if(_runAheadConsole) {
+		CheatManager* cheatManager = _runAheadConsole->_cheatManager.get();
+		cheatManager->ClearCodes();
+		for(CodeInfo &code : _cheatManager->GetCheats()) {
+			cheatManager->AddCustomCode(code.Address, code.Value, code.CompareValue, code.IsRelativeAddress);
+		}
+		_runAheadResync = true;
+	}
+}
+
+void Console::InvalidateRunAhead()
+{
+	_runAheadResync = true;
+}
+
+bool Console::IsRunAheadMainFrame()
+{
+	return _runAheadMainFrame;
+}
+
 void Console::Run()
 {
 	Timer clockTimer;
@@ -762,11 +909,17 @@ void Console::Run()
 		while(true) {
 			stringstream runAheadState;
 			bool useRunAhead = _settings->GetRunAheadFrames() > 0 && !_debugger && !_rewindManager->IsRewinding() && _settings->GetEmulationSpeed() > 0 && _settings->GetEmulationSpeed() <= 100;
-			if(useRunAhead) {
+			bool useShadowRunAhead = UpdateRunAheadConsole() && useRunAhead;
+
+			Timer emulationTimer;
+			if(useShadowRunAhead) {
+				RunFrameWithShadowRunAhead();
+			} else if(useRunAhead) {
 				RunFrameWithRunAhead(runAheadState);
 			} else {
 				RunFrame();
 			}
+			double emulationTime = emulationTimer.GetElapsedMS();
 
 			_soundMixer->ProcessEndOfFrame();
 			if(_slave) {
@@ -806,9 +959,9 @@ void Console::Run()
 				frameDurations[frameDurationIndex] = lastFrameTime;
 				frameDurationIndex = (frameDurationIndex + 1) % 60;
 
-				DisplayDebugInformation(lastFrameTime, lastFrameMin, lastFrameMax, frameDurations);
+				DisplayDebugInformation(lastFrameTime, lastFrameMin, lastFrameMax, frameDurations, emulationTime);
 				if(_slave) {
-					_slave->DisplayDebugInformation(lastFrameTime, lastFrameMin, lastFrameMax, frameDurations);
+					_slave->DisplayDebugInformation(lastFrameTime, lastFrameMin, lastFrameMax, frameDurations, emulationTime);
 				}
 			}
 
@@ -824,7 +977,7 @@ void Console::Run()
 			//Sleep until we're ready to start the next frame
 			clockTimer.WaitUntil(targetTime);
 
-			if(useRunAhead) {
+			if(useRunAhead && !useShadowRunAhead) {
 				_settings->SetRunAheadFrameFlag(true);
 				LoadState(runAheadState);
 				_settings->SetRunAheadFrameFlag(false);
@@ -909,7 +1062,7 @@ void Console::Run()
 	StopRecordingHdPack();
 
 	_soundMixer->StopAudio();
-	MovieManager::Stop();
+	_movieManager->Stop();
 	_soundMixer->StopRecording();
 
 	PlatformUtilities::EnableScreensaver();
@@ -957,6 +1110,130 @@ void Console::RunFrameWithRunAhead(std::stringstream& runAheadState)
 	_apu->EndFrame();
 }
 
+bool Console::UpdateRunAheadConsole()
+{
+	//The shadow console can only replay local input, so the regular run-ahead mode is used for movies, netplay, HD packs, etc.
+	bool enabled = _settings->CheckFlag(EmulationFlags::RunAheadShadowConsole) && _settings->GetRunAheadFrames() > 0 && IsMaster() && !_slave && !_hdData && !_movieManager->Playing() && !GameClient::Connected();
+	if(!enabled) {
+		ReleaseRunAheadConsole();
+		return false;
+	} else if(_runAheadConsole) {
+		return true;
+	} else if(_runAheadConsoleFailed) {
+		return false;
+	}
+
+	//The shadow console shares this console's settings, restore the input settings that its constructor replaced
+	shared_ptr<Console> console(new Console(nullptr, _settings.get()));
+	console->_settings = _settings;
+	console->_isRunAheadConsole = true;
+	KeyManager::SetSettings(_settings.get());
+
+	//Load the same data as this console (the file on disk may not exist, or may not have been patched, e.g for libretro's in-memory games)
+	console->Init();
+	VirtualFile romFile(_romFileData.data(), _romFileData.size(), GetRomPath().GetFilePath());
+	if(!console->Initialize(romFile)) {
+		console->Release(true);
+		MessageManager::Log("[Run-ahead] Could not create the shadow console, using the regular run-ahead mode instead.");
+		_runAheadConsoleFailed = true;
+		return false;
+	}
+
+	//The shadow console never outputs audio/video on its own and must never overwrite the game's save data
+	console->_videoDecoder->StopThread();
+	console->_batteryManager->SetSaveEnabled(false);
+
+	_runAheadConsole = console;
+	_runAheadResync = true;
+	UpdateRunAheadCheats();
+	return true;
+}
+
+void Console::ReleaseRunAheadConsole()
+{
+	if(_runAheadConsole) {
+		_runAheadConsole->Release(true);
+		_runAheadConsole.reset();
+	}
+}
+
+void Console::RunFrameWithShadowRunAhead()
+{
+	//Run the actual frame on this console (audio, input recording, rewind, etc.) without sending its video to the decoder
+	//Relative pointing devices (Arkanoid, mice) drain the mouse movement when they poll it, so record what they got during this frame
+	KeyManager::ResetPolledMouseMovement();
+	_runAheadMainFrame = true;
+	RunFrame();
+	_runAheadMainFrame = false;
+	bool mouseMoved = KeyManager::HasPolledMouseMovement();
+	KeyManager::ResetPolledMouseMovement();
+
+	_settings->SetRunAheadFrameFlag(true);
+	if(UpdateRunAheadPrediction(mouseMoved)) {
+		//The shadow console ran its frames with the same input this console just used, so it is still in sync - run 1 more frame
+		_runAheadConsole->RunFrames(1, HeadlessRunOptions());
+		_runAheadPredictedFrames++;
+	} else {
+		//Copy the state over to the shadow console - this console's state is never rolled back
+		size_t stateSize = SaveState(_runAheadState.data(), _runAheadState.size());
+		if(stateSize > _runAheadState.size()) {
+			_runAheadState.resize(stateSize);
+			SaveState(_runAheadState.data(), _runAheadState.size());
+		}
+
+		_runAheadConsole->LoadState(_runAheadState.data(), stateSize);
+		_runAheadConsole->RunFrames(_settings->GetRunAheadFrames(), HeadlessRunOptions());
+		_runAheadPredictedFrames = 0;
+		_runAheadRollbackCount++;
+	}
+	_settings->SetRunAheadFrameFlag(false);
+
+	if(KeyManager::HasPolledMouseMovement()) {
+		//The shadow console's devices got movement that the prediction (no movement) didn't include, roll it back on the next frame
+		_runAheadResync = true;
+	}
+
+	//Display the shadow console's last frame (UpdateFrame copies it, the shadow console can keep running)
+#ifdef LIBRETRO
+	_videoDecoder->UpdateFrameSync(_runAheadConsole->_ppu->GetScreenBuffer(false));
+#else
+	_videoDecoder->UpdateFrame(_runAheadConsole->_ppu->GetScreenBuffer(false));
+#endif
+}
+
+bool Console::UpdateRunAheadPrediction(bool mouseMoved)
+{
+	//Preemptive mode: the shadow console's frames were run with the input of the previous frame (the prediction),
+	//so they only need to be run again when the input changes (or after a state load, reset, etc.)
+	vector<uint32_t> keys = KeyManager::GetPressedKeys();
+	MousePosition mousePosition = KeyManager::GetMousePosition();
+	uint8_t mouseButtons = (
+		(KeyManager::IsMouseButtonPressed(MouseButton::LeftButton) ? 0x01 : 0) |
+		(KeyManager::IsMouseButtonPressed(MouseButton::RightButton) ? 0x02 : 0) |
+		(KeyManager::IsMouseButtonPressed(MouseButton::MiddleButton) ? 0x04 : 0)
+	);
+
+	//The flag can be set by other threads (debugger, UI), so it is cleared as it is read
+	bool resync = _runAheadResync.exchange(false);
+	bool predicted = (
+		_settings->IsRunAheadPreemptive() && !resync && _runAheadPredictedFrames < Console::RunAheadMaxPredictedFrames &&
+		_runAheadLastFrameCount == _settings->GetRunAheadFrames() && keys == _runAheadKeys &&
+		mousePosition.X == _runAheadMousePosition.X && mousePosition.Y == _runAheadMousePosition.Y &&
+		mouseButtons == _runAheadMouseButtons && !mouseMoved
+	);
+
+	_runAheadKeys = keys;
+	_runAheadMousePosition = mousePosition;
+	_runAheadMouseButtons = mouseButtons;
+	_runAheadLastFrameCount = _settings->GetRunAheadFrames();
+	return predicted;
+}
+
+uint32_t Console::GetRunAheadRollbackCount()
+{
+	return _runAheadRollbackCount;
+}
+
 void Console::ResetRunTimers()
 {
 	_resetRunTimers = true;
@@ -999,8 +1276,13 @@ void Console::PauseOnNextFrame()
 void Console::UpdateNesModel(bool sendNotification)
 {
 	bool configChanged = false;
-	if(_settings->NeedControllerUpdate()) {
+	if(!_isRunAheadConsole && _settings->NeedControllerUpdate()) {
 		_controlManager->UpdateControlDevices();
+		if(_runAheadConsole) {
+			//The shadow console shares the settings but never reads their one-shot flags, its devices are updated along with this console's
+			_runAheadConsole->_controlManager->UpdateControlDevices();
+			_runAheadResync = true;
+		}
 		configChanged = true;
 	}
 
@@ -1021,11 +1303,22 @@ void Console::UpdateNesModel(bool sendNotification)
 		}
 	}
 
+	//Make sure the PPU is up to date before its timings are updated
+	_cpu->CatchUpPpu();
+
 	_cpu->SetMasterClockDivider(model);
 	_mapper->SetNesModel(model);
 	_ppu->SetNesModel(model);
 	_apu->SetNesModel(model);
 
+	//Catch-up PPU sync is only used when nothing needs to observe the PPU on every cycle
+	bool ppuCatchUp = (
+		_settings->CheckFlag(EmulationFlags::PpuCatchUpSync) && !_debugger && !_hdData && !_hdPackBuilder && !IsDualSystem() &&
+		_mapper->AllowPpuCatchUp() && !_settings->CheckFlag(EmulationFlags::EnableOamDecay) &&
+		_settings->GetPpuExtraScanlinesBeforeNmi() == 0 && _settings->GetPpuExtraScanlinesAfterNmi() == 0
+	);
+	_cpu->SetPpuCatchUpMode(ppuCatchUp);
+
 	if(configChanged && sendNotification) {
 		_notificationManager->SendNotification(ConsoleNotificationType::ConfigChanged);
 	}
@@ -1053,74 +1346,263 @@ double Console::GetFrameDelay()
 
 void Console::SaveState(ostream &saveStream)
 {
+	if(_initialized) {
+		vector<uint8_t> state(_lastSaveStateSize);
+		size_t size = SaveState(state.data(), state.size());
+		if(size > state.size()) {
+			state.resize(size);
+			SaveState(state.data(), state.size());
+		}
+		_lastSaveStateSize = size;
+		saveStream.write((char*)state.data(), size);
+	}
+}
+
+void Console::LoadState(istream &loadStream)
+{
+	LoadState(loadStream, SaveStateManager::FileFormatVersion);
+}
+
+void Console::LoadState(istream &loadStream, uint32_t stateVersion)
+{
+	if(_initialized) {
+		if(stateVersion < 14) {
+			LoadFlatState(loadStream, stateVersion);
+			return;
+		}
+
+		//Read the table of contents to find out the container's size, then load it from memory
+		//The table of contents is only trusted once its sections are known to fit in the stream
+		std::streampos start = loadStream.tellg();
+		SaveStateSectionInfo sections[SaveStateContainer::MaxSectionCount];
+		uint32_t sectionCount = SaveStateContainer::ReadTableOfContents(loadStream, sections);
+		if(sectionCount == 0) {
+			MessageManager::Log("[SaveState] Invalid or corrupted save state data.");
+			return;
+		}
+
+		vector<uint8_t> state(SaveStateContainer::GetContainerSize(sections, sectionCount));
+		loadStream.seekg(start);
+		loadStream.read((char*)state.data(), state.size());
+
+		if(!loadStream || !SaveStateContainer::ValidateChecksums(state.data(), state.size())) {
+			MessageManager::Log("[SaveState] Invalid or corrupted save state data.");
+			return;
+		}
+
+		LoadState(state.data(), state.size(), stateVersion);
+	}
+}
+
+void Console::LoadFlatState(istream &loadStream, uint32_t stateVersion)
+{
+	//Save states prior to version 14 contain each component's snapshot one after the other, without a table of contents
+	//Send any unprocessed sound to the SoundMixer - needed for rewind
+	_apu->EndFrame();
+
+	_cpu->LoadSnapshot(&loadStream, stateVersion);
+	_ppu->LoadSnapshot(&loadStream, stateVersion);
+	_memoryManager->LoadSnapshot(&loadStream, stateVersion);
+	_apu->LoadSnapshot(&loadStream, stateVersion);
+	_controlManager->LoadSnapshot(&loadStream, stateVersion);
+	_mapper->LoadSnapshot(&loadStream, stateVersion);
+	if(_hdAudioDevice) {
+		_hdAudioDevice->LoadSnapshot(&loadStream, stateVersion);
+	} else {
+		Snapshotable::SkipBlock(&loadStream);
+	}
+
+	if(_slave) {
+		//For VS Dualsystem, the slave console's savestate is appended to the end of the file
+		_slave->LoadState(loadStream, stateVersion);
+	}
+
+	ProcessStateLoaded();
+}
+
+size_t Console::SaveState(uint8_t* buffer, size_t capacity)
+{
+	size_t size = 0;
 	if(_initialized) {
 		//Send any unprocessed sound to the SoundMixer - needed for rewind
 		_apu->EndFrame();
 
-		_cpu->SaveSnapshot(&saveStream);
-		_ppu->SaveSnapshot(&saveStream);
-		_memoryManager->SaveSnapshot(&saveStream);
-		_apu->SaveSnapshot(&saveStream);
-		_controlManager->SaveSnapshot(&saveStream);
-		_mapper->SaveSnapshot(&saveStream);
-		if(_hdAudioDevice) {
-			_hdAudioDevice->SaveSnapshot(&saveStream);
-		} else {
-			Snapshotable::WriteEmptyBlock(&saveStream);
+		//The PPU's state must match the CPU's when catch-up sync is enabled
+		_cpu->CatchUpPpu();
+
+		Snapshotable* components[] = { _cpu.get(), _ppu.get(), _memoryManager.get(), _apu.get(), _controlManager.get(), _mapper.get(), _hdAudioDevice.get() };
+		uint32_t componentCount = _hdAudioDevice ? 7 : 6;
+
+		SaveStateContainer container(buffer, capacity, componentCount + (_slave ? 1 : 0));
+		for(uint32_t i = 0; i < componentCount; i++) {
+			uint32_t sectionCapacity = (uint32_t)std::min<size_t>(container.GetSectionCapacity(), UINT32_MAX);
+			container.AddSection((SaveStateSection)i, components[i]->SaveSnapshot(container.GetSectionBuffer(), sectionCapacity));
 		}
 
 		if(_slave) {
-			//For VS Dualsystem, append the 2nd console's savestate
-			_slave->SaveState(saveStream);
+			//For VS Dualsystem, the 2nd console's savestate is stored in its own section
+			container.AddSection(SaveStateSection::Slave, _slave->SaveState(container.GetSectionBuffer(), container.GetSectionCapacity()));
 		}
+		size = container.GetSize();
 	}
+	return size;
 }
 
-void Console::LoadState(istream &loadStream)
+size_t Console::GetMaxSaveStateSize()
 {
-	LoadState(loadStream, SaveStateManager::FileFormatVersion);
+	size_t size = SaveState(nullptr, 0);
+	if(_initialized) {
+		size += _mapper->GetMaxStateSizeGrowth();
+		if(_slave) {
+			size += _slave->_mapper->GetMaxStateSizeGrowth();
+		}
+	}
+	return size;
 }
 
-void Console::LoadState(istream &loadStream, uint32_t stateVersion)
+void Console::LoadState(const uint8_t* buffer, size_t bufferSize)
+{
+	LoadState(buffer, bufferSize, SaveStateManager::FileFormatVersion);
+}
+
+size_t Console::LoadState(const uint8_t* buffer, size_t bufferSize, uint32_t stateVersion)
 {
+	size_t position = 0;
 	if(_initialized) {
+		if(stateVersion < 14) {
+			return LoadFlatState(buffer, bufferSize, stateVersion);
+		}
+
+		SaveStateSectionInfo sections[SaveStateContainer::MaxSectionCount];
+		uint32_t sectionCount = SaveStateContainer::ReadTableOfContents(buffer, bufferSize, sections);
+		if(sectionCount == 0) {
+			return 0;
+		}
+
 		//Send any unprocessed sound to the SoundMixer - needed for rewind
 		_apu->EndFrame();
 
-		_cpu->LoadSnapshot(&loadStream, stateVersion);
-		_ppu->LoadSnapshot(&loadStream, stateVersion);
-		_memoryManager->LoadSnapshot(&loadStream, stateVersion);
-		_apu->LoadSnapshot(&loadStream, stateVersion);
-		_controlManager->LoadSnapshot(&loadStream, stateVersion);
-		_mapper->LoadSnapshot(&loadStream, stateVersion);
-		if(_hdAudioDevice) {
-			_hdAudioDevice->LoadSnapshot(&loadStream, stateVersion);
-		} else {
-			Snapshotable::SkipBlock(&loadStream);
+		//Sections are loaded in place, in the components' order - missing sections are skipped
+		Snapshotable* components[] = { _cpu.get(), _ppu.get(), _memoryManager.get(), _apu.get(), _controlManager.get(), _mapper.get(), _hdAudioDevice.get() };
+		for(uint32_t i = 0; i < 7; i++) {
+			const SaveStateSectionInfo* section = SaveStateContainer::FindSection(sections, sectionCount, (SaveStateSection)i);
+			if(section && components[i]) {
+				components[i]->LoadSnapshot(buffer + section->Offset, section->Size, stateVersion);
+			}
 		}
 
-		if(_slave) {
-			//For VS Dualsystem, the slave console's savestate is appended to the end of the file
-			_slave->LoadState(loadStream, stateVersion);
+		const SaveStateSectionInfo* slaveSection = SaveStateContainer::FindSection(sections, sectionCount, SaveStateSection::Slave);
+		if(_slave && slaveSection) {
+			_slave->LoadState(buffer + slaveSection->Offset, slaveSection->Size, stateVersion);
 		}
-		
-		shared_ptr<Debugger> debugger = _debugger;
-		if(debugger) {
-			debugger->ResetCounters();
+
+		ProcessStateLoaded();
+		position = SaveStateContainer::GetContainerSize(sections, sectionCount);
+	}
+	return position;
+}
+
+size_t Console::LoadFlatState(const uint8_t* buffer, size_t bufferSize, uint32_t stateVersion)
+{
+	size_t position = 0;
+
+	//Send any unprocessed sound to the SoundMixer - needed for rewind
+	_apu->EndFrame();
+
+	auto getSize = [&]() { return (uint32_t)std::min<size_t>(bufferSize - position, UINT32_MAX); };
+
+	Snapshotable* components[] = { _cpu.get(), _ppu.get(), _memoryManager.get(), _apu.get(), _controlManager.get(), _mapper.get() };
+	for(Snapshotable* component : components) {
+		position += component->LoadSnapshot(buffer + position, getSize(), stateVersion);
+	}
+
+	if(_hdAudioDevice) {
+		position += _hdAudioDevice->LoadSnapshot(buffer + position, getSize(), stateVersion);
+	} else {
+		position += Snapshotable::SkipBlock(buffer + position, getSize());
+	}
+
+	if(_slave) {
+		//For VS Dualsystem, the slave console's savestate is appended to the end of the file
+		position += _slave->LoadState(buffer + position, bufferSize - position, stateVersion);
+	}
+
+	ProcessStateLoaded();
+	return position;
+}
+
+uint64_t Console::GetStateHash()
+{
+	StateHasher hasher;
+	if(_initialized) {
+		//The PPU's state must match the CPU's when catch-up sync is enabled
+		_cpu->CatchUpPpu();
+
+		Snapshotable* components[] = { _cpu.get(), _ppu.get(), _memoryManager.get(), _apu.get(), _controlManager.get(), _mapper.get(), _hdAudioDevice.get() };
+		for(Snapshotable* component : components) {
+			if(component) {
+				component->HashSnapshot(hasher);
+			}
 		}
 
-		_debugHud->ClearScreen();
-		_notificationManager->SendNotification(ConsoleNotificationType::StateLoaded);
-		UpdateNesModel(false);
+		if(_slave) {
+			hasher.Update(_slave->GetStateHash());
+		}
+	}
+	return hasher.GetHash();
+}
+
+void Console::ProcessStateLoaded()
+{
+	shared_ptr<Debugger> debugger = _debugger;
+	if(debugger) {
+		debugger->ResetCounters();
+	}
+
+	if(_dirtyPageTracker) {
+		_dirtyPageTracker->MarkAllDirty();
+	}
+
+	_runAheadResync = true;
+	_debugHud->ClearScreen();
+	_notificationManager->SendNotification(ConsoleNotificationType::StateLoaded);
+	UpdateNesModel(false);
+}
+
+DirtyPageTracker* Console::SubscribeDirtyPageTracking()
+{
+	if(_dirtyPageSubscriberCount++ == 0) {
+		_dirtyPageTracker.reset(new DirtyPageTracker());
+		UpdateDirtyPageTracking();
 	}
+	return _dirtyPageTracker.get();
 }
 
-void Console::LoadState(uint8_t *buffer, uint32_t bufferSize)
+void Console::UnsubscribeDirtyPageTracking()
 {
-	stringstream stream;
-	stream.write((char*)buffer, bufferSize);
-	stream.seekg(0, ios::beg);
-	LoadState(stream);
+	if(_dirtyPageSubscriberCount > 0 && --_dirtyPageSubscriberCount == 0) {
+		_dirtyPageTracker.reset();
+		UpdateDirtyPageTracking();
+	}
+}
+
+DirtyPageTracker* Console::GetDirtyPageTracker()
+{
+	return _dirtyPageTracker.get();
+}
+
+void Console::UpdateDirtyPageTracking()
+{
+	DirtyPageTracker* tracker = _dirtyPageTracker.get();
+	if(tracker) {
+		tracker->SetMemorySize(DebugMemoryType::InternalRam, MemoryManager::InternalRAMSize);
+	}
+	if(_memoryManager) {
+		_memoryManager->SetDirtyPageTracker(tracker);
+	}
+	if(_mapper) {
+		_mapper->SetDirtyPageTracker(tracker);
+	}
 }
 
 std::shared_ptr<Debugger> Console::GetDebugger(bool autoStart)
@@ -1133,6 +1615,7 @@ std::shared_ptr<Debugger> Console::GetDebugger(bool autoStart)
 		if(!debugger) {
 			debugger.reset(new Debugger(shared_from_this(), _cpu, _ppu, _apu, _memoryManager, _mapper));
 			_debugger = debugger;
+			UpdateCpuFeatures();
 		}
 	}
 	return debugger;
@@ -1144,6 +1627,26 @@ void Console::StopDebugger()
 		_debugger->ReleaseDebugger(_running);
 	}
 	_debugger.reset();
+	UpdateCpuFeatures();
+}
+
+void Console::UpdateCpuFeatures()
+{
+	uint8_t features = CpuFeatures::None;
+	if(_debugger) {
+		features |= CpuFeatures::Debugger;
+	}
+	if(_cheatManager && _cheatManager->HasCodes()) {
+		features |= CpuFeatures::Cheats;
+	}
+
+	if(_cpu) {
+		_cpu->SetFeatures(features);
+	}
+	if(_memoryManager) {
+		//The direct read pages bypass all hooks, they are only used when no features are enabled
+		_memoryManager->UpdateDirectReadPages();
+	}
 }
 
 std::thread::id Console::GetEmulationThreadId()
@@ -1555,7 +2058,7 @@ void Console::DebugProcessVramWriteOperation(uint16_t addr, uint8_t & value)
 #endif
 }
 
-void Console::DisplayDebugInformation(double lastFrame, double &lastFrameMin, double &lastFrameMax, double frameDurations[60])
+void Console::DisplayDebugInformation(double lastFrame, double &lastFrameMin, double &lastFrameMax, double frameDurations[60], double emulationTime)
 {
 	AudioStatistics stats = _soundMixer->GetStatistics();
 	
@@ -1576,8 +2079,17 @@ void Console::DisplayDebugInformation(double lastFrame, double &lastFrameMin, do
 	_debugHud->DrawString(10, 39, "Buffer Size: " + std::to_string(stats.BufferSize / 1024) + "kb", 0xFFFFFF, 0xFF000000, 1, startFrame);
 	_debugHud->DrawString(10, 48, "Rate: " + std::to_string((uint32_t)(_settings->GetSampleRate() * _soundMixer->GetRateAdjustment())) + "Hz", 0xFFFFFF, 0xFF000000, 1, startFrame);
 
-	_debugHud->DrawRectangle(132, 8, 115, 49, 0x40000000, true, 1, startFrame);
-	_debugHud->DrawRectangle(132, 8, 115, 49, 0xFFFFFF, false, 1, startFrame);
+	if(_rewindManager) {
+		RewindStatistics rewindStats = _rewindManager->GetStatistics();
+		_debugHud->DrawRectangle(8, 62, 115, 31, 0x40000000, true, 1, startFrame);
+		_debugHud->DrawRectangle(8, 62, 115, 31, 0xFFFFFF, false, 1, startFrame);
+		_debugHud->DrawString(10, 64, "Rewind Stats", 0xFFFFFF, 0xFF000000, 1, startFrame);
+		_debugHud->DrawString(10, 75, "Memory: " + std::to_string(rewindStats.MemoryUsage / 1024) + "kb", 0xFFFFFF, 0xFF000000, 1, startFrame);
+		_debugHud->DrawString(10, 84, "Per Minute: " + std::to_string(rewindStats.MemoryPerMinute / 1024) + "kb", 0xFFFFFF, 0xFF000000, 1, startFrame);
+	}
+
+	_debugHud->DrawRectangle(132, 8, 115, 67, 0x40000000, true, 1, startFrame);
+	_debugHud->DrawRectangle(132, 8, 115, 67, 0xFFFFFF, false, 1, startFrame);
 	_debugHud->DrawString(134, 10, "Video Stats", 0xFFFFFF, 0xFF000000, 1, startFrame);
 
 	double totalDuration = 0;
@@ -1608,6 +2120,17 @@ void Console::DisplayDebugInformation(double lastFrame, double &lastFrameMin, do
 	ss = std::stringstream();
 	ss << "Max Delay: " << std::fixed << std::setprecision(2) << lastFrameMax << " ms";
 	_debugHud->DrawString(134, 48, ss.str(), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+	//Time spent emulating the frame (including any run-ahead frames), without the frame pacing delay
+	ss = std::stringstream();
+	ss << "Frame Time: " << std::fixed << std::setprecision(2) << emulationTime << " ms";
+	_debugHud->DrawString(134, 57, ss.str(), 0xFFFFFF, 0xFF000000, 1, startFrame);
+
+	string runAheadMode = "Off";
+	if(_settings->GetRunAheadFrames() > 0) {
+		runAheadMode = std::to_string(_settings->GetRunAheadFrames()) + (_runAheadConsole ? " (Shadow)" : " (State)");
+	}
+	_debugHud->DrawString(134, 66, "Run Ahead: " + runAheadMode, 0xFFFFFF, 0xFF000000, 1, startFrame);
 }
 
 void Console::ExportStub()
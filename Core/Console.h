@@ -4,6 +4,7 @@
 #include <atomic>
 #include "../Utilities/SimpleLock.h"
 #include "VirtualFile.h"
+#include "Types.h"
 
 class BaseMapper;
 class RewindManager;
@@ -16,10 +17,12 @@ class ControlManager;
 class AutoSaveManager;
 class HdPackBuilder;
 class HdAudioDevice;
+class DirtyPageTracker;
 class SystemActionManager;
 class Timer;
 class CheatManager;
 class SaveStateManager;
+class MovieManager;
 class VideoDecoder;
 class VideoRenderer;
 class DebugHud;
@@ -42,6 +45,20 @@ enum class EventType;
 enum class DebugEventType : uint8_t;
 enum class RamPowerOnState;
 
+struct HeadlessRunOptions
+{
+	bool DecodeVideo = false;
+	bool ProcessAudio = false;
+	bool SendNotifications = false;
+};
+
+struct HeadlessRunResult
+{
+	uint32_t FrameCount = 0;
+	double ElapsedMs = 0;
+	double Fps = 0;
+};
+
 class Console : public std::enable_shared_from_this<Console>
 {
 private:
@@ -72,6 +89,7 @@ private:
 	shared_ptr<VideoRenderer> _videoRenderer;
 	unique_ptr<AutoSaveManager> _autoSaveManager;
 	shared_ptr<SaveStateManager> _saveStateManager;
+	shared_ptr<MovieManager> _movieManager;
 	shared_ptr<CheatManager> _cheatManager;
 	shared_ptr<DebugHud> _debugHud;
 	shared_ptr<SoundMixer> _soundMixer;
@@ -82,6 +100,9 @@ private:
 	shared_ptr<HdPackData> _hdData;
 	unique_ptr<HdAudioDevice> _hdAudioDevice;
 
+	shared_ptr<DirtyPageTracker> _dirtyPageTracker;
+	uint32_t _dirtyPageSubscriberCount = 0;
+
 	NesModel _model;
 
 	string _romFilepath;
@@ -100,13 +121,47 @@ private:
 	bool _initialized = false;
 	std::thread::id _emulationThreadId;
 
+	bool _headlessRun = false;
+	HeadlessRunOptions _headlessOptions;
+
+	//Used by the shadow console run-ahead mode
+	shared_ptr<Console> _runAheadConsole;
+	bool _isRunAheadConsole = false;
+	bool _runAheadMainFrame = false;
+	vector<uint8_t> _runAheadState;
+	bool _runAheadConsoleFailed = false;
+
+	//The ROM file's content as it was loaded (after patching, extraction from archives, etc.), used to create the shadow console
+	vector<uint8_t> _romFileData;
+
+	//Used by the preemptive run-ahead mode: the shadow console is only rolled back when the input changes
+	static constexpr uint32_t RunAheadMaxPredictedFrames = 60;
+	vector<uint32_t> _runAheadKeys;
+	MousePosition _runAheadMousePosition = {};
+	uint8_t _runAheadMouseButtons = 0;
+	uint32_t _runAheadPredictedFrames = 0;
+	uint32_t _runAheadLastFrameCount = 0;
+	atomic<bool> _runAheadResync { true };
+	uint32_t _runAheadRollbackCount = 0;
+
+	//Size of the last stream-based save state, used to allocate the buffer up front
+	size_t _lastSaveStateSize = 0;
+
 	void RunFrameWithRunAhead(std::stringstream& runAheadState);
+	bool UpdateRunAheadConsole();
+	void ReleaseRunAheadConsole();
+	void RunFrameWithShadowRunAhead();
+	bool UpdateRunAheadPrediction(bool mouseMoved);
 
 	void LoadHdPack(VirtualFile &romFile, VirtualFile &patchFile);
 
 	void UpdateNesModel(bool sendNotification);
+	void ProcessStateLoaded();
+	void UpdateDirtyPageTracking();
+	void LoadFlatState(istream &loadStream, uint32_t stateVersion);
+	size_t LoadFlatState(const uint8_t* buffer, size_t bufferSize, uint32_t stateVersion);
 	double GetFrameDelay();
-	void DisplayDebugInformation(double lastFrame, double &lastFrameMin, double &lastFrameMax, double frameDurations[60]);
+	void DisplayDebugInformation(double lastFrame, double &lastFrameMin, double &lastFrameMax, double frameDurations[60], double emulationTime);
 
 	void ExportStub();
 
@@ -119,6 +174,7 @@ public:
 
 	shared_ptr<BatteryManager> GetBatteryManager();
 	shared_ptr<SaveStateManager> GetSaveStateManager();
+	shared_ptr<MovieManager> GetMovieManager();
 	shared_ptr<VideoDecoder> GetVideoDecoder();
 	shared_ptr<VideoRenderer> GetVideoRenderer();
 	shared_ptr<DebugHud> GetDebugHud();
@@ -161,6 +217,20 @@ public:
 	void RunFrame();
 	bool UpdateHdPackMode();
 
+	//Runs the specified number of frames as fast as possible on the calling thread (no frame pacing, no decoder thread)
+	HeadlessRunResult RunFrames(uint32_t frameCount, HeadlessRunOptions options);
+	bool IsHeadlessRun();
+	bool IsVideoDecodeEnabled();
+	bool IsRunAheadMainFrame();
+	bool IsRunAheadConsole();
+	//Called by the cheat manager - cheats are applied on reads and aren't part of the save state, so the shadow console needs its own copy
+	void UpdateRunAheadCheats();
+	//Must be called when something other than the input changes the emulation's state (memory edits, disk changes, etc.),
+	//the preemptive run-ahead mode can't detect these and would keep displaying frames that no longer match the state
+	void InvalidateRunAhead();
+	uint32_t GetRunAheadRollbackCount();
+	bool IsAudioEnabled();
+
 	shared_ptr<SystemActionManager> GetSystemActionManager();
 
 	template<typename T>
@@ -194,11 +264,28 @@ public:
 
 	shared_ptr<Debugger> GetDebugger(bool autoStart = true);
 	void StopDebugger();
+	void UpdateCpuFeatures();
 
 	void SaveState(ostream &saveStream);
 	void LoadState(istream &loadStream);
 	void LoadState(istream &loadStream, uint32_t stateVersion);
-	void LoadState(uint8_t *buffer, uint32_t bufferSize);
+
+	//Allocation-free versions, the buffer only needs to be allocated once and can be reused.
+	//SaveState returns the exact size of the state, nothing is valid if this is larger than capacity (call with nullptr/0 to get the size)
+	size_t SaveState(uint8_t* buffer, size_t capacity);
+	//Upper bound for the state's size: the current size plus what the state can grow by while the game runs
+	size_t GetMaxSaveStateSize();
+	void LoadState(const uint8_t* buffer, size_t bufferSize);
+	size_t LoadState(const uint8_t* buffer, size_t bufferSize, uint32_t stateVersion);
+
+	//Hash of the data contained in a save state, computed without serializing it (used to detect divergences between runs)
+	uint64_t GetStateHash();
+
+	//Page-granularity dirty bitmaps for RAM/VRAM, only maintained while at least one consumer is subscribed (all consumers share the same tracker)
+	//Must be called from the emulation thread or while paused
+	DirtyPageTracker* SubscribeDirtyPageTracking();
+	void UnsubscribeDirtyPageTracking();
+	DirtyPageTracker* GetDirtyPageTracker();
 
 	VirtualFile GetRomPath();
 	VirtualFile GetPatchFile();
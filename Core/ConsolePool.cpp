@@ -0,0 +1,130 @@
+#include "stdafx.h"
+#include <algorithm>
+#include "ConsolePool.h"
+
+ConsolePool::ConsolePool(uint32_t threadCount)
+{
+	_pendingTasks = 0;
+	_stopFlag = false;
+
+	threadCount = std::max<uint32_t>(1, threadCount);
+	for(uint32_t i = 0; i < threadCount; i++) {
+		_queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+		_startSignals.push_back(unique_ptr<AutoResetEvent>(new AutoResetEvent()));
+	}
+
+	for(uint32_t i = 0; i < threadCount; i++) {
+		_workers.push_back(unique_ptr<std::thread>(new std::thread(&ConsolePool::WorkerLoop, this, i)));
+	}
+}
+
+ConsolePool::~ConsolePool()
+{
+	_stopFlag = true;
+	for(unique_ptr<AutoResetEvent> &signal : _startSignals) {
+		signal->Signal();
+	}
+	for(unique_ptr<std::thread> &worker : _workers) {
+		worker->join();
+	}
+}
+
+void ConsolePool::AddConsole(shared_ptr<Console> console)
+{
+	_consoles.push_back(console);
+}
+
+void ConsolePool::RemoveConsole(shared_ptr<Console> console)
+{
+	_consoles.erase(std::remove(_consoles.begin(), _consoles.end(), console), _consoles.end());
+}
+
+uint32_t ConsolePool::GetConsoleCount()
+{
+	return (uint32_t)_consoles.size();
+}
+
+uint32_t ConsolePool::GetThreadCount()
+{
+	return (uint32_t)_workers.size();
+}
+
+void ConsolePool::RunFrames(uint32_t frameCount, HeadlessRunOptions options)
+{
+	if(frameCount == 0 || _consoles.empty()) {
+		return;
+	}
+
+	_options = options;
+	_pendingTasks = (uint32_t)_consoles.size();
+	_batchDone.Reset();
+
+	//Spread the consoles evenly over the worker queues, workers will steal from each other as needed
+	for(size_t i = 0; i < _consoles.size(); i++) {
+		WorkerQueue* queue = _queues[i % _queues.size()].get();
+		auto lock = queue->Lock.AcquireSafe();
+		queue->Tasks.push_back({ _consoles[i].get(), frameCount });
+	}
+
+	for(unique_ptr<AutoResetEvent> &signal : _startSignals) {
+		signal->Signal();
+	}
+
+	_batchDone.Wait();
+}
+
+bool ConsolePool::GetTask(uint32_t workerIndex, FrameTask &task)
+{
+	{
+		WorkerQueue* queue = _queues[workerIndex].get();
+		auto lock = queue->Lock.AcquireSafe();
+		if(!queue->Tasks.empty()) {
+			task = queue->Tasks.back();
+			queue->Tasks.pop_back();
+			return true;
+		}
+	}
+
+	//Own queue is empty, try to steal the oldest task from another worker
+	for(size_t i = 1; i < _queues.size(); i++) {
+		WorkerQueue* queue = _queues[(workerIndex + i) % _queues.size()].get();
+		auto lock = queue->Lock.AcquireSafe();
+		if(!queue->Tasks.empty()) {
+			task = queue->Tasks.front();
+			queue->Tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ConsolePool::WorkerLoop(uint32_t workerIndex)
+{
+	while(true) {
+		_startSignals[workerIndex]->Wait();
+		if(_stopFlag) {
+			break;
+		}
+
+		while(_pendingTasks > 0) {
+			FrameTask task;
+			if(!GetTask(workerIndex, task)) {
+				//All remaining tasks are currently running on other workers, check again shortly
+				std::this_thread::yield();
+				continue;
+			}
+
+			task.Target->RunFrames(1, _options);
+			task.RemainingFrames--;
+
+			if(task.RemainingFrames > 0) {
+				WorkerQueue* queue = _queues[workerIndex].get();
+				auto lock = queue->Lock.AcquireSafe();
+				queue->Tasks.push_back(task);
+			} else if(--_pendingTasks == 0) {
+				_batchDone.Signal();
+			}
+		}
+	}
+}
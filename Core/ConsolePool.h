@@ -0,0 +1,51 @@
+#pragma once
+#include "stdafx.h"
+#include <thread>
+#include <deque>
+#include "../Utilities/SimpleLock.h"
+#include "../Utilities/AutoResetEvent.h"
+#include "Console.h"
+
+//Runs a set of independent consoles on a fixed number of worker threads.
+//Each task steps a single console by one frame - workers process their own queue (LIFO, for cache locality)
+//and steal from the front of other workers' queues when they run out of work.
+class ConsolePool
+{
+private:
+	struct FrameTask
+	{
+		Console* Target;
+		uint32_t RemainingFrames;
+	};
+
+	struct WorkerQueue
+	{
+		SimpleLock Lock;
+		std::deque<FrameTask> Tasks;
+	};
+
+	vector<shared_ptr<Console>> _consoles;
+	vector<unique_ptr<WorkerQueue>> _queues;
+	vector<unique_ptr<AutoResetEvent>> _startSignals;
+	vector<unique_ptr<std::thread>> _workers;
+
+	AutoResetEvent _batchDone;
+	atomic<uint32_t> _pendingTasks;
+	atomic<bool> _stopFlag;
+	HeadlessRunOptions _options;
+
+	void WorkerLoop(uint32_t workerIndex);
+	bool GetTask(uint32_t workerIndex, FrameTask &task);
+
+public:
+	ConsolePool(uint32_t threadCount);
+	~ConsolePool();
+
+	void AddConsole(shared_ptr<Console> console);
+	void RemoveConsole(shared_ptr<Console> console);
+	uint32_t GetConsoleCount();
+	uint32_t GetThreadCount();
+
+	//Runs frameCount frames on every console in the pool, returns once all consoles are done
+	void RunFrames(uint32_t frameCount, HeadlessRunOptions options);
+};
@@ -162,6 +162,8 @@ void Debugger::ReleaseDebugger(bool needPause)
 		_breakLock.Acquire();
 		_breakLock.Release();
 
+		_memoryAccessCounter->ReleaseDirtyPageTracking();
+
 		if(needPause) {
 			_console->Resume();
 		}
@@ -659,6 +661,7 @@ void Debugger::ProcessPpuCycle()
 		int32_t currentCycle = (_ppu->GetCurrentCycle() << 9) + _ppu->GetCurrentScanline();
 		for(auto updateCycle : _ppuViewerUpdateCycle) {
 			if(updateCycle.second == currentCycle) {
+				_memoryAccessCounter->UpdatePpuPageStamps();
 				_console->GetNotificationManager()->SendNotification(ConsoleNotificationType::PpuViewerDisplayFrame, (void*)(uint64_t)updateCycle.first);
 			}
 		}
@@ -975,6 +978,7 @@ bool Debugger::SleepUntilResume(BreakSource source, uint32_t breakpointId, Break
 				((uint64_t)source & 0xFF)
 			);
 
+			_memoryAccessCounter->UpdatePpuPageStamps();
 			_console->GetNotificationManager()->SendNotification(ConsoleNotificationType::CodeBreak, (void*)(uint64_t)param);
 
 			ProcessEvent(EventType::CodeBreak);
@@ -1059,6 +1063,7 @@ void Debugger::GetState(DebugState *state, bool includeMapperInfo)
 
 void Debugger::SetState(DebugState state)
 {
+	_console->InvalidateRunAhead();
 	_cpu->SetState(state.CPU);
 	_ppu->SetState(state.PPU);
 	if(state.CPU.PC != _cpu->GetPC()) {
@@ -1247,6 +1252,7 @@ int32_t Debugger::GetAbsoluteChrAddress(uint32_t addr)
 
 void Debugger::SetNextStatement(uint16_t addr)
 {
+	_console->InvalidateRunAhead();
 	if(_currentReadAddr) {
 		_cpu->SetDebugPC(addr);
 		*_currentReadAddr = addr;
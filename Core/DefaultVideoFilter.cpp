@@ -6,11 +6,18 @@
 #include "PPU.h"
 #include "DebugHud.h"
 #include "Console.h"
+#include "../Utilities/PlatformUtilities.h"
 
+#ifdef HAS_AVX2_TARGET
+	#include <immintrin.h>
+#endif
 
 DefaultVideoFilter::DefaultVideoFilter(shared_ptr<Console> console) : BaseVideoFilter(console)
 {
 	InitConversionMatrix(_pictureSettings.Hue, _pictureSettings.Saturation);
+#ifdef HAS_AVX2_TARGET
+	_useAvx2 = PlatformUtilities::IsAvx2Supported();
+#endif
 }
 
 void DefaultVideoFilter::InitConversionMatrix(double hueShift, double saturationShift)
@@ -45,18 +52,42 @@ FrameInfo DefaultVideoFilter::GetFrameInfo()
 void DefaultVideoFilter::OnBeforeApplyFilter()
 {
 	PictureSettings currentSettings = _console->GetSettings()->GetPictureSettings();
+	uint32_t* originalPalette = _console->GetSettings()->GetRgbPalette();
+
+	bool pictureChanged = (
+		_pictureSettings.Hue != currentSettings.Hue || _pictureSettings.Saturation != currentSettings.Saturation ||
+		_pictureSettings.Brightness != currentSettings.Brightness || _pictureSettings.Contrast != currentSettings.Contrast
+	);
+
 	if(_pictureSettings.Hue != currentSettings.Hue || _pictureSettings.Saturation != currentSettings.Saturation) {
 		InitConversionMatrix(currentSettings.Hue, currentSettings.Saturation);
 	}
 	_pictureSettings = currentSettings;
+
+	if(!_paletteValid || pictureChanged || memcmp(_sourcePalette, originalPalette, sizeof(_sourcePalette)) != 0) {
+		memcpy(_sourcePalette, originalPalette, sizeof(_sourcePalette));
+		UpdateCalculatedPalette();
+		_paletteValid = true;
+		_scanlineIntensity = -1;
+	}
+
+	int32_t scanlineIntensity = (uint8_t)((1.0 - _pictureSettings.ScanlineIntensity) * 255);
+	if(_scanlineIntensity != scanlineIntensity) {
+		_scanlineIntensity = scanlineIntensity;
+		for(int pal = 0; pal < 512; pal++) {
+			_scanlinePalette[pal] = ApplyScanlineEffect(pal, (uint8_t)scanlineIntensity);
+		}
+	}
+}
+
+void DefaultVideoFilter::UpdateCalculatedPalette()
+{
 	_needToProcess = _pictureSettings.Hue != 0 || _pictureSettings.Saturation != 0 || _pictureSettings.Brightness || _pictureSettings.Contrast;
 
 	if(_needToProcess) {
 		double y, i, q;
-		uint32_t* originalPalette = _console->GetSettings()->GetRgbPalette();
-
 		for(int pal = 0; pal < 512; pal++) {
-			uint32_t pixelOutput = originalPalette[pal];
+			uint32_t pixelOutput = _sourcePalette[pal];
 			double redChannel = ((pixelOutput & 0xFF0000) >> 16) / 255.0;
 			double greenChannel = ((pixelOutput & 0xFF00) >> 8) / 255.0;
 			double blueChannel = (pixelOutput & 0xFF) / 255.0;
@@ -74,7 +105,37 @@ void DefaultVideoFilter::OnBeforeApplyFilter()
 			_calculatedPalette[pal] = 0xFF000000 | (r << 16) | (g << 8) | b;
 		}
 	} else {
-		memcpy(_calculatedPalette, _console->GetSettings()->GetRgbPalette(), sizeof(_calculatedPalette));
+		memcpy(_calculatedPalette, _sourcePalette, sizeof(_calculatedPalette));
+	}
+}
+
+#ifdef HAS_AVX2_TARGET
+AVX2_TARGET static void ConvertRowAvx2(uint16_t *ppuRow, uint32_t *out, uint32_t width, uint32_t *palette)
+{
+	//Looks up 8 pixels at once with a gather (the palette is small enough to stay in the L1 cache)
+	uint32_t j = 0;
+	for(; j + 8 <= width; j += 8) {
+		__m256i indexes = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i*)(ppuRow + j)));
+		_mm256_storeu_si256((__m256i*)(out + j), _mm256_i32gather_epi32((const int*)palette, indexes, 4));
+	}
+	for(; j < width; j++) {
+		out[j] = palette[ppuRow[j]];
+	}
+}
+#endif
+
+void DefaultVideoFilter::ConvertRow(uint16_t *ppuRow, uint32_t *out, uint32_t width, uint32_t *palette)
+{
+	//The PPU's output already includes the emphasis bits (and grayscale), so each pixel is a single lookup in the 512-color palette
+#ifdef HAS_AVX2_TARGET
+	if(_useAvx2) {
+		ConvertRowAvx2(ppuRow, out, width, palette);
+		return;
+	}
+#endif
+
+	for(uint32_t j = 0; j < width; j++) {
+		out[j] = palette[ppuRow[j]];
 	}
 }
 
@@ -82,19 +143,11 @@ void DefaultVideoFilter::DecodePpuBuffer(uint16_t *ppuOutputBuffer, uint32_t* ou
 {
 	uint32_t* out = outputBuffer;
 	OverscanDimensions overscan = GetOverscan();
-	uint8_t scanlineIntensity = (uint8_t)((1.0 - _console->GetSettings()->GetPictureSettings().ScanlineIntensity) * 255);
+	uint32_t width = 256 - overscan.Left - overscan.Right;
 	for(uint32_t i = overscan.Top, iMax = 240 - overscan.Bottom; i < iMax; i++) {
-		if(displayScanlines && (i + overscan.Top) % 2 == 0) {
-			for(uint32_t j = overscan.Left, jMax = 256 - overscan.Right; j < jMax; j++) {
-				*out = ApplyScanlineEffect(ppuOutputBuffer[i * 256 + j], scanlineIntensity);
-				out++;
-			}
-		} else {
-			for(uint32_t j = overscan.Left, jMax = 256 - overscan.Right; j < jMax; j++) {
-				*out = _calculatedPalette[ppuOutputBuffer[i * 256 + j]];
-				out++;
-			}
-		}
+		bool scanline = displayScanlines && (i + overscan.Top) % 2 == 0;
+		ConvertRow(ppuOutputBuffer + i * 256 + overscan.Left, out, width, scanline ? _scanlinePalette : _calculatedPalette);
+		out += width;
 	}
 }
 
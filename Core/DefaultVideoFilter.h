@@ -11,7 +11,16 @@ private:
 	PictureSettings _pictureSettings;
 	bool _needToProcess = false;
 
+	//The palettes are only recalculated when the source palette or the picture settings change
+	uint32_t _sourcePalette[512];
+	uint32_t _scanlinePalette[512];
+	bool _paletteValid = false;
+	int32_t _scanlineIntensity = -1;
+	bool _useAvx2 = false;
+
 	void InitConversionMatrix(double hueShift, double saturationShift);
+	void UpdateCalculatedPalette();
+	void ConvertRow(uint16_t *ppuRow, uint32_t *out, uint32_t width, uint32_t *palette);
 
 	void RgbToYiq(double r, double g, double b, double &y, double &i, double &q);
 	void YiqToRgb(double y, double i, double q, double &r, double &g, double &b);
@@ -137,6 +137,17 @@ bool DeltaModulationChannel::IrqPending(uint32_t cyclesToRun)
 	return false;
 }
 
+uint32_t DeltaModulationChannel::GetCyclesUntilRun()
+{
+	//Returns the smallest cyclesToRun value for which NeedToRun() or IrqPending() can return true
+	if(_needToRun || _needInit) {
+		return 0;
+	} else if(_irqEnabled && _bytesRemaining > 0) {
+		return (_bitsRemaining + (_bytesRemaining-1)* 8) * _period;
+	}
+	return UINT32_MAX;
+}
+
 bool DeltaModulationChannel::GetStatus()
 {
 	return _bytesRemaining > 0;
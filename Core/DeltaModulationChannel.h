@@ -42,6 +42,7 @@ public:
 
 	bool IrqPending(uint32_t cyclesToRun);
 	bool NeedToRun();
+	uint32_t GetCyclesUntilRun();
 	bool GetStatus() override;
 	void GetMemoryRanges(MemoryRanges &ranges) override;
 	void WriteRAM(uint16_t addr, uint8_t value) override;
@@ -0,0 +1,74 @@
+#include "stdafx.h"
+#include <algorithm>
+#include "DirtyPageTracker.h"
+
+void DirtyPageTracker::SetMemorySize(DebugMemoryType type, uint32_t size)
+{
+	uint32_t pageCount = (size + DirtyPageTracker::PageSize - 1) >> DirtyPageTracker::PageShift;
+	_pageCount[(int)type] = pageCount;
+
+	//Memory that was just (re)allocated is considered dirty
+	_bitmaps[(int)type].assign((pageCount + 63) / 64, 0);
+	for(uint32_t page = 0; page < pageCount; page++) {
+		MarkDirty(type, page << DirtyPageTracker::PageShift);
+	}
+}
+
+void DirtyPageTracker::MarkAllDirty()
+{
+	for(int i = 0; i < MemoryTypeCount; i++) {
+		for(uint32_t page = 0; page < _pageCount[i]; page++) {
+			MarkDirty((DebugMemoryType)i, page << DirtyPageTracker::PageShift);
+		}
+	}
+}
+
+uint32_t DirtyPageTracker::GetPageCount(DebugMemoryType type)
+{
+	return _pageCount[(int)type];
+}
+
+bool DirtyPageTracker::IsPageDirty(DebugMemoryType type, uint32_t page)
+{
+	if(page < _pageCount[(int)type]) {
+		return (_bitmaps[(int)type][page >> 6] & ((uint64_t)1 << (page & 0x3F))) != 0;
+	}
+	return false;
+}
+
+bool DirtyPageTracker::HasDirtyPages(DebugMemoryType type)
+{
+	for(uint64_t bits : _bitmaps[(int)type]) {
+		if(bits) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void DirtyPageTracker::GetDirtyPages(DebugMemoryType type, vector<uint32_t> &pages)
+{
+	pages.clear();
+	vector<uint64_t> &bitmap = _bitmaps[(int)type];
+	for(size_t i = 0; i < bitmap.size(); i++) {
+		for(uint64_t bits = bitmap[i]; bits; bits &= bits - 1) {
+			uint32_t bit = 0;
+			while(!(bits & ((uint64_t)1 << bit))) {
+				bit++;
+			}
+			pages.push_back((uint32_t)(i * 64 + bit));
+		}
+	}
+}
+
+void DirtyPageTracker::Reset(DebugMemoryType type)
+{
+	std::fill(_bitmaps[(int)type].begin(), _bitmaps[(int)type].end(), 0);
+}
+
+void DirtyPageTracker::Reset()
+{
+	for(int i = 0; i < MemoryTypeCount; i++) {
+		Reset((DebugMemoryType)i);
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "stdafx.h"
+#include "DebuggerTypes.h"
+
+//Page-granularity (256 bytes) dirty bitmaps for the console's writable memory (internal RAM, work/save RAM, CHR RAM and nametable RAM)
+//Pages are flagged by the CPU writes to RAM that go through MemoryManager/BaseMapper, by the PPU's VRAM writes, by the debugger's
+//memory writes and all pages are flagged on power cycles and state loads - a page can be flagged without its content changing.
+//Memory that a mapper modifies on its own is NOT tracked: e.g. MMC5's ExRAM/fill mode, CHR/work RAM written by a mapper's register
+//handlers, battery loads. A clean page means "not written to by the CPU/PPU buses", not "unchanged".
+//Must only be used from the emulation thread (or while emulation is paused).
+class DirtyPageTracker
+{
+public:
+	static constexpr uint32_t PageShift = 8;
+	static constexpr uint32_t PageSize = 1 << PageShift;
+
+private:
+	static constexpr int MemoryTypeCount = (int)DebugMemoryType::NametableRam + 1;
+
+	vector<uint64_t> _bitmaps[MemoryTypeCount];
+	uint32_t _pageCount[MemoryTypeCount] = {};
+
+public:
+	void SetMemorySize(DebugMemoryType type, uint32_t size);
+
+	void MarkDirty(DebugMemoryType type, uint32_t address)
+	{
+		uint32_t page = address >> DirtyPageTracker::PageShift;
+		if(page < _pageCount[(int)type]) {
+			_bitmaps[(int)type][page >> 6] |= (uint64_t)1 << (page & 0x3F);
+		}
+	}
+
+	void MarkAllDirty();
+
+	uint32_t GetPageCount(DebugMemoryType type);
+	bool IsPageDirty(DebugMemoryType type, uint32_t page);
+	bool HasDirtyPages(DebugMemoryType type);
+
+	//Returns the dirty pages' indexes, in ascending order
+	void GetDirtyPages(DebugMemoryType type, vector<uint32_t> &pages);
+
+	void Reset(DebugMemoryType type);
+	void Reset();
+};
@@ -22,6 +22,7 @@ enum EmulationFlags : uint64_t
 	DisableDynamicSampleRate = 0x80,
 
 	PauseOnMovieEnd = 0x0100,
+	RewindDeltaCompression = 0x0200,
 
 	AllowBackgroundInput = 0x0400,
 	ReduceSoundInBackground = 0x0800,
@@ -98,6 +99,9 @@ enum EmulationFlags : uint64_t
 	
 	RandomizeCpuPpuAlignment = 0x800000000000000,
 	
+	PpuCatchUpSync = 0x1000000000000000,
+	RunAheadShadowConsole = 0x2000000000000000,
+
 	ForceMaxSpeed = 0x4000000000000000,	
 	ConsoleMode = 0x8000000000000000,
 };
@@ -656,6 +660,7 @@ private:
 	AudioFilterSettings _audioFilterSettings;
 
 	uint32_t _runAheadFrames = 0;
+	bool _runAheadPreemptive = false;
 	bool _isRunAheadFrame = false;
 
 	NesModel _model = NesModel::Auto;
@@ -666,6 +671,9 @@ private:
 	uint32_t _rewindSpeed = 100;
 
 	uint32_t _rewindBufferSize = 300;
+	uint32_t _rewindMemoryLimit = 0;
+	bool _rewindRawVideo = false;
+	bool _historyViewerPreDecode = false;
 
 	bool _disableOverclocking = false;
 	uint32_t _extraScanlinesBeforeNmi = 0;
@@ -673,6 +681,7 @@ private:
 
 	OverscanDimensions _overscan;
 	VideoFilterType _videoFilterType = VideoFilterType::None;
+	uint32_t _videoFilterThreadCount = 0;
 	double _videoScale = 1;
 	VideoAspectRatio _aspectRatio = VideoAspectRatio::NoStretching;
 	double _customAspectRatio = 1.0;
@@ -1005,6 +1014,16 @@ public:
 		return _runAheadFrames;
 	}
 
+	void SetRunAheadPreemptive(bool enabled)
+	{
+		_runAheadPreemptive = enabled;
+	}
+
+	bool IsRunAheadPreemptive()
+	{
+		return _runAheadPreemptive;
+	}
+
 	void SetRunAheadFrameFlag(bool disabled)
 	{
 		_isRunAheadFrame = disabled;
@@ -1075,6 +1094,37 @@ public:
 		return _rewindBufferSize;
 	}
 
+	void SetRewindMemoryLimit(uint32_t megabytes)
+	{
+		_rewindMemoryLimit = megabytes;
+	}
+
+	uint64_t GetRewindMemoryLimit()
+	{
+		//In bytes, 0 = no limit
+		return (uint64_t)_rewindMemoryLimit * 1024 * 1024;
+	}
+
+	void SetRewindRawVideo(bool enabled)
+	{
+		_rewindRawVideo = enabled;
+	}
+
+	bool IsRewindRawVideoEnabled()
+	{
+		return _rewindRawVideo;
+	}
+
+	void SetHistoryViewerPreDecode(bool enabled)
+	{
+		_historyViewerPreDecode = enabled;
+	}
+
+	bool IsHistoryViewerPreDecodeEnabled()
+	{
+		return _historyViewerPreDecode;
+	}
+
 	uint32_t GetEmulationSpeed(bool ignoreTurbo = false);
 	
 	void DisableOverclocking(bool disabled)
@@ -1156,6 +1206,17 @@ public:
 		return _videoFilterType;
 	}
 
+	//Number of threads used by the video filters (0 = automatic)
+	void SetVideoFilterThreadCount(uint32_t threadCount)
+	{
+		_videoFilterThreadCount = threadCount;
+	}
+
+	uint32_t GetVideoFilterThreadCount()
+	{
+		return _videoFilterThreadCount;
+	}
+
 	void SetVideoResizeFilter(VideoResizeFilter videoResizeFilter)
 	{
 		_resizeFilter = videoResizeFilter;
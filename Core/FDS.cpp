@@ -529,6 +529,20 @@ uint32_t FDS::GetSideCount()
 	return (uint32_t)_fdsDiskSides.size();
 }
 
+uint32_t FDS::GetMaxStateSizeGrowth()
+{
+	//The disk sides are saved as IPS patches against the original disk, a patch can't be larger than 3 bytes per byte of
+	//disk data (a 6-byte record for every other byte, rounded up) plus its header and footer.
+	//The current patches are subtracted, so that the state's size plus this value stays the same as the disk is written to
+	uint32_t growth = 0;
+	for(size_t i = 0; i < _fdsDiskSides.size(); i++) {
+		uint32_t maxPatchSize = (uint32_t)_orgDiskSides[i].size() * 3 + 16;
+		uint32_t patchSize = (uint32_t)IpsPatcher::CreatePatch(_orgDiskSides[i], _fdsDiskSides[i]).size();
+		growth += maxPatchSize > patchSize ? maxPatchSize - patchSize : 0;
+	}
+	return growth;
+}
+
 void FDS::EjectDisk()
 {
 	_diskNumber = FDS::NoDiskInserted;
@@ -553,5 +567,5 @@ bool FDS::IsDiskInserted()
 
 bool FDS::IsAutoInsertDiskEnabled()
 {
-	return !_disableAutoInsertDisk && _settings->CheckFlag(EmulationFlags::FdsAutoInsertDisk) && !MovieManager::Playing() && !MovieManager::Recording();
+	return !_disableAutoInsertDisk && _settings->CheckFlag(EmulationFlags::FdsAutoInsertDisk) && !_console->GetMovieManager()->Playing() && !_console->GetMovieManager()->Recording();
 }
\ No newline at end of file
@@ -109,6 +109,9 @@ protected:
 
 	void StreamState(bool saving) override;
 
+	//ReadRAM is used to detect when the BIOS checks for a specific disk
+	bool AllowDirectPrgReads() override { return false; }
+
 public:
 	~FDS();
 
@@ -116,6 +119,7 @@ public:
 	ConsoleFeatures GetAvailableFeatures() override;
 
 	uint32_t GetSideCount();
+	uint32_t GetMaxStateSizeGrowth() override;
 
 	void EjectDisk();
 	void InsertDisk(uint32_t diskNumber);
@@ -79,12 +79,14 @@ public:
 	void EjectDisk()
 	{
 		_needEjectDisk = true;
+		_console->InvalidateRunAhead();
 	}
 
 	void InsertDisk(uint8_t diskNumber)
 	{
 		shared_ptr<FDS> mapper = _mapper.lock();
 		if(mapper) {
+			_console->InvalidateRunAhead();
 			if(mapper->IsDiskInserted()) {
 				//Eject disk on next frame, then insert new disk 2 seconds later
 				_needEjectDisk = true;
@@ -128,17 +128,19 @@ HdPpu::HdPpu(shared_ptr<Console> console, HdPackData * hdData) : PPU(console)
 		_version = _hdData->Version;
 
 		bool isChrRamGame = !console->GetMapper()->HasChrRom();
-		_screenInfo[0] = new HdScreenInfo(isChrRamGame);
-		_screenInfo[1] = new HdScreenInfo(isChrRamGame);
-		_info = _screenInfo[0];
+		for(int i = 0; i < 3; i++) {
+			_screenInfo[i] = new HdScreenInfo(isChrRamGame);
+		}
+		_info = _screenInfo[console->GetVideoDecoder()->GetFrameSlotIndex()];
 	}
 }
 
 HdPpu::~HdPpu()
 {
 	if(_hdData) {
-		delete _screenInfo[0];
-		delete _screenInfo[1];
+		for(int i = 0; i < 3; i++) {
+			delete _screenInfo[i];
+		}
 	}
 }
 
@@ -163,12 +165,17 @@ void HdPpu::SendFrame()
 #ifdef  LIBRETRO
 	_console->GetVideoDecoder()->UpdateFrameSync(_currentOutputBuffer, _info);
 #else
-	if(_console->GetRewindManager()->IsRewinding()) {
+	if(_console->IsHeadlessRun()) {
+		if(_console->IsVideoDecodeEnabled()) {
+			_console->GetVideoDecoder()->UpdateFrameSync(_currentOutputBuffer, _info);
+		}
+	} else if(_console->GetRewindManager()->IsRewinding()) {
 		_console->GetVideoDecoder()->UpdateFrameSync(_currentOutputBuffer, _info);
 	} else {
 		_console->GetVideoDecoder()->UpdateFrame(_currentOutputBuffer, _info);
 	}
-	_currentOutputBuffer = (_currentOutputBuffer == _outputBuffers[0]) ? _outputBuffers[1] : _outputBuffers[0];
-	_info = (_info == _screenInfo[0]) ? _screenInfo[1] : _screenInfo[0];
+
+	//The screen info of the frames that are waiting to be decoded (or being decoded) must not be modified
+	_info = _screenInfo[_console->GetVideoDecoder()->GetFrameSlotIndex()];
 #endif
 }
@@ -10,7 +10,8 @@ class Console;
 class HdPpu : public PPU
 {
 private:
-	HdScreenInfo *_screenInfo[2];
+	//One screen info for each of VideoDecoder's frame slots (it is too large to be copied on each frame like the PPU's output)
+	HdScreenInfo *_screenInfo[3];
 	HdScreenInfo *_info;
 	uint32_t _version;
 
@@ -1,4 +1,5 @@
 #include "stdafx.h"
+#include <algorithm>
 #include "HistoryViewer.h"
 #include "RewindData.h"
 #include "Console.h"
@@ -14,16 +15,42 @@ HistoryViewer::HistoryViewer(shared_ptr<Console> console)
 	_console = console;
 	_position = 0;
 	_pollCounter = 0;
+	_stopDecode = false;
 }
 
 HistoryViewer::~HistoryViewer()
 {
+	StopDecodeThreads();
 }
 
 void HistoryViewer::SetHistoryData(std::deque<RewindData> &history)
 {
+	//The decode threads read from the history, stop them before replacing it
+	StopDecodeThreads();
+
 	_history = history;
 
+	_blockStart.clear();
+	_blockStart.reserve(_history.size() + 1);
+	uint32_t frame = 0;
+	for(RewindData &data : _history) {
+		_blockStart.push_back(frame);
+		frame += data.FrameCount;
+	}
+	_blockStart.push_back(frame);
+
+	if(_console->GetSettings()->IsHistoryViewerPreDecodeEnabled()) {
+		uint32_t cores = std::thread::hardware_concurrency();
+		uint32_t threadCount = cores > 1 ? std::min(cores - 1, HistoryViewer::MaxDecodeThreads) : 1;
+		_stopDecode = false;
+		for(uint32_t i = 0; i < threadCount; i++) {
+			_decodeSignals.push_back(unique_ptr<AutoResetEvent>(new AutoResetEvent()));
+		}
+		for(uint32_t i = 0; i < threadCount; i++) {
+			_decodeThreads.push_back(unique_ptr<std::thread>(new std::thread(&HistoryViewer::DecodeThread, this, i)));
+		}
+	}
+
 	_console->GetControlManager()->UnregisterInputProvider(this);
 	_console->GetControlManager()->RegisterInputProvider(this);
 	
@@ -33,7 +60,128 @@ void HistoryViewer::SetHistoryData(std::deque<RewindData> &history)
 uint32_t HistoryViewer::GetHistoryLength()
 {
 	//Returns history length in number of frames
-	return (uint32_t)(_history.size() * HistoryViewer::BufferSize);
+	return _blockStart.empty() ? 0 : _blockStart.back();
+}
+
+uint32_t HistoryViewer::GetBlockIndex(uint32_t position)
+{
+	//Returns the index of the block that contains the specified position, or the history's size if the position is past the end
+	uint32_t frame = position * HistoryViewer::BufferSize;
+	if(_blockStart.empty() || frame >= _blockStart.back()) {
+		return (uint32_t)_history.size();
+	}
+	auto result = std::upper_bound(_blockStart.begin(), _blockStart.end() - 1, frame);
+	return (uint32_t)(result - _blockStart.begin()) - 1;
+}
+
+uint32_t HistoryViewer::GetBlockPosition(uint32_t blockIndex)
+{
+	//Returns the position at which the specified block starts
+	if(_blockStart.empty()) {
+		return 0;
+	}
+	return _blockStart[std::min<size_t>(blockIndex, _blockStart.size() - 1)] / HistoryViewer::BufferSize;
+}
+
+void HistoryViewer::LoadBlockState(uint32_t blockIndex)
+{
+	shared_ptr<vector<uint8_t>> state;
+	{
+		auto lock = _decodeLock.AcquireSafe();
+		auto result = _decodedStates.find(blockIndex);
+		if(result != _decodedStates.end()) {
+			state = result->second;
+		}
+	}
+
+	if(state) {
+		_console->LoadState(state->data(), state->size());
+	} else {
+		_history[blockIndex].LoadState(_console);
+	}
+
+	QueuePreDecode(blockIndex);
+}
+
+void HistoryViewer::QueuePreDecode(uint32_t blockIndex)
+{
+	if(_decodeThreads.empty()) {
+		return;
+	}
+
+	auto lock = _decodeLock.AcquireSafe();
+
+	//Drop the states that are far from the new position to keep memory usage bounded
+	for(auto it = _decodedStates.begin(); it != _decodedStates.end();) {
+		uint32_t distance = it->first > blockIndex ? it->first - blockIndex : blockIndex - it->first;
+		if(distance > HistoryViewer::PreDecodeRange * 2) {
+			it = _decodedStates.erase(it);
+		} else {
+			it++;
+		}
+	}
+
+	//Decode the closest blocks first, alternating between the blocks after and before the position
+	_decodeQueue.clear();
+	for(uint32_t i = 0; i <= HistoryViewer::PreDecodeRange; i++) {
+		if(blockIndex + i < _history.size() && _decodedStates.find(blockIndex + i) == _decodedStates.end()) {
+			_decodeQueue.push_back(blockIndex + i);
+		}
+		if(i > 0 && i <= blockIndex && _decodedStates.find(blockIndex - i) == _decodedStates.end()) {
+			_decodeQueue.push_back(blockIndex - i);
+		}
+	}
+
+	for(unique_ptr<AutoResetEvent> &signal : _decodeSignals) {
+		signal->Signal();
+	}
+}
+
+bool HistoryViewer::GetDecodeTask(uint32_t &blockIndex)
+{
+	auto lock = _decodeLock.AcquireSafe();
+	if(_decodeQueue.empty()) {
+		return false;
+	}
+
+	blockIndex = _decodeQueue.front();
+	_decodeQueue.pop_front();
+	_decodedStates[blockIndex] = nullptr;
+	return true;
+}
+
+void HistoryViewer::DecodeThread(uint32_t threadIndex)
+{
+	while(true) {
+		_decodeSignals[threadIndex]->Wait();
+		if(_stopDecode) {
+			break;
+		}
+
+		uint32_t blockIndex;
+		while(!_stopDecode && GetDecodeTask(blockIndex)) {
+			shared_ptr<vector<uint8_t>> state(new vector<uint8_t>());
+			if(_history[blockIndex].GetStateData(*state)) {
+				auto lock = _decodeLock.AcquireSafe();
+				_decodedStates[blockIndex] = state;
+			}
+		}
+	}
+}
+
+void HistoryViewer::StopDecodeThreads()
+{
+	_stopDecode = true;
+	for(unique_ptr<AutoResetEvent> &signal : _decodeSignals) {
+		signal->Signal();
+	}
+	for(unique_ptr<std::thread> &thread : _decodeThreads) {
+		thread->join();
+	}
+	_decodeThreads.clear();
+	_decodeSignals.clear();
+	_decodeQueue.clear();
+	_decodedStates.clear();
 }
 
 void HistoryViewer::GetHistorySegments(uint32_t *segmentBuffer, uint32_t &bufferSize)
@@ -41,7 +189,7 @@ void HistoryViewer::GetHistorySegments(uint32_t *segmentBuffer, uint32_t &buffer
 	uint32_t segmentIndex = 0;
 	for(size_t i = 0; i < _history.size(); i++) {
 		if(_history[i].EndOfSegment) {
-			segmentBuffer[segmentIndex] = (uint32_t)i;
+			segmentBuffer[segmentIndex] = GetBlockPosition((uint32_t)i);
 			segmentIndex++;
 
 			if(segmentIndex == bufferSize) {
@@ -55,20 +203,20 @@ void HistoryViewer::GetHistorySegments(uint32_t *segmentBuffer, uint32_t &buffer
 
 uint32_t HistoryViewer::GetPosition()
 {
-	return _position;
+	return GetBlockPosition(_position) + _pollCounter / HistoryViewer::BufferSize;
 }
 
 void HistoryViewer::SeekTo(uint32_t seekPosition)
 {
-	//Seek to the specified position
-	if(seekPosition < _history.size()) {
+	//Seek to the start of the block that contains the specified position
+	uint32_t blockIndex = GetBlockIndex(seekPosition);
+	if(blockIndex < _history.size()) {
 		_console->Pause();
 		
 		bool wasPaused = _console->GetSettings()->CheckFlag(EmulationFlags::Paused);
 		_console->GetSettings()->ClearFlags(EmulationFlags::Paused);
-		_position = seekPosition;
-		RewindData rewindData = _history[_position];
-		rewindData.LoadState(_console);
+		_position = blockIndex;
+		LoadBlockState(_position);
 
 		_console->GetSoundMixer()->StopAudio(true);
 		_pollCounter = 0;
@@ -83,10 +231,11 @@ void HistoryViewer::SeekTo(uint32_t seekPosition)
 
 bool HistoryViewer::CreateSaveState(string outputFile, uint32_t position)
 {
-	if(position < _history.size()) {
+	uint32_t blockIndex = GetBlockIndex(position);
+	if(blockIndex < _history.size()) {
 		std::stringstream stateData;
 		_console->GetSaveStateManager()->GetSaveStateHeader(stateData);
-		_history[position].GetStateData(stateData);
+		_history[blockIndex].GetStateData(stateData);
 
 		ofstream output(outputFile, ios::binary);
 		if(output) {
@@ -108,7 +257,7 @@ bool HistoryViewer::SaveMovie(string movieFile, uint32_t startPosition, uint32_t
 
 	//Convert the rewind data to a .mmo file
 	unique_ptr<MovieRecorder> recorder(new MovieRecorder(_console));
-	bool result = recorder->CreateMovie(movieFile, _history, startPosition, endPosition);
+	bool result = recorder->CreateMovie(movieFile, _history, GetBlockIndex(startPosition), GetBlockIndex(endPosition));
 
 	//Resume the state and resume
 	_console->LoadState(state);
@@ -123,8 +272,9 @@ void HistoryViewer::ResumeGameplay(shared_ptr<Console> console, uint32_t resumeP
 		//Load game on the main window if they aren't the same
 		console->Initialize(_console->GetRomPath(), _console->GetPatchFile());
 	}
-	if(resumePosition < _history.size()) {
-		_history[resumePosition].LoadState(console);
+	uint32_t blockIndex = GetBlockIndex(resumePosition);
+	if(blockIndex < _history.size()) {
+		_history[blockIndex].LoadState(console);
 	} else {
 		_history[_history.size() - 1].LoadState(console);
 	}
@@ -141,7 +291,7 @@ bool HistoryViewer::SetInput(BaseControlDevice *device)
 			device->SetRawState(state);
 		}
 	}
-	if(port == 0 && _pollCounter < 30) {
+	if(port == 0 && _position < _history.size() && _pollCounter < (uint32_t)_history[_position].FrameCount) {
 		_pollCounter++;
 	}
 	return true;
@@ -149,7 +299,7 @@ bool HistoryViewer::SetInput(BaseControlDevice *device)
 
 void HistoryViewer::ProcessEndOfFrame()
 {
-	if(_pollCounter == HistoryViewer::BufferSize) {
+	if(_position < _history.size() && _pollCounter >= (uint32_t)_history[_position].FrameCount) {
 		_pollCounter = 0;
 		_position++;
 
@@ -159,7 +309,6 @@ void HistoryViewer::ProcessEndOfFrame()
 			return;
 		}
 
-		RewindData rewindData = _history[_position];
-		rewindData.LoadState(_console);
+		LoadBlockState(_position);
 	}
 }
@@ -1,6 +1,10 @@
 #pragma once
 #include "stdafx.h"
 #include <deque>
+#include <thread>
+#include <unordered_map>
+#include "../Utilities/SimpleLock.h"
+#include "../Utilities/AutoResetEvent.h"
 #include "IInputProvider.h"
 #include "RewindData.h"
 
@@ -9,19 +13,41 @@ class Console;
 class HistoryViewer : public IInputProvider
 {
 private:
-	static constexpr int32_t BufferSize = 30; //Number of frames between each save state
+	static constexpr int32_t BufferSize = 30; //Number of frames per position (blocks that were thinned out by the rewinder span several positions)
+	static constexpr uint32_t PreDecodeRange = 8; //Number of blocks decoded ahead of time on each side of the seek position
+	static constexpr uint32_t MaxDecodeThreads = 4;
 
 	shared_ptr<Console> _console;
 	std::deque<RewindData> _history;
 	uint32_t _position;
 	uint32_t _pollCounter;
 
+	//Frame at which each block starts (plus the history's length as the last entry), used to map positions to blocks
+	vector<uint32_t> _blockStart;
+
+	//States decoded ahead of time by the worker threads (a null state is still being decoded)
+	SimpleLock _decodeLock;
+	std::unordered_map<uint32_t, shared_ptr<vector<uint8_t>>> _decodedStates;
+	std::deque<uint32_t> _decodeQueue;
+	vector<unique_ptr<AutoResetEvent>> _decodeSignals;
+	vector<unique_ptr<std::thread>> _decodeThreads;
+	atomic<bool> _stopDecode;
+
+	uint32_t GetBlockIndex(uint32_t position);
+	uint32_t GetBlockPosition(uint32_t blockIndex);
+
+	void LoadBlockState(uint32_t blockIndex);
+	void QueuePreDecode(uint32_t blockIndex);
+	bool GetDecodeTask(uint32_t &blockIndex);
+	void DecodeThread(uint32_t threadIndex);
+	void StopDecodeThreads();
+
 public:
 	HistoryViewer(shared_ptr<Console> console);
 	virtual ~HistoryViewer();
 
 	void SetHistoryData(std::deque<RewindData> &history);
-	
+
 	uint32_t GetHistoryLength();
 	void GetHistorySegments(uint32_t * segmentBuffer, uint32_t &bufferSize);
 	uint32_t GetPosition();
@@ -31,9 +57,9 @@ public:
 	bool SaveMovie(string movieFile, uint32_t startPosition, uint32_t endPosition);
 
 	void ResumeGameplay(shared_ptr<Console> console, uint32_t resumePosition);
-	
+
 	void ProcessEndOfFrame();
 
 	// Inherited via IInputProvider
 	bool SetInput(BaseControlDevice * device) override;
-};
\ No newline at end of file
+};
@@ -36,6 +36,8 @@ protected:
 				_irqEnabled = false;
 				_console->GetCpu()->SetIrqSource(IRQSource::External);
 			}
+		} else {
+			SuspendCpuClock();
 		}
 	}
 
@@ -76,6 +76,9 @@ class JalecoSs88006 : public BaseMapper
 		{
 			//Clock irq counter every memory read/write (each cpu cycle either reads or writes memory)
 			ClockIrqCounter();
+			if(!_irqEnabled) {
+				SuspendCpuClock();
+			}
 		}
 
 		void ReloadIrqCounter()
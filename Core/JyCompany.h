@@ -345,6 +345,11 @@ protected:
 		if(_irqSource == JyIrqSource::CpuClock || (_irqSource == JyIrqSource::CpuWrite && _console->GetCpu()->IsCpuWrite())) {
 			TickIrqCounter();
 		}
+
+		if((_irqSource != JyIrqSource::CpuClock && _irqSource != JyIrqSource::CpuWrite) || _irqCountDirection == 0 || _irqCountDirection == 3) {
+			//The counter is clocked by the PPU or is not counting
+			SuspendCpuClock();
+		}
 	}
 
 	uint8_t MapperReadVRAM(uint16_t addr, MemoryOperationType type) override
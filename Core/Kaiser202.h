@@ -43,6 +43,8 @@ protected:
 				_irqCounter = _irqReloadValue;
 				_console->GetCpu()->SetIrqSource(IRQSource::External);
 			}
+		} else {
+			SuspendCpuClock();
 		}
 	}
 
@@ -9,6 +9,7 @@ IKeyManager* KeyManager::_keyManager = nullptr;
 MousePosition KeyManager::_mousePosition = { 0, 0 };
 atomic<int16_t> KeyManager::_xMouseMovement;
 atomic<int16_t> KeyManager::_yMouseMovement;
+bool KeyManager::_mouseMovementPolled = false;
 EmulationSettings* KeyManager::_settings = nullptr;
 
 void KeyManager::RegisterKeyManager(IKeyManager* keyManager)
@@ -92,9 +93,22 @@ MouseMovement KeyManager::GetMouseMovement(double mouseSensitivity)
 	_xMouseMovement -= (int16_t)(mov.dx * factor);
 	_yMouseMovement -= (int16_t)(mov.dy * factor);
 
+	if(mov.dx != 0 || mov.dy != 0) {
+		_mouseMovementPolled = true;
+	}
 	return mov;
 }
 
+bool KeyManager::HasPolledMouseMovement()
+{
+	return _mouseMovementPolled;
+}
+
+void KeyManager::ResetPolledMouseMovement()
+{
+	_mouseMovementPolled = false;
+}
+
 void KeyManager::SetMousePosition(double x, double y)
 {
 	if(x < 0 || y < 0) {
@@ -13,6 +13,7 @@ private:
 	static MousePosition _mousePosition;
 	static atomic<int16_t> _xMouseMovement;
 	static atomic<int16_t> _yMouseMovement;
+	static bool _mouseMovementPolled;
 	static EmulationSettings* _settings;
 
 public:
@@ -30,6 +31,10 @@ public:
 	
 	static void SetMouseMovement(int16_t x, int16_t y);
 	static MouseMovement GetMouseMovement(double mouseSensitivity);
+
+	//Tracks whether any device received a non-zero mouse movement since the last reset (used by the preemptive run-ahead mode)
+	static bool HasPolledMouseMovement();
+	static void ResetPolledMouseMovement();
 	
 	static void SetMousePosition(double x, double y);
 	static MousePosition GetMousePosition();
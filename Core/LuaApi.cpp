@@ -96,6 +96,7 @@ int LuaApi::GetLibrary(lua_State *lua)
 		{ "loadSavestateAsync", LuaApi::LoadSavestateAsync },
 		{ "getSavestateData", LuaApi::GetSavestateData },
 		{ "clearSavestateData", LuaApi::ClearSavestateData },
+		{ "getStateHash", LuaApi::GetStateHash },
 		{ "isKeyPressed", LuaApi::IsKeyPressed },
 		{ "getInput", LuaApi::GetInput },
 		{ "setInput", LuaApi::SetInput },
@@ -659,6 +660,14 @@ int LuaApi::ClearSavestateData(lua_State *lua)
 	return l.ReturnCount();
 }
 
+int LuaApi::GetStateHash(lua_State *lua)
+{
+	LuaCallHelper l(lua);
+	checkparams();
+	l.Return(_console->GetStateHash());
+	return l.ReturnCount();
+}
+
 int LuaApi::IsKeyPressed(lua_State *lua)
 {
 	LuaCallHelper l(lua);
@@ -59,6 +59,7 @@ public:
 	static int LoadSavestateAsync(lua_State *lua);
 	static int GetSavestateData(lua_State *lua);
 	static int ClearSavestateData(lua_State *lua);
+	static int GetStateHash(lua_State *lua);
 
 	static int IsKeyPressed(lua_State *lua);
 
@@ -177,6 +177,7 @@ class MMC1 : public BaseMapper
 
 		virtual uint16_t GetPRGPageSize() override { return 0x4000; }
 		virtual uint16_t GetCHRPageSize() override {	return 0x1000; }
+		bool AllowPpuCatchUp() override { return true; }
 
 		virtual void InitMapper() override
 		{
@@ -37,6 +37,8 @@ protected:
 				_console->GetCpu()->SetIrqSource(IRQSource::External);
 				_irqEnabled = false;
 			}
+		} else {
+			SuspendCpuClock();
 		}
 	}
 
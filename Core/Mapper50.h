@@ -42,6 +42,8 @@ protected:
 				_console->GetCpu()->SetIrqSource(IRQSource::External);
 				_irqEnabled = false;
 			}
+		} else {
+			SuspendCpuClock();
 		}
 	}
 
@@ -7,10 +7,13 @@
 #include "MemoryDumper.h"
 #include "PPU.h"
 #include "BaseMapper.h"
+#include "DirtyPageTracker.h"
 
 MemoryAccessCounter::MemoryAccessCounter(Debugger* debugger)
 {
 	_debugger = debugger;
+	_ppuPageStampsRequested = false;
+	_ppuPageStampsReady = false;
 	
 	uint32_t memorySizes[4] = {
 		0x2000,
@@ -98,6 +101,10 @@ void MemoryAccessCounter::ProcessPpuMemoryAccess(PpuAddressTypeInfo &addressInfo
 		vector<uint64_t> &stamps = GetPpuStampArray(operation, addressInfo.Type);
 		stamps.data()[addressInfo.Address] = cpuCycle;
 	}
+
+	if(operation == MemoryOperationType::Write) {
+		_ppuWriteCount++;
+	}
 }
 
 bool MemoryAccessCounter::ProcessMemoryAccess(AddressTypeInfo &addressInfo, MemoryOperationType operation, uint64_t cpuCycle)
@@ -191,6 +198,70 @@ void MemoryAccessCounter::GetAccessStamps(uint32_t offset, uint32_t length, Debu
 	}
 }
 
+void MemoryAccessCounter::UpdatePpuPageStamps()
+{
+	if(!_dirtyPageTracker) {
+		if(!_ppuPageStampsRequested) {
+			return;
+		}
+		_dirtyPageTracker = _debugger->GetConsole()->SubscribeDirtyPageTracking();
+	}
+
+	DebugMemoryType types[2] = { DebugMemoryType::ChrRam, DebugMemoryType::NametableRam };
+	PpuAddressType ppuTypes[2] = { PpuAddressType::ChrRam, PpuAddressType::NametableRam };
+	if(!_ppuPageStampsReady) {
+		//Start from the highest stamp of each page - stamps can be ahead of the cycle counter after a state was loaded
+		for(int i = 0; i < 2; i++) {
+			vector<uint64_t> &stamps = _ppuWriteStamps[(int)ppuTypes[i]];
+			vector<uint64_t> &pageStamps = _ppuPageStamps[(int)ppuTypes[i]];
+			pageStamps.assign(_dirtyPageTracker->GetPageCount(types[i]), 0);
+			for(size_t j = 0; j < stamps.size() && (j >> DirtyPageTracker::PageShift) < pageStamps.size(); j++) {
+				pageStamps[j >> DirtyPageTracker::PageShift] = std::max(pageStamps[j >> DirtyPageTracker::PageShift], stamps[j]);
+			}
+		}
+	}
+
+	//Every write made before this point has a stamp lower or equal to its page's stamp (page stamps never decrease,
+	//even when the cycle counter goes back after loading a state)
+	uint64_t cpuCycle = _debugger->GetConsole()->GetCpu()->GetCycleCount();
+	for(int i = 0; i < 2; i++) {
+		vector<uint64_t> &pageStamps = _ppuPageStamps[(int)ppuTypes[i]];
+		_dirtyPageTracker->GetDirtyPages(types[i], _dirtyPages);
+		for(uint32_t page : _dirtyPages) {
+			pageStamps[page] = std::max(pageStamps[page], cpuCycle);
+		}
+		_dirtyPageTracker->Reset(types[i]);
+	}
+	_ppuPageStampsWriteCount = _ppuWriteCount;
+	_ppuPageStampsReady = true;
+}
+
+void MemoryAccessCounter::ReleaseDirtyPageTracking()
+{
+	if(_dirtyPageTracker) {
+		_ppuPageStampsRequested = false;
+		_ppuPageStampsReady = false;
+		_dirtyPageTracker = nullptr;
+		_debugger->GetConsole()->UnsubscribeDirtyPageTracking();
+	}
+}
+
+bool MemoryAccessCounter::IsPpuPageUnchanged(PpuAddressTypeInfo &addressInfo, uint64_t cpuCycle, uint32_t cyclesPerFrame)
+{
+	if((addressInfo.Type != PpuAddressType::ChrRam && addressInfo.Type != PpuAddressType::NametableRam) || (addressInfo.Address & 0xFF)) {
+		return false;
+	}
+
+	vector<uint64_t> &pageStamps = _ppuPageStamps[(int)addressInfo.Type];
+	uint32_t page = addressInfo.Address >> DirtyPageTracker::PageShift;
+	if(page >= pageStamps.size()) {
+		return false;
+	}
+
+	uint64_t pageStamp = pageStamps[page];
+	return pageStamp <= cpuCycle && cpuCycle - pageStamp >= cyclesPerFrame;
+}
+
 void MemoryAccessCounter::GetNametableChangedData(bool ntChangedData[])
 {
 	PpuAddressTypeInfo addressInfo;
@@ -200,9 +271,16 @@ void MemoryAccessCounter::GetNametableChangedData(bool ntChangedData[])
 	double overclockRate = _debugger->GetConsole()->GetPpu()->GetOverclockRate() * 100;
 	uint32_t cyclesPerFrame = (uint32_t)(_debugger->GetConsole()->GetCpu()->GetClockRate(model) / frameRate * overclockRate);
 
+	//The page stamps can only be used if no PPU writes occurred since they were last updated
+	_ppuPageStampsRequested = true;
+	bool usePageStamps = _ppuPageStampsReady && _ppuPageStampsWriteCount == _ppuWriteCount;
+
 	for(int i = 0; i < 0x1000; i++) {
 		_debugger->GetPpuAbsoluteAddressAndType(0x2000+i, &addressInfo);
-		if(addressInfo.Type != PpuAddressType::None) {
+		if(usePageStamps && (i & 0xFF) == 0 && IsPpuPageUnchanged(addressInfo, cpuCycle, cyclesPerFrame)) {
+			memset(ntChangedData + i, 0, 0x100 * sizeof(bool));
+			i += 0xFF;
+		} else if(addressInfo.Type != PpuAddressType::None) {
 			ntChangedData[i] = (cpuCycle - _ppuWriteStamps[(int)addressInfo.Type][addressInfo.Address]) < cyclesPerFrame;
 		} else {
 			ntChangedData[i] = false;
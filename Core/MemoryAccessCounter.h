@@ -4,6 +4,7 @@
 #include "IMemoryHandler.h"
 #include <unordered_set>
 class Debugger;
+class DirtyPageTracker;
 
 class MemoryAccessCounter
 {
@@ -24,6 +25,18 @@ private:
 	vector<uint64_t> _ppuReadStamps[4];
 	vector<uint64_t> _ppuWriteStamps[4];
 
+	//Per-page (256 bytes) upper bound of the CHR RAM/nametable write stamps, built from the console's dirty page tracker
+	//Lets GetNametableChangedData skip the pages that weren't written to recently without looking at each byte
+	DirtyPageTracker* _dirtyPageTracker = nullptr;
+	atomic<bool> _ppuPageStampsRequested;
+	atomic<bool> _ppuPageStampsReady;
+	vector<uint64_t> _ppuPageStamps[4];
+	vector<uint32_t> _dirtyPages;
+	uint64_t _ppuWriteCount = 0;
+	uint64_t _ppuPageStampsWriteCount = 0;
+
+	bool IsPpuPageUnchanged(PpuAddressTypeInfo &addressInfo, uint64_t cpuCycle, uint32_t cyclesPerFrame);
+
 	vector<int32_t>& GetCountArray(MemoryOperationType operationType, AddressType addressType);
 	vector<uint64_t>& GetStampArray(MemoryOperationType operationType, AddressType addressType);
 
@@ -37,6 +50,10 @@ public:
 	bool ProcessMemoryAccess(AddressTypeInfo &addressInfo, MemoryOperationType operation, uint64_t cpuCycle);
 	void ResetCounts();
 
+	//Emulation thread only - called before the PPU viewers are refreshed (the tracker is subscribed to once the nametable data is requested)
+	void UpdatePpuPageStamps();
+	void ReleaseDirtyPageTracking();
+
 	bool IsAddressUninitialized(AddressTypeInfo &addressInfo);
 	
 	void GetUninitMemoryReads(DebugMemoryType memoryType, int32_t counts[]);
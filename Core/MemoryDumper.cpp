@@ -1,4 +1,5 @@
 #include "stdafx.h"
+#include "Console.h"
 #include "Debugger.h"
 #include "MemoryManager.h"
 #include "PPU.h"
@@ -22,6 +23,8 @@ MemoryDumper::MemoryDumper(shared_ptr<PPU> ppu, shared_ptr<MemoryManager> memory
 
 void MemoryDumper::SetMemoryState(DebugMemoryType type, uint8_t *buffer, int32_t length)
 {
+	_debugger->GetConsole()->InvalidateRunAhead();
+
 	switch(type) {
 		case DebugMemoryType::ChrRom:
 		case DebugMemoryType::PrgRom:
@@ -174,6 +177,8 @@ void MemoryDumper::SetMemoryValues(DebugMemoryType memoryType, uint32_t address,
 
 void MemoryDumper::SetMemoryValue(DebugMemoryType memoryType, uint32_t address, uint8_t value, bool preventRebuildCache, bool disableSideEffects)
 {
+	_debugger->GetConsole()->InvalidateRunAhead();
+
 	vector<uint8_t> originalRomData;
 	if(!preventRebuildCache) {
 		originalRomData = _mapper->GetPrgChrCopy();
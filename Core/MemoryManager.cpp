@@ -4,6 +4,12 @@
 #include "Debugger.h"
 #include "CheatManager.h"
 #include "Console.h"
+#include "DirtyPageTracker.h"
+
+void DirtyPageWriteHandler::WriteRAM(uint16_t addr, uint8_t value)
+{
+	_memoryManager->TrackedWrite(addr, value);
+}
 
 MemoryManager::MemoryManager(shared_ptr<Console> console)
 {
@@ -13,12 +19,17 @@ MemoryManager::MemoryManager(shared_ptr<Console> console)
 
 	_ramReadHandlers = new IMemoryHandler*[RAMSize];
 	_ramWriteHandlers = new IMemoryHandler*[RAMSize];
+	_trackedWriteHandlers = new IMemoryHandler*[RAMSize];
+	_cpuWriteHandlers = _ramWriteHandlers;
+	_dirtyPageWriteHandler.SetMemoryManager(this);
 
 	for(int i = 0; i < RAMSize; i++) {
 		_ramReadHandlers[i] = &_openBusHandler;
 		_ramWriteHandlers[i] = &_openBusHandler;
 	}
 
+	memset(_directReadPages, 0, sizeof(_directReadPages));
+
 	RegisterIODevice(&_internalRamHandler);	
 }
 
@@ -28,11 +39,14 @@ MemoryManager::~MemoryManager()
 
 	delete[] _ramReadHandlers;
 	delete[] _ramWriteHandlers;
+	delete[] _trackedWriteHandlers;
 }
 
 void MemoryManager::SetMapper(shared_ptr<BaseMapper> mapper)
 {
 	_mapper = mapper;
+	UpdateDirectReadPages();
+	UpdateTrackedWriteHandlers();
 }
 
 void MemoryManager::Reset(bool softReset)
@@ -61,6 +75,9 @@ void MemoryManager::RegisterIODevice(IMemoryHandler *handler)
 
 	InitializeMemoryHandlers(_ramReadHandlers, handler, ranges.GetRAMReadAddresses(), ranges.GetAllowOverride());
 	InitializeMemoryHandlers(_ramWriteHandlers, handler, ranges.GetRAMWriteAddresses(), ranges.GetAllowOverride());
+
+	UpdatePageReadHandlers();
+	UpdateTrackedWriteHandlers();
 }
 
 void MemoryManager::RegisterWriteHandler(IMemoryHandler* handler, uint32_t start, uint32_t end)
@@ -68,6 +85,7 @@ void MemoryManager::RegisterWriteHandler(IMemoryHandler* handler, uint32_t start
 	for(uint32_t i = start; i < end; i++) {
 		_ramWriteHandlers[i] = handler;
 	}
+	UpdateTrackedWriteHandlers();
 }
 
 void MemoryManager::UnregisterIODevice(IMemoryHandler *handler)
@@ -82,6 +100,43 @@ void MemoryManager::UnregisterIODevice(IMemoryHandler *handler)
 	for(uint16_t address : *ranges.GetRAMWriteAddresses()) {
 		_ramWriteHandlers[address] = &_openBusHandler;
 	}
+
+	UpdatePageReadHandlers();
+	UpdateTrackedWriteHandlers();
+}
+
+void MemoryManager::UpdatePageReadHandlers()
+{
+	for(int page = 0; page < 0x100; page++) {
+		IMemoryHandler* handler = _ramReadHandlers[page << 8];
+		for(int i = 1; i < 0x100; i++) {
+			if(_ramReadHandlers[(page << 8) | i] != handler) {
+				handler = nullptr;
+				break;
+			}
+		}
+		_pageReadHandlers[page] = handler;
+	}
+
+	UpdateDirectReadPages();
+}
+
+void MemoryManager::UpdateDirectReadPages(uint16_t startAddr, uint16_t endAddr)
+{
+	//Cheats and the debugger need to see every read, disable the fast path entirely while they are active
+	bool enabled = _mapper && !_console->GetCheatManager()->HasCodes() && !_console->GetDebugger(false);
+
+	for(int page = startAddr >> 8; page <= endAddr >> 8; page++) {
+		uint8_t* directPage = nullptr;
+		if(enabled) {
+			if(_pageReadHandlers[page] == &_internalRamHandler) {
+				directPage = _internalRAM + ((page << 8) & (InternalRAMSize - 1));
+			} else if(_pageReadHandlers[page] == _mapper.get()) {
+				directPage = _mapper->GetDirectReadPage(page);
+			}
+		}
+		_directReadPages[page] = directPage;
+	}
 }
 
 uint8_t* MemoryManager::GetInternalRAM()
@@ -89,6 +144,51 @@ uint8_t* MemoryManager::GetInternalRAM()
 	return _internalRAM;
 }
 
+void MemoryManager::SetDirtyPageTracker(DirtyPageTracker* tracker)
+{
+	_dirtyPageTracker = tracker;
+	UpdateTrackedWriteHandlers();
+}
+
+void MemoryManager::UpdateTrackedWriteHandlers()
+{
+	if(!_dirtyPageTracker) {
+		_cpuWriteHandlers = _ramWriteHandlers;
+		return;
+	}
+
+	//Only writes to internal RAM and to the mapper (work/save RAM) need to be tracked, other devices are called directly
+	for(int i = 0; i < RAMSize; i++) {
+		IMemoryHandler* handler = _ramWriteHandlers[i];
+		bool tracked = handler == &_internalRamHandler || (_mapper && handler == _mapper.get());
+		_trackedWriteHandlers[i] = tracked ? &_dirtyPageWriteHandler : handler;
+	}
+	_cpuWriteHandlers = _trackedWriteHandlers;
+}
+
+void MemoryManager::MarkDirtyPage(uint16_t addr)
+{
+	IMemoryHandler* handler = _ramWriteHandlers[addr];
+	if(handler == &_internalRamHandler) {
+		_dirtyPageTracker->MarkDirty(DebugMemoryType::InternalRam, addr & (InternalRAMSize - 1));
+	} else if(_mapper && handler == _mapper.get()) {
+		AddressTypeInfo addressInfo;
+		_mapper->GetAbsoluteAddressAndType(addr, &addressInfo);
+		if(addressInfo.Type == AddressType::WorkRam) {
+			_dirtyPageTracker->MarkDirty(DebugMemoryType::WorkRam, addressInfo.Address);
+		} else if(addressInfo.Type == AddressType::SaveRam) {
+			_dirtyPageTracker->MarkDirty(DebugMemoryType::SaveRam, addressInfo.Address);
+		}
+	}
+}
+
+void MemoryManager::TrackedWrite(uint16_t addr, uint8_t value)
+{
+	//The page is resolved before the write, in case the write changes the mapper's banking
+	MarkDirtyPage(addr);
+	_ramWriteHandlers[addr]->WriteRAM(addr, value);
+}
+
 uint8_t MemoryManager::DebugRead(uint16_t addr, bool disableSideEffects)
 {
 	uint8_t value = 0x00;
@@ -118,26 +218,51 @@ uint16_t MemoryManager::DebugReadWord(uint16_t addr)
 	return DebugRead(addr) | (DebugRead(addr + 1) << 8);
 }
 
+template<uint8_t features>
 uint8_t MemoryManager::Read(uint16_t addr, MemoryOperationType operationType)
 {
-	uint8_t value = _ramReadHandlers[addr]->ReadRAM(addr);
-	_console->GetCheatManager()->ApplyCodes(addr, value);
-	_console->DebugProcessRamOperation(operationType, addr, value);
+	uint8_t value;
+	uint8_t* page = _directReadPages[addr >> 8];
+	if(page) {
+		value = page[(uint8_t)addr];
+	} else {
+		value = _ramReadHandlers[addr]->ReadRAM(addr);
+		if(features & CpuFeatures::Cheats) {
+			_console->GetCheatManager()->ApplyCodes(addr, value);
+		}
+		if(features & CpuFeatures::Debugger) {
+			_console->DebugProcessRamOperation(operationType, addr, value);
+		}
+	}
 
 	_openBusHandler.SetOpenBus(value);
 
 	return value;
 }
 
+template<uint8_t features>
 void MemoryManager::Write(uint16_t addr, uint8_t value, MemoryOperationType operationType)
 {
-	if(_console->DebugProcessRamOperation(operationType, addr, value)) {
-		_ramWriteHandlers[addr]->WriteRAM(addr, value);
+	if(!(features & CpuFeatures::Debugger) || _console->DebugProcessRamOperation(operationType, addr, value)) {
+		_cpuWriteHandlers[addr]->WriteRAM(addr, value);
 	}
 }
 
+template uint8_t MemoryManager::Read<CpuFeatures::None>(uint16_t addr, MemoryOperationType operationType);
+template uint8_t MemoryManager::Read<CpuFeatures::Debugger>(uint16_t addr, MemoryOperationType operationType);
+template uint8_t MemoryManager::Read<CpuFeatures::Cheats>(uint16_t addr, MemoryOperationType operationType);
+template uint8_t MemoryManager::Read<CpuFeatures::All>(uint16_t addr, MemoryOperationType operationType);
+template void MemoryManager::Write<CpuFeatures::None>(uint16_t addr, uint8_t value, MemoryOperationType operationType);
+template void MemoryManager::Write<CpuFeatures::Debugger>(uint16_t addr, uint8_t value, MemoryOperationType operationType);
+template void MemoryManager::Write<CpuFeatures::Cheats>(uint16_t addr, uint8_t value, MemoryOperationType operationType);
+template void MemoryManager::Write<CpuFeatures::All>(uint16_t addr, uint8_t value, MemoryOperationType operationType);
+
 void MemoryManager::DebugWrite(uint16_t addr, uint8_t value, bool disableSideEffects)
 {
+	if(_dirtyPageTracker) {
+		MarkDirtyPage(addr);
+	}
+
 	if(addr <= 0x1FFF) {
 		_ramWriteHandlers[addr]->WriteRAM(addr, value);
 	} else {
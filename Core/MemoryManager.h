@@ -1,6 +1,7 @@
 #pragma once
 
 #include "stdafx.h"
+#include "Types.h"
 #include "IMemoryHandler.h"
 #include "Snapshotable.h"
 #include "OpenBusHandler.h"
@@ -8,6 +9,22 @@
 
 class BaseMapper;
 class Console;
+class DirtyPageTracker;
+class MemoryManager;
+
+//Forwards CPU writes to the regular write handlers and flags the pages they modify (only used while dirty page tracking is enabled)
+class DirtyPageWriteHandler : public IMemoryHandler
+{
+private:
+	MemoryManager* _memoryManager = nullptr;
+
+public:
+	void SetMemoryManager(MemoryManager* memoryManager) { _memoryManager = memoryManager; }
+
+	void GetMemoryRanges(MemoryRanges &ranges) override {}
+	uint8_t ReadRAM(uint16_t addr) override { return 0; }
+	void WriteRAM(uint16_t addr, uint8_t value) override;
+};
 
 class MemoryManager : public Snapshotable
 {
@@ -25,7 +42,22 @@ class MemoryManager : public Snapshotable
 		IMemoryHandler** _ramReadHandlers;
 		IMemoryHandler** _ramWriteHandlers;
 
+		//Handlers used for CPU writes: _ramWriteHandlers, or _trackedWriteHandlers while dirty page tracking is enabled
+		//(RAM writes are redirected to _dirtyPageWriteHandler, so tracking has no cost at all when it is disabled)
+		IMemoryHandler** _cpuWriteHandlers;
+		IMemoryHandler** _trackedWriteHandlers;
+		DirtyPageWriteHandler _dirtyPageWriteHandler;
+		DirtyPageTracker* _dirtyPageTracker = nullptr;
+
+		//Handler for all reads in a 256-byte page (nullptr when the page is split between several handlers)
+		IMemoryHandler* _pageReadHandlers[0x100];
+		//Plain RAM/ROM pages that the CPU can read without going through the memory handlers (nullptr = use the handlers)
+		uint8_t* _directReadPages[0x100];
+
 		void InitializeMemoryHandlers(IMemoryHandler** memoryHandlers, IMemoryHandler* handler, vector<uint16_t> *addresses, bool allowOverride);
+		void UpdatePageReadHandlers();
+		void UpdateTrackedWriteHandlers();
+		void MarkDirtyPage(uint16_t addr);
 
 	protected:
 		void StreamState(bool saving) override;
@@ -42,6 +74,7 @@ class MemoryManager : public Snapshotable
 		void RegisterIODevice(IMemoryHandler *handler);
 		void RegisterWriteHandler(IMemoryHandler* handler, uint32_t start, uint32_t end);
 		void UnregisterIODevice(IMemoryHandler *handler);
+		void UpdateDirectReadPages(uint16_t startAddr = 0, uint16_t endAddr = 0xFFFF);
 
 		uint8_t DebugRead(uint16_t addr, bool disableSideEffects = true);
 		uint16_t DebugReadWord(uint16_t addr);
@@ -49,8 +82,16 @@ class MemoryManager : public Snapshotable
 
 		uint8_t* GetInternalRAM();
 
-		uint8_t Read(uint16_t addr, MemoryOperationType operationType = MemoryOperationType::Read);
-		void Write(uint16_t addr, uint8_t value, MemoryOperationType operationType);
+		//Flags the RAM pages modified by CPU writes in the tracker (nullptr disables tracking)
+		void SetDirtyPageTracker(DirtyPageTracker* tracker);
+		void TrackedWrite(uint16_t addr, uint8_t value);
+
+		//CPU accesses, only the hooks selected by "features" (CpuFeatures) are processed
+		template<uint8_t features> uint8_t Read(uint16_t addr, MemoryOperationType operationType);
+		template<uint8_t features> void Write(uint16_t addr, uint8_t value, MemoryOperationType operationType);
+
+		uint8_t Read(uint16_t addr, MemoryOperationType operationType = MemoryOperationType::Read) { return Read<CpuFeatures::All>(addr, operationType); }
+		void Write(uint16_t addr, uint8_t value, MemoryOperationType operationType) { Write<CpuFeatures::All>(addr, value, operationType); }
 
 		uint32_t ToAbsolutePrgAddress(uint16_t ramAddr);
 
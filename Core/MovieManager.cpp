@@ -7,18 +7,20 @@
 #include "MovieRecorder.h"
 #include "VirtualFile.h"
 
-shared_ptr<IMovie> MovieManager::_player;
-shared_ptr<MovieRecorder> MovieManager::_recorder;
+MovieManager::MovieManager(shared_ptr<Console> console)
+{
+	_console = console;
+}
 
-void MovieManager::Record(RecordMovieOptions options, shared_ptr<Console> console)
+void MovieManager::Record(RecordMovieOptions options)
 {
-	shared_ptr<MovieRecorder> recorder(new MovieRecorder(console));
+	shared_ptr<MovieRecorder> recorder(new MovieRecorder(_console));
 	if(recorder->Record(options)) {
 		_recorder = recorder;
 	}
 }
 
-void MovieManager::Play(VirtualFile file, shared_ptr<Console> console)
+void MovieManager::Play(VirtualFile file)
 {
 	vector<uint8_t> fileData;
 	if(file.IsValid() && file.ReadFile(fileData)) {
@@ -33,12 +35,12 @@ void MovieManager::Play(VirtualFile file, shared_ptr<Console> console)
 
 			vector<string> files = reader.GetFileList();
 			if(std::find(files.begin(), files.end(), "GameSettings.txt") != files.end()) {
-				player.reset(new MesenMovie(console));
+				player.reset(new MesenMovie(_console));
 			} else {
-				player.reset(new BizhawkMovie(console));
+				player.reset(new BizhawkMovie(_console));
 			}
 		} else if(memcmp(fileData.data(), "ver", 3) == 0) {
-			player.reset(new FceuxMovie(console));
+			player.reset(new FceuxMovie(_console));
 		}
 
 		if(player && player->Play(file)) {
@@ -245,7 +245,7 @@ bool MovieRecorder::CreateMovie(string movieFile, std::deque<RewindData> &data,
 
 		for(uint32_t i = startPosition; i < endPosition; i++) {
 			RewindData rewindData = data[i];
-			for(uint32_t i = 0; i < 30; i++) {
+			for(uint32_t i = 0; i < (uint32_t)rewindData.FrameCount; i++) {
 				for(shared_ptr<BaseControlDevice> &device : devices) {
 					uint8_t port = device->GetPort();
 					if(i < rewindData.InputLogs[port].size()) {
@@ -31,8 +31,17 @@ void NotificationManager::CleanupNotificationListeners()
 	);
 }
 
+void NotificationManager::SetEnabled(bool enabled)
+{
+	_enabled = enabled;
+}
+
 void NotificationManager::SendNotification(ConsoleNotificationType type, void* parameter)
 {
+	if(!_enabled) {
+		return;
+	}
+
 	vector<weak_ptr<INotificationListener>> listeners;
 	{
 		auto lock = _lock.AcquireSafe();
@@ -9,10 +9,14 @@ private:
 	SimpleLock _lock;
 	vector<weak_ptr<INotificationListener>> _listenersToAdd;
 	vector<weak_ptr<INotificationListener>> _listeners;
+	bool _enabled = true;
 	
 	void CleanupNotificationListeners();
 
 public:
 	void RegisterNotificationListener(shared_ptr<INotificationListener> notificationListener);
 	void SendNotification(ConsoleNotificationType type, void* parameter = nullptr);
+
+	//Used by headless runs to skip all notification processing
+	void SetEnabled(bool enabled);
 };
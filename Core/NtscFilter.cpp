@@ -1,15 +1,16 @@
 #include "stdafx.h"
+#include <algorithm>
 #include "NtscFilter.h"
 #include "PPU.h"
 #include "EmulationSettings.h"
 #include "Console.h"
+#include "WorkerPool.h"
 
 NtscFilter::NtscFilter(shared_ptr<Console> console) : BaseVideoFilter(console)
 {
 	memset(_palette, 0, sizeof(_palette));
 	memset(&_ntscData, 0, sizeof(_ntscData));
 	_ntscSetup = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-	_ntscBuffer = new uint32_t[NES_NTSC_OUT_WIDTH(256) * 240];
 }
 
 FrameInfo NtscFilter::GetFrameInfo()
@@ -59,6 +60,8 @@ void NtscFilter::OnBeforeApplyFilter()
 	NtscFilterSettings ntscSettings = _console->GetSettings()->GetNtscFilterSettings();
 
 	_keepVerticalRes = ntscSettings.KeepVerticalResolution;
+	_verticalBlend = ntscSettings.VerticalBlend;
+	_scanlineIntensity = 1.0 - pictureSettings.ScanlineIntensity;
 
 	if(paletteChanged || _ntscSetup.hue != pictureSettings.Hue || _ntscSetup.saturation != pictureSettings.Saturation || _ntscSetup.brightness != pictureSettings.Brightness || _ntscSetup.contrast != pictureSettings.Contrast ||
 		_ntscSetup.artifacts != ntscSettings.Artifacts || _ntscSetup.bleed != ntscSettings.Bleed || _ntscSetup.fringing != ntscSettings.Fringing || _ntscSetup.gamma != ntscSettings.Gamma ||
@@ -90,11 +93,24 @@ void NtscFilter::OnBeforeApplyFilter()
 
 void NtscFilter::ApplyFilter(uint16_t *ppuOutputBuffer)
 {
-	nes_ntsc_blit(&_ntscData, ppuOutputBuffer, PPU::ScreenWidth, IsOddFrame() ? 0 : 1, PPU::ScreenWidth, 240, _ntscBuffer, NES_NTSC_OUT_WIDTH(PPU::ScreenWidth)*4);
-	GenerateArgbFrame(_ntscBuffer);
+	OverscanDimensions overscan = GetOverscan();
+	int firstRow = overscan.Top;
+	int rowCount = PPU::ScreenHeight - overscan.Top - overscan.Bottom;
+
+	shared_ptr<WorkerPool> pool = WorkerPool::GetVideoFilterPool(_console->GetSettings()->GetVideoFilterThreadCount());
+	uint32_t bandCount = std::max<uint32_t>(1, std::min<uint32_t>(pool->GetThreadCount(), rowCount / NtscFilter::MinBandHeight));
+	if(_bandBuffers.size() < bandCount) {
+		_bandBuffers.resize(bandCount);
+	}
+
+	pool->Run(bandCount, [=](uint32_t band) {
+		int yFirst = firstRow + rowCount * band / bandCount;
+		int yLast = firstRow + rowCount * (band + 1) / bandCount;
+		ApplyFilterToBand(ppuOutputBuffer, yFirst, yLast, _bandBuffers[band]);
+	});
 }
 
-void NtscFilter::GenerateArgbFrame(uint32_t *ntscBuffer)
+void NtscFilter::ApplyFilterToBand(uint16_t *ppuOutputBuffer, int yFirst, int yLast, vector<uint32_t> &rowBuffer)
 {
 	uint32_t* outputBuffer = GetOutputBuffer();
 	OverscanDimensions overscan = GetOverscan();
@@ -102,60 +118,77 @@ void NtscFilter::GenerateArgbFrame(uint32_t *ntscBuffer)
 	int overscanRight = overscan.Right > 0 ? NES_NTSC_OUT_WIDTH(overscan.Right) : 0;
 	int rowWidth = NES_NTSC_OUT_WIDTH(PPU::ScreenWidth);
 	int rowWidthOverscan = rowWidth - overscanLeft - overscanRight;
+	int burstPhase = IsOddFrame() ? 0 : 1;
+
+	//Rows are blitted one at a time (the burst phase advances by 1 on each row) and converted while they are still in the cache
+	rowBuffer.resize(rowWidth * 2);
+	uint32_t* currentRow = rowBuffer.data();
+	uint32_t* nextRow = currentRow + rowWidth;
+	auto blitRow = [=](int y, uint32_t* target) {
+		nes_ntsc_blit(&_ntscData, ppuOutputBuffer + y * PPU::ScreenWidth, PPU::ScreenWidth, (burstPhase + y) % nes_ntsc_burst_count, PPU::ScreenWidth, 1, target, rowWidth * 4);
+	};
 
 	if(_keepVerticalRes) {
-		ntscBuffer += rowWidth * overscan.Top + overscanLeft;
-		for(uint32_t i = 0, len = overscan.GetScreenHeight(); i < len; i++) {
-			memcpy(outputBuffer, ntscBuffer, rowWidthOverscan * sizeof(uint32_t));
-			outputBuffer += rowWidthOverscan;
-			ntscBuffer += rowWidth;
+		uint32_t* out = outputBuffer + (yFirst - overscan.Top) * rowWidthOverscan;
+		for(int y = yFirst; y < yLast; y++) {
+			blitRow(y, currentRow);
+			memcpy(out, currentRow + overscanLeft, rowWidthOverscan * sizeof(uint32_t));
+			out += rowWidthOverscan;
 		}
-	} else {
-		double scanlineIntensity = 1.0 - _console->GetSettings()->GetPictureSettings().ScanlineIntensity;
-		bool verticalBlend = _console->GetSettings()->GetNtscFilterSettings().VerticalBlend;
-
-		for(int y = PPU::ScreenHeight - 1 - overscan.Bottom; y >= (int)overscan.Top; y--) {
-			uint32_t const* in = ntscBuffer + y * rowWidth;
-			uint32_t* out = outputBuffer + (y - overscan.Top) * 2 * rowWidthOverscan;
-
-			if(verticalBlend || scanlineIntensity < 1.0) {
-				for(int x = 0; x < rowWidthOverscan; x++) {
-					uint32_t prev = in[overscanLeft];
-					uint32_t next = y < 239 ? in[overscanLeft + rowWidth] : 0;
-
-					*out = 0xFF000000 | prev;
-
-					/* mix 24-bit rgb without losing low bits */
-					uint32_t mixed;
-					if(verticalBlend) {
-						mixed = (prev + next + ((prev ^ next) & 0x030303)) >> 1;
-					} else {
-						mixed = prev;
-					}
-
-					if(scanlineIntensity < 1.0) {
-						uint8_t r = (mixed >> 16) & 0xFF, g = (mixed >> 8) & 0xFF, b = mixed & 0xFF;
-						r = (uint8_t)(r * scanlineIntensity);
-						g = (uint8_t)(g * scanlineIntensity);
-						b = (uint8_t)(b * scanlineIntensity);
-						*(out + rowWidthOverscan) = 0xFF000000 | (r << 16) | (g << 8) | b;
-					} else {
-						*(out + rowWidthOverscan) = 0xFF000000 | mixed;
-					}
-					in++;
-					out++;
+		return;
+	}
+
+	double scanlineIntensity = _scanlineIntensity;
+	bool verticalBlend = _verticalBlend;
+
+	blitRow(yFirst, currentRow);
+	for(int y = yFirst; y < yLast; y++) {
+		//The next row is needed for the next iteration, or to blend with when it belongs to the next band (or the bottom overscan)
+		bool hasNextRow = y + 1 < (int)PPU::ScreenHeight;
+		if(hasNextRow && (y + 1 < yLast || verticalBlend)) {
+			blitRow(y + 1, nextRow);
+		}
+
+		uint32_t const* in = currentRow + overscanLeft;
+		uint32_t const* nextIn = nextRow + overscanLeft;
+		uint32_t* out = outputBuffer + (y - overscan.Top) * 2 * rowWidthOverscan;
+
+		if(verticalBlend || scanlineIntensity < 1.0) {
+			for(int x = 0; x < rowWidthOverscan; x++) {
+				uint32_t prev = in[x];
+				uint32_t next = hasNextRow ? nextIn[x] : 0;
+
+				out[x] = 0xFF000000 | prev;
+
+				/* mix 24-bit rgb without losing low bits */
+				uint32_t mixed;
+				if(verticalBlend) {
+					mixed = (prev + next + ((prev ^ next) & 0x030303)) >> 1;
+				} else {
+					mixed = prev;
 				}
-			} else {
-				for(int i = 0; i < rowWidthOverscan; i++) {
-					out[i] = 0xFF000000 | in[overscanLeft+i];
+
+				if(scanlineIntensity < 1.0) {
+					uint8_t r = (mixed >> 16) & 0xFF, g = (mixed >> 8) & 0xFF, b = mixed & 0xFF;
+					r = (uint8_t)(r * scanlineIntensity);
+					g = (uint8_t)(g * scanlineIntensity);
+					b = (uint8_t)(b * scanlineIntensity);
+					out[x + rowWidthOverscan] = 0xFF000000 | (r << 16) | (g << 8) | b;
+				} else {
+					out[x + rowWidthOverscan] = 0xFF000000 | mixed;
 				}
-				memcpy(out + rowWidthOverscan, out, rowWidthOverscan * sizeof(uint32_t));
 			}
+		} else {
+			for(int i = 0; i < rowWidthOverscan; i++) {
+				out[i] = 0xFF000000 | in[i];
+			}
+			memcpy(out + rowWidthOverscan, out, rowWidthOverscan * sizeof(uint32_t));
 		}
+
+		std::swap(currentRow, nextRow);
 	}
 }
 
 NtscFilter::~NtscFilter()
 {
-	delete[] _ntscBuffer;
 }
\ No newline at end of file
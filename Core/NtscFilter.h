@@ -11,10 +11,15 @@ private:
 	nes_ntsc_setup_t _ntscSetup;
 	nes_ntsc_t _ntscData;
 	bool _keepVerticalRes = false;
+	bool _verticalBlend = false;
+	double _scanlineIntensity = 1.0;
 	uint8_t _palette[512 * 3];
-	uint32_t* _ntscBuffer;
 
-	void GenerateArgbFrame(uint32_t *outputBuffer);
+	//Each band is blitted by a different thread, one row at a time into its own 2-row buffer
+	vector<vector<uint32_t>> _bandBuffers;
+	static constexpr int MinBandHeight = 16;
+
+	void ApplyFilterToBand(uint16_t *ppuOutputBuffer, int yFirst, int yLast, vector<uint32_t> &rowBuffer);
 
 protected:
 	void OnBeforeApplyFilter();
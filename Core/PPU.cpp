@@ -45,6 +45,7 @@ PPU::~PPU()
 void PPU::Reset()
 {
 	_masterClock = 0;
+	_catchUpDeadline = 0;
 	_preventVblFlag = false;
 
 	_needStateUpdate = false;
@@ -108,6 +109,7 @@ void PPU::Reset()
 void PPU::SetNesModel(NesModel model)
 {
 	_nesModel = model;
+	_catchUpDeadline = 0;
 
 	switch(_nesModel) {
 		case NesModel::Auto:
@@ -1170,12 +1172,17 @@ void PPU::SendFrame()
 #ifdef LIBRETRO
 	_console->GetVideoDecoder()->UpdateFrameSync(_currentOutputBuffer);
 #else 
-	if(_console->GetRewindManager()->IsRewinding()) {
+	if(_console->IsHeadlessRun()) {
+		//The decoder thread isn't running during headless runs, decode on this thread (if at all)
+		if(_console->IsVideoDecodeEnabled()) {
+			_console->GetVideoDecoder()->UpdateFrameSync(_currentOutputBuffer);
+		}
+	} else if(_console->GetRewindManager()->IsRewinding()) {
 		if(!_console->GetRewindManager()->IsStepBack()) {
 			_console->GetVideoDecoder()->UpdateFrameSync(_currentOutputBuffer);
 		}
 	} else {
-		//If VideoDecoder isn't done with the previous frame, UpdateFrame will block until it is ready to accept a new frame.
+		//UpdateFrame copies the frame and never waits for VideoDecoder (if it is still busy with a previous frame, the older pending frame is dropped)
 		_console->GetVideoDecoder()->UpdateFrame(_currentOutputBuffer);
 	}
 
@@ -1249,7 +1256,7 @@ void PPU::Exec()
 			_statusFlags.SpriteOverflow = false;
 			_statusFlags.Sprite0Hit = false;
 			
-			//Switch to alternate output buffer (VideoDecoder may still be decoding the last frame buffer)
+			//Switch to alternate output buffer (the last frame stays available through GetScreenBuffer(true))
 			_currentOutputBuffer = (_currentOutputBuffer == _outputBuffers[0]) ? _outputBuffers[1] : _outputBuffers[0];
 		} else if(_scanline == 240) {
 			//At the start of vblank, the bus address is set back to VideoRamAddr.
@@ -1289,6 +1296,20 @@ void PPU::Exec()
 	}
 }
 
+void PPU::CatchUp(uint64_t runTo)
+{
+	Run(runTo);
+
+	//Used when the CPU runs in catch-up mode: the CPU only needs to run the PPU once it reaches this master clock value.
+	//Scanlines 239 to NMI+1 run in lockstep with the CPU (frame output, vblank flag and NMI need cycle-accurate timing)
+	if(_scanline >= 239 && _scanline <= (int32_t)_nmiScanline + 1) {
+		_catchUpDeadline = 0;
+	} else {
+		int32_t scanlineCount = _scanline < 239 ? (239 - _scanline) : (_vblankEnd - _scanline + 241);
+		_catchUpDeadline = _masterClock + (uint64_t)(scanlineCount * 341 - _cycle) * _masterClockDivider;
+	}
+}
+
 void PPU::UpdateState()
 {
 	_needStateUpdate = false;
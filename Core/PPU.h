@@ -38,6 +38,7 @@ class PPU : public IMemoryHandler, public Snapshotable
 		uint32_t _frameCount;
 		uint64_t _masterClock;
 		uint8_t _masterClockDivider;
+		uint64_t _catchUpDeadline = 0;
 		uint8_t _memoryReadBuffer;
 
 		uint8_t _paletteRAM[0x20];
@@ -206,6 +207,12 @@ class PPU : public IMemoryHandler, public Snapshotable
 		void Exec();
 		__forceinline void Run(uint64_t runTo);
 
+		void CatchUp(uint64_t runTo);
+		uint64_t GetCatchUpDeadline()
+		{
+			return _catchUpDeadline;
+		}
+
 		uint32_t GetFrameCount()
 		{
 			return _frameCount;
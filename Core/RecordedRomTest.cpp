@@ -127,7 +127,7 @@ void RecordedRomTest::Record(string filename, bool reset)
 		string movieFilename = FolderUtilities::CombinePath(FolderUtilities::GetFolderName(filename), FolderUtilities::GetFilename(filename, false) + ".mmo");
 		memcpy(options.Filename, movieFilename.c_str(), std::max(1000, (int)movieFilename.size()));
 		options.RecordFrom = reset ? RecordMovieFrom::StartWithSaveData : RecordMovieFrom::CurrentState;
-		MovieManager::Record(options, _console);
+		_console->GetMovieManager()->Record(options);
 
 		_console->Resume();
 	}
@@ -151,7 +151,7 @@ void RecordedRomTest::RecordFromMovie(string testFilename, VirtualFile movieFile
 		_recording = true;
 
 		//Start playing movie
-		MovieManager::Play(movieFile, _console);
+		_console->GetMovieManager()->Play(movieFile);
 		movieFile.ReadFile(_movieData);
 		_recordingFromMovie = true;
 
@@ -238,7 +238,7 @@ int32_t RecordedRomTest::Run(string filename)
 		if(_console->Initialize(testRom)) {
 			settings->SetFlags(EmulationFlags::ForceMaxSpeed);
 			_runningTest = true;
-			MovieManager::Play(testMovie, _console);
+			_console->GetMovieManager()->Play(testMovie);
 
 			_console->Resume();
 			_console->GetSettings()->ClearFlags(EmulationFlags::Paused);
@@ -275,7 +275,7 @@ void RecordedRomTest::Save()
 	_recording = false;
 
 	//Stop playing/recording the movie
-	MovieManager::Stop();
+	_console->GetMovieManager()->Stop();
 
 	_file.write("MRT", 3);
 
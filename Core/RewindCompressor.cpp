@@ -0,0 +1,136 @@
+#include "stdafx.h"
+#include "RewindCompressor.h"
+#include "RewindData.h"
+#include "../Utilities/miniz.h"
+
+RewindCompressor::RewindCompressor()
+{
+	_stopFlag = false;
+}
+
+RewindCompressor::~RewindCompressor()
+{
+	if(_thread) {
+		//Pending tasks are completed before stopping, since the states may still be used (e.g by the history viewer)
+		_stopFlag = true;
+		_taskAdded.Signal();
+		_thread->join();
+	}
+}
+
+shared_ptr<vector<uint8_t>> RewindCompressor::GetBuffer()
+{
+	for(shared_ptr<vector<uint8_t>> &buffer : _bufferPool) {
+		//Only the pool references this buffer, the worker is done with it
+		if(buffer.use_count() == 1) {
+			return buffer;
+		}
+	}
+
+	shared_ptr<vector<uint8_t>> buffer(new vector<uint8_t>());
+	if(_bufferPool.size() < MaxPendingTasks + 2) {
+		_bufferPool.push_back(buffer);
+	}
+	return buffer;
+}
+
+void RewindCompressor::AddTask(shared_ptr<CompressedRewindState> target, shared_ptr<vector<uint8_t>> state, shared_ptr<vector<uint8_t>> previousState)
+{
+	CompressionTask task = { target, state, previousState, nullptr, nullptr };
+	QueueTask(task);
+}
+
+void RewindCompressor::AddKeyFrameTask(shared_ptr<CompressedRewindState> target, shared_ptr<CompressedRewindState> source, shared_ptr<CompressedRewindState> dependent)
+{
+	CompressionTask task = { target, nullptr, nullptr, source, dependent };
+	QueueTask(task);
+}
+
+void RewindCompressor::QueueTask(CompressionTask &task)
+{
+	if(!_thread) {
+		_thread.reset(new std::thread(&RewindCompressor::WorkerLoop, this));
+	}
+
+	while(true) {
+		{
+			auto lock = _taskLock.AcquireSafe();
+			if(_tasks.size() < RewindCompressor::MaxPendingTasks) {
+				_tasks.push_back(task);
+				break;
+			}
+		}
+
+		//The worker is too far behind, wait for it to catch up
+		_taskDone.Wait(10);
+	}
+	_taskAdded.Signal();
+}
+
+void RewindCompressor::WorkerLoop()
+{
+	vector<uint8_t> deltaBuffer;
+	while(true) {
+		CompressionTask task;
+		{
+			auto lock = _taskLock.AcquireSafe();
+			if(!_tasks.empty()) {
+				task = _tasks.front();
+			}
+		}
+
+		if(task.Target) {
+			ProcessTask(task, deltaBuffer);
+			{
+				auto lock = _taskLock.AcquireSafe();
+				_tasks.pop_front();
+			}
+			_taskDone.Signal();
+		} else if(_stopFlag) {
+			break;
+		} else {
+			_taskAdded.Wait();
+		}
+	}
+}
+
+void RewindCompressor::ProcessTask(CompressionTask &task, vector<uint8_t> &deltaBuffer)
+{
+	if(task.Source) {
+		//The source's states were queued before this task, so they are already compressed
+		vector<uint8_t> state;
+		RewindData::GetStateData(task.Source.get(), state);
+		CompressState(state, task.Target->Data);
+		task.Target->Ready = true;
+
+		if(task.Dependent) {
+			//The dependent state no longer references the source, which frees the source's chain once nothing else uses it.
+			//This is done by the worker itself, so that states queued before this task never see a target that isn't ready yet
+			std::atomic_store(&task.Dependent->Previous, task.Target);
+		}
+		return;
+	}
+
+	vector<uint8_t> &state = *task.State;
+	if(task.PreviousState) {
+		//Consecutive states are mostly identical, the XOR is mostly zeroes and compresses much better than the state itself
+		vector<uint8_t> &previousState = *task.PreviousState;
+		deltaBuffer.resize(state.size());
+		for(size_t i = 0; i < state.size(); i++) {
+			deltaBuffer[i] = state[i] ^ previousState[i];
+		}
+		CompressState(deltaBuffer, task.Target->Data);
+	} else {
+		CompressState(state, task.Target->Data);
+	}
+	task.Target->Ready = true;
+}
+
+void RewindCompressor::CompressState(vector<uint8_t> &stateData, vector<uint8_t> &compressedState)
+{
+	unsigned long compressedSize = compressBound((unsigned long)stateData.size());
+	compressedState.resize(compressedSize);
+	compress(compressedState.data(), &compressedSize, stateData.data(), (unsigned long)stateData.size());
+	compressedState.resize(compressedSize);
+	compressedState.shrink_to_fit();
+}
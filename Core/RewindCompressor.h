@@ -0,0 +1,57 @@
+#pragma once
+#include "stdafx.h"
+#include <thread>
+#include <deque>
+#include "../Utilities/SimpleLock.h"
+#include "../Utilities/AutoResetEvent.h"
+
+struct CompressedRewindState;
+
+//Compresses rewind states on a background thread, so the emulation thread only has to copy the raw state.
+//Tasks are processed in order - AddTask blocks when the worker falls too far behind.
+class RewindCompressor
+{
+private:
+	static constexpr uint32_t MaxPendingTasks = 8;
+
+	struct CompressionTask
+	{
+		shared_ptr<CompressedRewindState> Target;
+		shared_ptr<vector<uint8_t>> State;
+		shared_ptr<vector<uint8_t>> PreviousState;
+
+		//When set, the state is decoded from this (delta) state instead
+		shared_ptr<CompressedRewindState> Source;
+
+		//When set, this delta state of the source is made to reference the target once it is ready
+		shared_ptr<CompressedRewindState> Dependent;
+	};
+
+	unique_ptr<std::thread> _thread;
+	atomic<bool> _stopFlag;
+
+	SimpleLock _taskLock;
+	std::deque<CompressionTask> _tasks;
+	AutoResetEvent _taskAdded;
+	AutoResetEvent _taskDone;
+
+	//Raw state buffers, reused once nothing else references them
+	vector<shared_ptr<vector<uint8_t>>> _bufferPool;
+
+	void QueueTask(CompressionTask &task);
+	void WorkerLoop();
+	void ProcessTask(CompressionTask &task, vector<uint8_t> &deltaBuffer);
+	void CompressState(vector<uint8_t> &stateData, vector<uint8_t> &compressedState);
+
+public:
+	RewindCompressor();
+	~RewindCompressor();
+
+	shared_ptr<vector<uint8_t>> GetBuffer();
+
+	//When previousState is set, the state is stored as a delta against it (it must match target->Previous)
+	void AddTask(shared_ptr<CompressedRewindState> target, shared_ptr<vector<uint8_t>> state, shared_ptr<vector<uint8_t>> previousState);
+
+	//Decodes the source state and stores it as a key frame in target, then makes the dependent state (if any) a delta of target
+	void AddKeyFrameTask(shared_ptr<CompressedRewindState> target, shared_ptr<CompressedRewindState> source, shared_ptr<CompressedRewindState> dependent);
+};
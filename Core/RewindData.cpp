@@ -1,46 +1,123 @@
 #include "stdafx.h"
+#include <algorithm>
 #include "RewindData.h"
 #include "Console.h"
+#include "RewindCompressor.h"
+#include <thread>
 #include "../Utilities/miniz.h"
 
+bool RewindData::GetStateData(vector<uint8_t> &stateData)
+{
+	return GetStateData(SaveStateData.get(), stateData);
+}
+
+bool RewindData::GetStateData(CompressedRewindState* compressedState, vector<uint8_t> &stateData)
+{
+	//Decompress the key frame, then apply each delta (from oldest to newest) on top of it
+	//The chain holds references to the previous states, in case the worker thread replaces them while they are being decoded
+	vector<CompressedRewindState*> chain;
+	vector<shared_ptr<CompressedRewindState>> previousStates;
+	for(CompressedRewindState* state = compressedState; state; state = previousStates.back().get()) {
+		while(!state->Ready) {
+			//Still being compressed by the worker thread
+			std::this_thread::yield();
+		}
+		chain.push_back(state);
+		previousStates.push_back(std::atomic_load(&state->Previous));
+	}
+
+	if(chain.empty() || chain.back()->OriginalSize == 0) {
+		return false;
+	}
+
+	CompressedRewindState* keyFrame = chain.back();
+	unsigned long length = keyFrame->OriginalSize;
+	stateData.resize(length);
+	uncompress(stateData.data(), &length, keyFrame->Data.data(), (unsigned long)keyFrame->Data.size());
+
+	vector<uint8_t> delta;
+	for(int i = (int)chain.size() - 2; i >= 0; i--) {
+		length = chain[i]->OriginalSize;
+		delta.resize(length);
+		uncompress(delta.data(), &length, chain[i]->Data.data(), (unsigned long)chain[i]->Data.size());
+		for(size_t j = 0, len = std::min(stateData.size(), delta.size()); j < len; j++) {
+			stateData[j] ^= delta[j];
+		}
+	}
+	return true;
+}
+
 void RewindData::GetStateData(stringstream &stateData)
 {
-	unsigned long length = OriginalSaveStateSize;
-	uint8_t* buffer = new uint8_t[length];
-	uncompress(buffer, &length, SaveStateData.data(), (unsigned long)SaveStateData.size());
-	stateData.write((char*)buffer, length);
-	delete[] buffer;
+	vector<uint8_t> state;
+	if(GetStateData(state)) {
+		stateData.write((char*)state.data(), state.size());
+	}
+}
+
+uint32_t RewindData::GetCompressedSize()
+{
+	return SaveStateData && SaveStateData->Ready ? (uint32_t)SaveStateData->Data.size() : 0;
+}
+
+bool RewindData::IsKeyFrame()
+{
+	return SaveStateData && !std::atomic_load(&SaveStateData->Previous);
 }
 
 void RewindData::LoadState(shared_ptr<Console> &console)
 {
-	if(SaveStateData.size() > 0 && OriginalSaveStateSize > 0) {
-		unsigned long length = OriginalSaveStateSize;
-		uint8_t* buffer = new uint8_t[length];
-		uncompress(buffer, &length, SaveStateData.data(), (unsigned long)SaveStateData.size());
-		console->LoadState(buffer, length);
-		delete[] buffer;
+	vector<uint8_t> state;
+	if(GetStateData(state)) {
+		console->LoadState(state.data(), state.size());
 	}
 }
 
-void RewindData::CompressState(string stateData, vector<uint8_t>& compressedState)
+void RewindData::SaveState(shared_ptr<Console> &console, RewindCompressor &compressor, shared_ptr<vector<uint8_t>> &lastState, RewindData *previous)
 {
-	unsigned long compressedSize = compressBound((unsigned long)stateData.size());
-	uint8_t* compressedData = new uint8_t[compressedSize];
-	compress(compressedData, &compressedSize, (unsigned char*)stateData.c_str(), (unsigned long)stateData.size());
-	compressedState = vector<uint8_t>(compressedData, compressedData + compressedSize);
-	delete[] compressedData;
+	//Copy the raw state into a pooled buffer, the compressor's worker thread takes care of the rest
+	shared_ptr<vector<uint8_t>> stateData = compressor.GetBuffer();
+	size_t size = console->SaveState(stateData->data(), stateData->size());
+	if(size > stateData->size()) {
+		stateData->resize(size);
+		console->SaveState(stateData->data(), stateData->size());
+	} else {
+		stateData->resize(size);
+	}
+
+	SaveStateData.reset(new CompressedRewindState());
+	SaveStateData->OriginalSize = (uint32_t)size;
+
+	bool isDelta = previous && previous->SaveStateData && lastState && lastState->size() == size;
+	if(isDelta) {
+		SaveStateData->Previous = previous->SaveStateData;
+	}
+	compressor.AddTask(SaveStateData, stateData, isDelta ? lastState : nullptr);
+
+	lastState = stateData;
+	FrameCount = 0;
 }
 
-void RewindData::SaveState(shared_ptr<Console> &console)
+void RewindData::Merge(RewindData &nextBlock)
 {
-	std::stringstream state;
-	console->SaveState(state);
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		InputLogs[i].insert(InputLogs[i].end(), nextBlock.InputLogs[i].begin(), nextBlock.InputLogs[i].end());
+	}
+	FrameCount += nextBlock.FrameCount;
+	EndOfSegment = nextBlock.EndOfSegment;
+}
 
-	string stateData = state.str();
-	vector<uint8_t> compressedState;
-	CompressState(stateData, compressedState);
-	SaveStateData = compressedState;
-	OriginalSaveStateSize = (uint32_t)stateData.size();
-	FrameCount = 0;
+void RewindData::ConvertToKeyFrame(RewindCompressor &compressor, RewindData *nextBlock)
+{
+	if(SaveStateData && !IsKeyFrame()) {
+		shared_ptr<CompressedRewindState> dependent;
+		if(nextBlock && nextBlock->SaveStateData && std::atomic_load(&nextBlock->SaveStateData->Previous) == SaveStateData) {
+			dependent = nextBlock->SaveStateData;
+		}
+
+		shared_ptr<CompressedRewindState> keyFrame(new CompressedRewindState());
+		keyFrame->OriginalSize = SaveStateData->OriginalSize;
+		compressor.AddKeyFrameTask(keyFrame, SaveStateData, dependent);
+		SaveStateData = keyFrame;
+	}
 }
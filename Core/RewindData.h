@@ -4,22 +4,49 @@
 #include "BaseControlDevice.h"
 
 class Console;
+class RewindCompressor;
+
+struct CompressedRewindState
+{
+	vector<uint8_t> Data;
+	uint32_t OriginalSize = 0;
+
+	//Set once the background worker is done compressing the state
+	atomic<bool> Ready { false };
+
+	//For delta states, Data contains the state XORed with the previous state (null for key frames)
+	//Can be replaced by the compressor's worker thread (see ConvertToKeyFrame), use std::atomic_load/atomic_store to access it
+	shared_ptr<CompressedRewindState> Previous;
+};
 
 class RewindData
 {
 private:
-	vector<uint8_t> SaveStateData;
-	uint32_t OriginalSaveStateSize = 0;
-
-	void CompressState(string stateData, vector<uint8_t> &compressedState);
+	shared_ptr<CompressedRewindState> SaveStateData;
 
 public:
+	static bool GetStateData(CompressedRewindState* compressedState, vector<uint8_t> &stateData);
+
 	std::deque<ControlDeviceState> InputLogs[BaseControlDevice::PortCount];
 	int32_t FrameCount = 0;
 	bool EndOfSegment = false;
 
+	bool GetStateData(vector<uint8_t> &stateData);
 	void GetStateData(stringstream &stateData);
+	uint32_t GetCompressedSize();
+	bool IsKeyFrame();
 
 	void LoadState(shared_ptr<Console> &console);
-	void SaveState(shared_ptr<Console> &console);
+
+	//lastState must contain the uncompressed state of "previous" - it is replaced by the new state.
+	//When previous is null (or the state size changed), a full key frame is saved. Compression is done by the compressor's worker thread.
+	void SaveState(shared_ptr<Console> &console, RewindCompressor &compressor, shared_ptr<vector<uint8_t>> &lastState, RewindData *previous = nullptr);
+
+	//Appends the next block's input to this block (the next block's state is dropped)
+	void Merge(RewindData &nextBlock);
+
+	//Stores the state as a full state, so it no longer depends on the states it was a delta of.
+	//When nextBlock's state is a delta of this block's state, it is made to reference the key frame instead (once it is ready),
+	//otherwise it would keep the older states alive
+	void ConvertToKeyFrame(RewindCompressor &compressor, RewindData *nextBlock = nullptr);
 };
@@ -1,8 +1,11 @@
 #include "stdafx.h"
+#include <algorithm>
 #include "RewindManager.h"
 #include "MessageManager.h"
 #include "Console.h"
 #include "VideoRenderer.h"
+#include "VideoDecoder.h"
+#include "PPU.h"
 #include "SoundMixer.h"
 #include "BaseControlDevice.h"
 #include "HistoryViewer.h"
@@ -37,6 +40,7 @@ void RewindManager::ClearBuffer()
 	_history.clear();
 	_historyBackup.clear();
 	_currentHistory = RewindData();
+	_lastState.reset();
 	_framesToFastForward = 0;
 	_videoHistory.clear();
 	_videoHistoryBuilder.clear();
@@ -97,23 +101,94 @@ void RewindManager::ProcessNotification(ConsoleNotificationType type, void * par
 
 void RewindManager::AddHistoryBlock()
 {
-	uint32_t maxHistorySize = _settings->GetRewindBufferSize() * 120;	
-	if(maxHistorySize > 0) {
-		while(_history.size() > maxHistorySize) {
-			_history.pop_front();
-		}
-
+	if(_settings->GetRewindBufferSize() > 0) {
 		if(_currentHistory.FrameCount > 0) {
 			_history.push_back(_currentHistory);
 		}
+
+		if(_settings->GetRewindMemoryLimit() > 0) {
+			ThinHistory();
+		}
+		TrimHistory();
+
+		//Save a full key frame every few blocks, the states in between are stored as deltas against the previous state
+		bool useDelta = _settings->CheckFlag(EmulationFlags::RewindDeltaCompression) && _deltaCount < RewindManager::KeyFrameInterval;
+		RewindData previous = std::move(_currentHistory);
 		_currentHistory = RewindData();
-		_currentHistory.SaveState(_console);
+		_currentHistory.SaveState(_console, _compressor, _lastState, useDelta ? &previous : nullptr);
+		_deltaCount = _currentHistory.IsKeyFrame() ? 0 : _deltaCount + 1;
+	}
+}
+
+void RewindManager::ThinHistory()
+{
+	//Merge blocks together (dropping the newer block's state) until each block covers its tier's interval
+	uint32_t age = 0;
+	for(int i = (int)_history.size() - 1; i > 0; i--) {
+		age += _history[i].FrameCount;
+		if(age < RewindManager::DenseHistoryFrames) {
+			continue;
+		}
+
+		uint32_t interval = age < RewindManager::MediumHistoryFrames ? RewindManager::MediumHistoryInterval : RewindManager::OldHistoryInterval;
+		RewindData &block = _history[i - 1];
+		RewindData &nextBlock = _history[i];
+		if(!block.EndOfSegment && (uint32_t)(block.FrameCount + nextBlock.FrameCount) <= interval) {
+			//The merged block's frames are counted when the loop reaches it
+			age -= nextBlock.FrameCount;
+			block.Merge(nextBlock);
+			_history.erase(_history.begin() + i);
+
+			//The block that followed the dropped state may be a delta of it, store it as a key frame so the dropped state can be freed
+			if(i < (int)_history.size()) {
+				ConvertToKeyFrame(i);
+			}
+		}
+	}
+}
+
+void RewindManager::TrimHistory()
+{
+	uint64_t frameCount = 0;
+	uint64_t memoryUsage = 0;
+	for(RewindData &data : _history) {
+		frameCount += data.FrameCount;
+		memoryUsage += data.GetCompressedSize();
+	}
+
+	//Remove the oldest blocks until the history fits in both the time limit (in minutes) and the memory limit
+	uint64_t maxFrameCount = (uint64_t)_settings->GetRewindBufferSize() * 60 * 60;
+	uint64_t memoryLimit = _settings->GetRewindMemoryLimit();
+	bool trimmed = false;
+	while(_history.size() > 1 && (frameCount > maxFrameCount || (memoryLimit > 0 && memoryUsage > memoryLimit))) {
+		frameCount -= _history.front().FrameCount;
+		memoryUsage -= _history.front().GetCompressedSize();
+		_history.pop_front();
+		trimmed = true;
+	}
+
+	if(trimmed) {
+		//The new oldest block may be a delta of the removed blocks, which would keep them in memory
+		ConvertToKeyFrame(0);
+	}
+}
+
+void RewindManager::ConvertToKeyFrame(size_t index)
+{
+	if(index + 1 < _history.size()) {
+		_history[index].ConvertToKeyFrame(_compressor, &_history[index + 1]);
+	} else if(!_history[index].IsKeyFrame()) {
+		//The next state will be saved as a delta of this block's original state, save a key frame instead
+		_history[index].ConvertToKeyFrame(_compressor);
+		_deltaCount = RewindManager::KeyFrameInterval;
 	}
 }
 
 void RewindManager::PopHistory()
 {
-	if(_history.empty() && _currentHistory.FrameCount <= 0) {
+	//Blocks that were thinned out are too long to be rewound frame by frame, stop when reaching them
+	bool endOfHistory = _history.empty() || _history.back().FrameCount > RewindManager::BufferSize;
+	if(endOfHistory && _currentHistory.FrameCount <= 0) {
 		StopRewinding();
 	} else {
 		if(_currentHistory.FrameCount <= 0) {
@@ -123,6 +198,10 @@ void RewindManager::PopHistory()
 
 		_historyBackup.push_front(_currentHistory);
 		_currentHistory.LoadState(_console);
+
+		//The last saved state no longer matches the emulation's state, start over with a key frame
+		_lastState.reset();
+
 		if(!_audioHistoryBuilder.empty()) {
 			_audioHistory.insert(_audioHistory.begin(), _audioHistoryBuilder.begin(), _audioHistoryBuilder.end());
 			_audioHistoryBuilder.clear();
@@ -240,7 +319,7 @@ void RewindManager::ProcessEndOfFrame()
 	}
 }
 
-void RewindManager::ProcessFrame(void * frameBuffer, uint32_t width, uint32_t height, bool forRewind)
+void RewindManager::ProcessFrame(void * frameBuffer, uint32_t width, uint32_t height, uint16_t *ppuFrame, uint32_t frameNumber, bool forRewind)
 {
 	if(_rewindState == RewindState::Starting || _rewindState == RewindState::Started) {
 		if(!forRewind) {
@@ -250,11 +329,21 @@ void RewindManager::ProcessFrame(void * frameBuffer, uint32_t width, uint32_t he
 			return;
 		}
 
-		_videoHistoryBuilder.push_back(vector<uint32_t>((uint32_t*)frameBuffer, (uint32_t*)frameBuffer + width*height));
+		RewindVideoFrame frame;
+		if(ppuFrame && _settings->IsRewindRawVideoEnabled()) {
+			//Keep the PPU's output rather than the filtered frame (which can be several times larger, depending on the filter)
+			frame.PpuFrame.assign(ppuFrame, ppuFrame + PPU::PixelCount);
+			frame.FrameNumber = frameNumber;
+		} else {
+			frame.FilteredFrame.assign((uint32_t*)frameBuffer, (uint32_t*)frameBuffer + width*height);
+			frame.Width = width;
+			frame.Height = height;
+		}
+		_videoHistoryBuilder.push_back(std::move(frame));
 
 		if(_videoHistoryBuilder.size() == (size_t)_historyBackup.front().FrameCount) {
 			for(int i = (int)_videoHistoryBuilder.size() - 1; i >= 0; i--) {
-				_videoHistory.push_front(_videoHistoryBuilder[i]);
+				_videoHistory.push_front(std::move(_videoHistoryBuilder[i]));
 			}
 			_videoHistoryBuilder.clear();
 		}
@@ -263,7 +352,7 @@ void RewindManager::ProcessFrame(void * frameBuffer, uint32_t width, uint32_t he
 			_rewindState = RewindState::Started;
 			_settings->ClearFlags(EmulationFlags::ForceMaxSpeed);
 			if(!_videoHistory.empty()) {
-				_console->GetVideoRenderer()->UpdateFrame(_videoHistory.back().data(), width, height);
+				DisplayVideoFrame(_videoHistory.back());
 				_videoHistory.pop_back();
 			}
 		}
@@ -347,17 +436,15 @@ bool RewindManager::IsStepBack()
 void RewindManager::RewindSeconds(uint32_t seconds)
 {
 	if(_rewindState == RewindState::Stopped) {
-		uint32_t removeCount = (seconds * 60 / RewindManager::BufferSize) + 1;
+		int32_t framesToRemove = seconds * 60 + RewindManager::BufferSize;
 		_console->Pause();
-		for(uint32_t i = 0; i < removeCount; i++) {
-			if(!_history.empty()) {
-				_currentHistory = _history.back();
-				_history.pop_back();
-			} else {
-				break;
-			}
+		while(framesToRemove > 0 && !_history.empty()) {
+			_currentHistory = _history.back();
+			_history.pop_back();
+			framesToRemove -= _currentHistory.FrameCount;
 		}
 		_currentHistory.LoadState(_console);
+		_lastState.reset();
 		_console->Resume();
 	}
 }
@@ -367,14 +454,43 @@ bool RewindManager::HasHistory()
 	return _hasHistory;
 }
 
+RewindStatistics RewindManager::GetStatistics()
+{
+	RewindStatistics stats;
+	for(RewindData &data : _history) {
+		stats.MemoryUsage += data.GetCompressedSize();
+		stats.FrameCount += data.FrameCount;
+	}
+	stats.MemoryUsage += _currentHistory.GetCompressedSize();
+	stats.FrameCount += std::max(_currentHistory.FrameCount, 0);
+
+	if(stats.FrameCount > 0) {
+		stats.MemoryPerMinute = stats.MemoryUsage * 3600 / stats.FrameCount;
+	}
+	return stats;
+}
+
 void RewindManager::CopyHistory(shared_ptr<HistoryViewer> destHistoryViewer)
 {
 	destHistoryViewer->SetHistoryData(_history);
 }
 
-void RewindManager::SendFrame(void * frameBuffer, uint32_t width, uint32_t height, bool forRewind)
+void RewindManager::DisplayVideoFrame(RewindVideoFrame &frame)
+{
+	if(frame.PpuFrame.empty()) {
+		_console->GetVideoRenderer()->UpdateFrame(frame.FilteredFrame.data(), frame.Width, frame.Height);
+	} else {
+		FrameInfo frameInfo;
+		uint32_t* outputBuffer = _console->GetVideoDecoder()->FilterRewindFrame(frame.PpuFrame.data(), frame.FrameNumber, frameInfo);
+		if(outputBuffer) {
+			_console->GetVideoRenderer()->UpdateFrame(outputBuffer, frameInfo.Width, frameInfo.Height);
+		}
+	}
+}
+
+void RewindManager::SendFrame(void * frameBuffer, uint32_t width, uint32_t height, uint16_t *ppuFrame, uint32_t frameNumber, bool forRewind)
 {
-	ProcessFrame(frameBuffer, width, height, forRewind);
+	ProcessFrame(frameBuffer, width, height, ppuFrame, frameNumber, forRewind);
 }
 
 bool RewindManager::SendAudio(int16_t * soundBuffer, uint32_t sampleCount, uint32_t sampleRate)
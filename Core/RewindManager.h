@@ -3,6 +3,7 @@
 #include <deque>
 #include "INotificationListener.h"
 #include "RewindData.h"
+#include "RewindCompressor.h"
 #include "IInputProvider.h"
 #include "IInputRecorder.h"
 
@@ -18,10 +19,35 @@ enum class RewindState
 	Debugging = 4
 };
 
+struct RewindStatistics
+{
+	uint64_t MemoryUsage = 0;
+	uint64_t MemoryPerMinute = 0;
+	uint32_t FrameCount = 0;
+};
+
+//Frame kept while rewinding - either the raw PPU output (filtered again when displayed) or the final filtered frame
+struct RewindVideoFrame
+{
+	vector<uint16_t> PpuFrame;
+	uint32_t FrameNumber = 0;
+
+	vector<uint32_t> FilteredFrame;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+};
+
 class RewindManager : public INotificationListener, public IInputProvider, public IInputRecorder
 {
 private:
 	static constexpr int32_t BufferSize = 30; //Number of frames between each save state
+	static constexpr uint32_t KeyFrameInterval = 10; //Number of delta states between each full state (when delta compression is enabled)
+
+	//When a memory limit is set, history older than 1 minute keeps a state every 5 seconds, and history older than 10 minutes a state every 30 seconds
+	static constexpr uint32_t DenseHistoryFrames = 60 * 60;
+	static constexpr uint32_t MediumHistoryFrames = 60 * 60 * 10;
+	static constexpr uint32_t MediumHistoryInterval = 60 * 5;
+	static constexpr uint32_t OldHistoryInterval = 60 * 30;
 
 	shared_ptr<Console> _console;
 	EmulationSettings* _settings;
@@ -32,22 +58,31 @@ private:
 	std::deque<RewindData> _historyBackup;
 	RewindData _currentHistory;
 
+	//Uncompressed copy of the last saved state, used to build the next delta state
+	shared_ptr<vector<uint8_t>> _lastState;
+	RewindCompressor _compressor;
+	uint32_t _deltaCount = 0;
+
 	RewindState _rewindState;
 	int32_t _framesToFastForward;
 
-	std::deque<vector<uint32_t>> _videoHistory;
-	vector<vector<uint32_t>> _videoHistoryBuilder;
+	std::deque<RewindVideoFrame> _videoHistory;
+	vector<RewindVideoFrame> _videoHistoryBuilder;
 	std::deque<int16_t> _audioHistory;
 	vector<int16_t> _audioHistoryBuilder;
 
 	void AddHistoryBlock();
+	void ThinHistory();
+	void TrimHistory();
+	void ConvertToKeyFrame(size_t index);
 	void PopHistory();
 
 	void Start(bool forDebugger);
 	void Stop();
 	void ForceStop();
 
-	void ProcessFrame(void *frameBuffer, uint32_t width, uint32_t height, bool forRewind);
+	void ProcessFrame(void *frameBuffer, uint32_t width, uint32_t height, uint16_t *ppuFrame, uint32_t frameNumber, bool forRewind);
+	void DisplayVideoFrame(RewindVideoFrame &frame);
 	bool ProcessAudio(int16_t *soundBuffer, uint32_t sampleCount, uint32_t sampleRate);
 	
 	void ClearBuffer();
@@ -71,8 +106,9 @@ public:
 	void RewindSeconds(uint32_t seconds);
 
 	bool HasHistory();
+	RewindStatistics GetStatistics();
 	void CopyHistory(shared_ptr<HistoryViewer> destHistoryViewer);
 
-	void SendFrame(void *frameBuffer, uint32_t width, uint32_t height, bool forRewind);
+	void SendFrame(void *frameBuffer, uint32_t width, uint32_t height, uint16_t *ppuFrame, uint32_t frameNumber, bool forRewind);
 	bool SendAudio(int16_t *soundBuffer, uint32_t sampleCount, uint32_t sampleRate);
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "stdafx.h"
+#include <algorithm>
+#include "SaveStateContainer.h"
+#include "../Utilities/miniz.h"
+
+SaveStateContainer::SaveStateContainer(uint8_t* buffer, size_t capacity, uint32_t sectionCount)
+{
+	_buffer = buffer;
+	_capacity = buffer ? capacity : 0;
+	_sectionCount = sectionCount;
+	_sectionIndex = 0;
+
+	//The table of contents is filled as each section is added
+	_position = sizeof(uint32_t) + sizeof(SaveStateSectionInfo) * sectionCount;
+	if(_position <= _capacity) {
+		memcpy(_buffer, &sectionCount, sizeof(uint32_t));
+	}
+}
+
+uint8_t* SaveStateContainer::GetSectionBuffer()
+{
+	return _position < _capacity ? _buffer + _position : nullptr;
+}
+
+size_t SaveStateContainer::GetSectionCapacity()
+{
+	return _position < _capacity ? _capacity - _position : 0;
+}
+
+void SaveStateContainer::AddSection(SaveStateSection id, size_t size)
+{
+	if(_sectionIndex >= _sectionCount) {
+		throw std::runtime_error("Too many save state sections");
+	}
+
+	SaveStateSectionInfo section = { id, (uint32_t)_position, (uint32_t)size, 0 };
+	if(_position + size <= _capacity) {
+		section.Checksum = (uint32_t)mz_adler32(MZ_ADLER32_INIT, _buffer + _position, size);
+		memcpy(_buffer + sizeof(uint32_t) + sizeof(SaveStateSectionInfo) * _sectionIndex, &section, sizeof(section));
+	}
+
+	_position += size;
+	_sectionIndex++;
+}
+
+size_t SaveStateContainer::GetSize()
+{
+	return _position;
+}
+
+uint32_t SaveStateContainer::ReadTableOfContents(const uint8_t* buffer, size_t bufferSize, SaveStateSectionInfo sections[SaveStateContainer::MaxSectionCount])
+{
+	uint32_t sectionCount = 0;
+	if(bufferSize < sizeof(sectionCount)) {
+		return 0;
+	}
+
+	memcpy(&sectionCount, buffer, sizeof(sectionCount));
+	if(sectionCount > SaveStateContainer::MaxSectionCount || sizeof(sectionCount) + sizeof(SaveStateSectionInfo) * sectionCount > bufferSize) {
+		return 0;
+	}
+
+	memcpy(sections, buffer + sizeof(sectionCount), sizeof(SaveStateSectionInfo) * sectionCount);
+	for(uint32_t i = 0; i < sectionCount; i++) {
+		if((size_t)sections[i].Offset + sections[i].Size > bufferSize) {
+			//Truncated data
+			return 0;
+		}
+	}
+	return sectionCount;
+}
+
+uint32_t SaveStateContainer::ReadTableOfContents(istream &stream, SaveStateSectionInfo sections[SaveStateContainer::MaxSectionCount])
+{
+	//Measure what's left of the stream, the sections can't go past its end
+	std::streampos start = stream.tellg();
+	stream.seekg(0, std::ios::end);
+	std::streampos end = stream.tellg();
+	stream.seekg(start);
+	if(!stream || start < 0 || end < start) {
+		return 0;
+	}
+	uint64_t length = (uint64_t)(end - start);
+
+	uint32_t sectionCount = 0;
+	stream.read((char*)&sectionCount, sizeof(sectionCount));
+	if(!stream || sectionCount > SaveStateContainer::MaxSectionCount) {
+		return 0;
+	}
+
+	stream.read((char*)sections, sizeof(SaveStateSectionInfo) * sectionCount);
+	if(!stream) {
+		return 0;
+	}
+
+	for(uint32_t i = 0; i < sectionCount; i++) {
+		if((uint64_t)sections[i].Offset + sections[i].Size > length) {
+			//Truncated or corrupted data
+			return 0;
+		}
+	}
+	return sectionCount;
+}
+
+const SaveStateSectionInfo* SaveStateContainer::FindSection(SaveStateSectionInfo sections[], uint32_t sectionCount, SaveStateSection id)
+{
+	for(uint32_t i = 0; i < sectionCount; i++) {
+		if(sections[i].Id == id) {
+			return &sections[i];
+		}
+	}
+	return nullptr;
+}
+
+size_t SaveStateContainer::GetContainerSize(SaveStateSectionInfo sections[], uint32_t sectionCount)
+{
+	size_t size = sizeof(uint32_t) + sizeof(SaveStateSectionInfo) * sectionCount;
+	for(uint32_t i = 0; i < sectionCount; i++) {
+		size = std::max(size, (size_t)sections[i].Offset + sections[i].Size);
+	}
+	return size;
+}
+
+bool SaveStateContainer::ValidateChecksums(const uint8_t* buffer, size_t bufferSize)
+{
+	SaveStateSectionInfo sections[SaveStateContainer::MaxSectionCount];
+	uint32_t sectionCount = ReadTableOfContents(buffer, bufferSize, sections);
+	if(sectionCount == 0) {
+		return false;
+	}
+
+	for(uint32_t i = 0; i < sectionCount; i++) {
+		if((uint32_t)mz_adler32(MZ_ADLER32_INIT, buffer + sections[i].Offset, sections[i].Size) != sections[i].Checksum) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "stdafx.h"
+
+enum class SaveStateSection : uint32_t
+{
+	Cpu = 0,
+	Ppu = 1,
+	MemoryManager = 2,
+	Apu = 3,
+	ControlManager = 4,
+	Mapper = 5,
+	HdAudio = 6,
+	Slave = 7
+};
+
+struct SaveStateSectionInfo
+{
+	SaveStateSection Id;
+	uint32_t Offset; //From the start of the container
+	uint32_t Size;
+	uint32_t Checksum; //Adler-32 of the section's data
+};
+
+//Save state data (format version 14+): a table of contents followed by each section's data.
+//  uint32_t sectionCount
+//  SaveStateSectionInfo sections[sectionCount]
+//  section data
+//Each section contains a single component's snapshot (or the slave console's own container), so any section
+//can be read (or used in place, without copying it) by looking it up in the table of contents.
+class SaveStateContainer
+{
+private:
+	uint8_t* _buffer;
+	size_t _capacity;
+	size_t _position;
+	uint32_t _sectionCount;
+	uint32_t _sectionIndex;
+
+public:
+	static constexpr uint32_t MaxSectionCount = 16;
+
+	//Sections must then be written in order with GetSectionBuffer/GetSectionCapacity & AddSection.
+	//Like Console::SaveState, nothing is written past capacity, but the size needed is still calculated.
+	SaveStateContainer(uint8_t* buffer, size_t capacity, uint32_t sectionCount);
+
+	uint8_t* GetSectionBuffer();
+	size_t GetSectionCapacity();
+	void AddSection(SaveStateSection id, size_t size);
+
+	size_t GetSize();
+
+	//Returns the number of sections (0 if the data isn't a valid container or if a section goes past the end of the data)
+	static uint32_t ReadTableOfContents(const uint8_t* buffer, size_t bufferSize, SaveStateSectionInfo sections[SaveStateContainer::MaxSectionCount]);
+	static uint32_t ReadTableOfContents(istream &stream, SaveStateSectionInfo sections[SaveStateContainer::MaxSectionCount]);
+	static const SaveStateSectionInfo* FindSection(SaveStateSectionInfo sections[], uint32_t sectionCount, SaveStateSection id);
+	static size_t GetContainerSize(SaveStateSectionInfo sections[], uint32_t sectionCount);
+
+	static bool ValidateChecksums(const uint8_t* buffer, size_t bufferSize);
+};
@@ -16,7 +16,7 @@ private:
 	bool GetScreenshotData(vector<uint8_t>& out, istream& stream);
 
 public:
-	static constexpr uint32_t FileFormatVersion = 13;
+	static constexpr uint32_t FileFormatVersion = 14;
 
 	SaveStateManager(shared_ptr<Console> console);
 
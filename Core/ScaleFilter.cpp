@@ -1,6 +1,8 @@
 #include "stdafx.h"
+#include <algorithm>
 #include "PPU.h"
 #include "ScaleFilter.h"
+#include "WorkerPool.h"
 #include "../Utilities/xBRZ/xbrz.h"
 #include "../Utilities/HQX/hqx.h"
 #include "../Utilities/Scale2x/scalebit.h"
@@ -31,11 +33,12 @@ uint32_t ScaleFilter::GetScale()
 	return _filterScale;
 }
 
-void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer)
+void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast)
 {
-	uint32_t* outputBuffer = _outputBuffer;
+	uint32_t* outputBuffer = _outputBuffer + yFirst * _width * _filterScale * _filterScale;
+	inputArgbBuffer += yFirst * _width;
 
-	for(uint32_t y = 0; y < _height; y++) {
+	for(uint32_t y = yFirst; y < yLast; y++) {
 		for(uint32_t x = 0; x < _width; x++) {
 			for(uint32_t i = 0; i < _filterScale; i++) {
 				*(outputBuffer++) = *inputArgbBuffer;
@@ -62,40 +65,80 @@ void ScaleFilter::UpdateOutputBuffer(uint32_t width, uint32_t height)
 	}
 }
 
-uint32_t* ScaleFilter::ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, double scanlineIntensity)
+void ScaleFilter::ApplyFilterToImage(uint32_t *inputArgbBuffer, uint32_t *outputBuffer, uint32_t width, uint32_t height)
 {
-	UpdateOutputBuffer(width, height);
-
-	if(_scaleFilterType == ScaleFilterType::xBRZ) {
-		xbrz::scale(_filterScale, inputArgbBuffer, _outputBuffer, width, height, xbrz::ColorFormat::ARGB);
-	} else if(_scaleFilterType == ScaleFilterType::HQX) {
-		hqx(_filterScale, inputArgbBuffer, _outputBuffer, width, height);
+	if(_scaleFilterType == ScaleFilterType::HQX) {
+		hqx(_filterScale, inputArgbBuffer, outputBuffer, width, height);
 	} else if(_scaleFilterType == ScaleFilterType::Scale2x) {
-		scale(_filterScale, _outputBuffer, width*sizeof(uint32_t)*_filterScale, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height);
+		scale(_filterScale, outputBuffer, width*sizeof(uint32_t)*_filterScale, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height);
 	} else if(_scaleFilterType == ScaleFilterType::_2xSai) {
-		twoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		twoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, outputBuffer, width * _filterScale);
 	} else if(_scaleFilterType == ScaleFilterType::Super2xSai) {
-		supertwoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		supertwoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, outputBuffer, width * _filterScale);
 	} else if(_scaleFilterType == ScaleFilterType::SuperEagle) {
-		supereagle_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		supereagle_generic_xrgb8888(width, height, inputArgbBuffer, width, outputBuffer, width * _filterScale);
+	}
+}
+
+void ScaleFilter::ApplyFilterToBand(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, uint32_t yFirst, uint32_t yLast, uint32_t band, uint32_t bandCount)
+{
+	if(_scaleFilterType == ScaleFilterType::xBRZ) {
+		//xBRZ supports scaling a slice of the image directly
+		xbrz::scale(_filterScale, inputArgbBuffer, _outputBuffer, width, height, xbrz::ColorFormat::ARGB, xbrz::ScalerCfg(), yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::Prescale) {
-		ApplyPrescaleFilter(inputArgbBuffer);
+		ApplyPrescaleFilter(inputArgbBuffer, yFirst, yLast);
+	} else if(bandCount == 1) {
+		ApplyFilterToImage(inputArgbBuffer, _outputBuffer, width, height);
+	} else {
+		//The band is scaled along with a few rows above/below it (so its edges see the same neighbors as in the full image)
+		//in its own buffer, and only the band's own rows are then copied to the output
+		uint32_t srcFirst = yFirst > OverlapRows ? yFirst - OverlapRows : 0;
+		uint32_t srcLast = std::min(height, yLast + OverlapRows);
+		uint32_t rowSize = width * _filterScale * _filterScale;
+
+		vector<uint32_t> &bandBuffer = _bandBuffers[band];
+		bandBuffer.resize((srcLast - srcFirst) * rowSize);
+		ApplyFilterToImage(inputArgbBuffer + srcFirst * width, bandBuffer.data(), width, srcLast - srcFirst);
+		memcpy(_outputBuffer + yFirst * rowSize, bandBuffer.data() + (yFirst - srcFirst) * rowSize, (yLast - yFirst) * rowSize * sizeof(uint32_t));
+	}
+}
+
+void ScaleFilter::ApplyScanlineEffect(uint32_t width, uint32_t yFirst, uint32_t yLast, double scanlineIntensity)
+{
+	//Darkens the odd rows of the output, within the given (scaled) rows
+	for(int y = yFirst | 1, yMax = yLast; y < yMax; y += 2) {
+		for(int x = 0, xMax = width * _filterScale; x < xMax; x++) {
+			uint32_t &color = _outputBuffer[y*xMax + x];
+			uint8_t r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
+			r = (uint8_t)(r * scanlineIntensity);
+			g = (uint8_t)(g * scanlineIntensity);
+			b = (uint8_t)(b * scanlineIntensity);
+			color = 0xFF000000 | (r << 16) | (g << 8) | b;
+		}
+	}
+}
+
+uint32_t* ScaleFilter::ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, double scanlineIntensity, uint32_t threadCount)
+{
+	UpdateOutputBuffer(width, height);
+
+	shared_ptr<WorkerPool> pool = WorkerPool::GetVideoFilterPool(threadCount);
+	uint32_t bandCount = std::max<uint32_t>(1, std::min<uint32_t>(pool->GetThreadCount(), height / ScaleFilter::MinBandHeight));
+	if(_bandBuffers.size() < bandCount) {
+		_bandBuffers.resize(bandCount);
 	}
 
 	scanlineIntensity = 1.0 - scanlineIntensity;
 
-	if(scanlineIntensity < 1.0) {
-		for(int y = 1, yMax = height * _filterScale; y < yMax; y += 2) {
-			for(int x = 0, xMax = width * _filterScale; x < xMax; x++) {
-				uint32_t &color = _outputBuffer[y*xMax + x];
-				uint8_t r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
-				r = (uint8_t)(r * scanlineIntensity);
-				g = (uint8_t)(g * scanlineIntensity);
-				b = (uint8_t)(b * scanlineIntensity);
-				color = 0xFF000000 | (r << 16) | (g << 8) | b;
-			}
+	pool->Run(bandCount, [=](uint32_t band) {
+		uint32_t yFirst = height * band / bandCount;
+		uint32_t yLast = height * (band + 1) / bandCount;
+		ApplyFilterToBand(inputArgbBuffer, width, height, yFirst, yLast, band, bandCount);
+
+		if(scanlineIntensity < 1.0) {
+			ApplyScanlineEffect(width, yFirst * _filterScale, yLast * _filterScale, scanlineIntensity);
 		}
-	}
+	});
 
 	return _outputBuffer;
 }
@@ -12,8 +12,18 @@ private:
 	uint32_t *_outputBuffer = nullptr;
 	uint32_t _width = 0;
 	uint32_t _height = 0;
+	vector<vector<uint32_t>> _bandBuffers;
 
-	void ApplyPrescaleFilter(uint32_t *inputArgbBuffer);
+	//Smallest band processed by a thread - xBRZ recommends at least 8-16 rows, and the other filters need extra overlap rows
+	static constexpr uint32_t MinBandHeight = 16;
+
+	//Number of extra rows above/below a band needed by the filters that can't process a range of rows (HQx, ScaleNx, 2xSaI/SuperEagle)
+	static constexpr uint32_t OverlapRows = 2;
+
+	void ApplyPrescaleFilter(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast);
+	void ApplyFilterToImage(uint32_t *inputArgbBuffer, uint32_t *outputBuffer, uint32_t width, uint32_t height);
+	void ApplyFilterToBand(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, uint32_t yFirst, uint32_t yLast, uint32_t band, uint32_t bandCount);
+	void ApplyScanlineEffect(uint32_t width, uint32_t yFirst, uint32_t yLast, double scanlineIntensity);
 	void UpdateOutputBuffer(uint32_t width, uint32_t height);
 
 public:
@@ -21,7 +31,8 @@ public:
 	~ScaleFilter();
 
 	uint32_t GetScale();
-	uint32_t* ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, double scanlineIntensity);
+	//The image is split into horizontal bands that are processed in parallel by the video filter worker pool
+	uint32_t* ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, double scanlineIntensity, uint32_t threadCount);
 	FrameInfo GetFrameInfo(FrameInfo baseFrameInfo);
 
 	static shared_ptr<ScaleFilter> GetScaleFilter(VideoFilterType filter);
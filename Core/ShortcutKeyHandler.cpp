@@ -120,7 +120,7 @@ void ShortcutKeyHandler::CheckMappedKeys()
 {
 	EmulationSettings* settings = _console->GetSettings();
 	bool isNetplayClient = GameClient::Connected();
-	bool isMovieActive = MovieManager::Playing() || MovieManager::Recording();
+	bool isMovieActive = _console->GetMovieManager()->Playing() || _console->GetMovieManager()->Recording();
 
 	_keyboardMode = false;
 	if(DetectKeyPress(EmulatorShortcut::ToggleKeyboardMode)) {
@@ -158,7 +158,7 @@ void ShortcutKeyHandler::CheckMappedKeys()
 	}
 
 	shared_ptr<VsSystemActionManager> vsSam = _console->GetSystemActionManager<VsSystemActionManager>();
-	if(vsSam && !isNetplayClient && !MovieManager::Playing()) {
+	if(vsSam && !isNetplayClient && !_console->GetMovieManager()->Playing()) {
 		if(DetectKeyPress(EmulatorShortcut::VsServiceButton)) {
 			vsSam->SetServiceButtonState(0, true);
 		}
@@ -173,7 +173,7 @@ void ShortcutKeyHandler::CheckMappedKeys()
 		}
 	}
 
-	if(DetectKeyPress(EmulatorShortcut::InsertNextDisk) && !isNetplayClient && !MovieManager::Playing()) {
+	if(DetectKeyPress(EmulatorShortcut::InsertNextDisk) && !isNetplayClient && !_console->GetMovieManager()->Playing()) {
 		shared_ptr<FdsSystemActionManager> sam = _console->GetSystemActionManager<FdsSystemActionManager>();
 		if(sam) {
 			sam->InsertNextDisk();
@@ -219,7 +219,7 @@ void ShortcutKeyHandler::CheckMappedKeys()
 		_repeatStarted = false;
 	}
 
-	if(!isNetplayClient && !MovieManager::Recording()) {
+	if(!isNetplayClient && !_console->GetMovieManager()->Recording()) {
 		shared_ptr<RewindManager> rewindManager = _console->GetRewindManager();
 		if(rewindManager) {
 			if(DetectKeyPress(EmulatorShortcut::ToggleRewind)) {
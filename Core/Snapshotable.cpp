@@ -10,14 +10,19 @@ void Snapshotable::StreamStartBlock()
 	}
 
 	if(!_saving) {
-		InternalStream(_blockSize);
-		_blockSize = std::min(_blockSize, (uint32_t)0xFFFFF);
-		_blockBuffer = new uint8_t[_blockSize];
-		ArrayInfo<uint8_t> arrayInfo = { _blockBuffer, _blockSize };
-		InternalStream(arrayInfo);
+		uint32_t blockSize = 0;
+		uint32_t elementCount = 0;
+		StreamElement<uint32_t>(blockSize);
+		StreamElement<uint32_t>(elementCount);
+
+		_blockSize = std::min(std::min(blockSize, (uint32_t)0xFFFFF), elementCount);
+		_blockSize = std::min(_blockSize, _streamSize - _position);
+		_blockBuffer = _stream + _position;
+		_position += _blockSize;
 	} else {
-		_blockSize = 0x100;
-		_blockBuffer = new uint8_t[_blockSize];
+		//Block size & element count are written once the block is complete
+		_blockStart = _position;
+		WriteBytes(nullptr, sizeof(uint32_t) * 2);
 	}
 	_blockPosition = 0;
 	_inBlock = true;
@@ -27,83 +32,154 @@ void Snapshotable::StreamEndBlock()
 {
 	_inBlock = false;
 	if(_saving) {
-		InternalStream(_blockPosition);
-		ArrayInfo<uint8_t> arrayInfo = { _blockBuffer, _blockPosition };
-		InternalStream(arrayInfo);
+		uint32_t blockSize = _position - _blockStart - sizeof(uint32_t) * 2;
+		WriteValueAt(_blockStart, blockSize);
+		WriteValueAt(_blockStart + sizeof(uint32_t), blockSize);
 	}
 
-	delete[] _blockBuffer;
 	_blockBuffer = nullptr;
 }
 
 void Snapshotable::Stream(Snapshotable* snapshotable)
 {
-	stringstream stream;
 	if(_saving) {
-		snapshotable->SaveSnapshot(&stream);
-		uint32_t size = (uint32_t)stream.tellp();
-		stream.seekg(0, ios::beg);
-		stream.seekp(0, ios::beg);
-
-		uint8_t *buffer = new uint8_t[size];
-		stream.read((char*)buffer, size);
-		InternalStream(size);
-		ArrayInfo<uint8_t> arrayInfo = { buffer, size };
-		InternalStream(arrayInfo);
-		delete[] buffer;
+		//The entity writes its data directly into this stream, the size & element count are written once it is done
+		uint32_t start = _position;
+		WriteBytes(nullptr, sizeof(uint32_t) * 2);
+
+		snapshotable->_stream = _stream;
+		snapshotable->_streamSize = _streamSize;
+		snapshotable->_position = _position;
+		snapshotable->_growable = _growable;
+		snapshotable->_hasher = _hasher;
+		snapshotable->SaveSnapshotData();
+
+		_stream = snapshotable->_stream;
+		_streamSize = snapshotable->_streamSize;
+		_position = snapshotable->_position;
+		snapshotable->_stream = nullptr;
+		snapshotable->_hasher = nullptr;
+
+		uint32_t size = _position - start - sizeof(uint32_t) * 2;
+		WriteValueAt(start, size);
+		WriteValueAt(start + sizeof(uint32_t), size);
 	} else {
 		uint32_t size = 0;
-		InternalStream(size);
-
-		uint8_t *buffer = new uint8_t[size];
-		ArrayInfo<uint8_t> arrayInfo = { buffer, size };
-		InternalStream(arrayInfo);
-
-		stream.write((char*)buffer, size);
-		stream.seekg(0, ios::beg);
-		stream.seekp(0, ios::beg);
-		snapshotable->LoadSnapshot(&stream, _stateVersion);
-		delete[] buffer;
+		uint32_t elementCount = 0;
+		StreamElement<uint32_t>(size);
+		StreamElement<uint32_t>(elementCount);
+		size = std::min(size, elementCount);
+
+		if(_inBlock) {
+			size = std::min(size, _blockSize - _blockPosition);
+			snapshotable->LoadSnapshot(_blockBuffer + _blockPosition, size, _stateVersion);
+			_blockPosition += size;
+		} else {
+			size = std::min(size, _streamSize - _position);
+			snapshotable->LoadSnapshot(_stream + _position, size, _stateVersion);
+			_position += size;
+		}
 	}
 }
 
-void Snapshotable::SaveSnapshot(ostream* file)
+void Snapshotable::SaveSnapshotData()
 {
 	_stateVersion = SaveStateManager::FileFormatVersion;
-
-	_streamSize = 0x1000;
-	_stream = new uint8_t[_streamSize];
-	_position = 0;
 	_saving = true;
 
+	uint32_t start = _position;
+	WriteBytes(nullptr, sizeof(uint32_t));
 	StreamState(_saving);
-	file->write((char*)&_position, sizeof(_position));
-	file->write((char*)_stream, _position);
-
-	delete[] _stream;
+	WriteValueAt(start, _position - start - sizeof(uint32_t));
 
-	if(_blockBuffer) {
+	if(_inBlock) {
 		throw new std::runtime_error("A call to StreamEndBlock is missing.");
 	}
 }
 
-void Snapshotable::LoadSnapshot(istream* file, uint32_t stateVersion)
+void Snapshotable::LoadSnapshotData(const uint8_t* data, uint32_t dataSize, uint32_t stateVersion)
 {
 	_stateVersion = stateVersion;
-
-	_position = 0;
 	_saving = false;
 
-	file->read((char*)&_streamSize, sizeof(_streamSize));
-	_stream = new uint8_t[_streamSize];
-	file->read((char*)_stream, _streamSize);
+	//Loading never writes to the stream
+	_stream = (uint8_t*)data;
+	_streamSize = dataSize;
+	_position = 0;
 	StreamState(_saving);
+	_stream = nullptr;
+
+	if(_inBlock) {
+		throw new std::runtime_error("A call to StreamEndBlock is missing.");
+	}
+}
+
+void Snapshotable::SaveSnapshot(ostream* file)
+{
+	_streamSize = _lastSnapshotSize;
+	_stream = _streamSize ? new uint8_t[_streamSize] : nullptr;
+	_position = 0;
+	_growable = true;
+
+	SaveSnapshotData();
+	file->write((char*)_stream, _position);
+	_lastSnapshotSize = _position;
 
 	delete[] _stream;
+	_stream = nullptr;
+	_growable = false;
+}
 
-	if(_blockBuffer) {
-		throw new std::runtime_error("A call to StreamEndBlock is missing.");
+void Snapshotable::LoadSnapshot(istream* file, uint32_t stateVersion)
+{
+	uint32_t size = 0;
+	file->read((char*)&size, sizeof(size));
+	uint8_t* data = new uint8_t[size];
+	file->read((char*)data, size);
+
+	LoadSnapshotData(data, size, stateVersion);
+
+	delete[] data;
+}
+
+uint32_t Snapshotable::SaveSnapshot(uint8_t* buffer, uint32_t capacity)
+{
+	_stream = buffer;
+	_streamSize = buffer ? capacity : 0;
+	_position = 0;
+	_growable = false;
+
+	SaveSnapshotData();
+
+	_stream = nullptr;
+	return _position;
+}
+
+uint32_t Snapshotable::LoadSnapshot(const uint8_t* buffer, uint32_t bufferSize, uint32_t stateVersion)
+{
+	uint32_t size = 0;
+	if(bufferSize < sizeof(size)) {
+		LoadSnapshotData(nullptr, 0, stateVersion);
+		return bufferSize;
 	}
+
+	memcpy(&size, buffer, sizeof(size));
+	size = std::min(size, bufferSize - (uint32_t)sizeof(size));
+	LoadSnapshotData(buffer + sizeof(size), size, stateVersion);
+	return sizeof(size) + size;
+}
+
+void Snapshotable::HashSnapshot(StateHasher &hasher)
+{
+	_stream = nullptr;
+	_streamSize = 0;
+	_position = 0;
+	_growable = false;
+	_hasher = &hasher;
+
+	SaveSnapshotData();
+
+	_hasher = nullptr;
 }
 
 void Snapshotable::WriteEmptyBlock(ostream* file)
@@ -117,4 +193,22 @@ void Snapshotable::SkipBlock(istream* file)
 	int blockSize = 0;
 	file->read((char*)&blockSize, sizeof(blockSize));
 	file->seekg(blockSize, ios::cur);
-}
\ No newline at end of file
+}
+
+uint32_t Snapshotable::WriteEmptyBlock(uint8_t* buffer, uint32_t capacity)
+{
+	uint32_t blockSize = 0;
+	if(buffer && capacity >= sizeof(blockSize)) {
+		memcpy(buffer, &blockSize, sizeof(blockSize));
+	}
+	return sizeof(blockSize);
+}
+
+uint32_t Snapshotable::SkipBlock(const uint8_t* buffer, uint32_t bufferSize)
+{
+	uint32_t blockSize = 0;
+	if(bufferSize >= sizeof(blockSize)) {
+		memcpy(&blockSize, buffer, sizeof(blockSize));
+	}
+	return std::min(bufferSize, (uint32_t)sizeof(blockSize) + blockSize);
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "stdafx.h"
+#include <algorithm>
+#include "StateHasher.h"
 
 class Snapshotable;
 
@@ -38,12 +40,24 @@ struct EmptyInfo
 class Snapshotable
 {
 private:
-	uint8_t* _stream;
-	uint32_t _position;
-	uint32_t _streamSize;
+	uint8_t* _stream = nullptr;
+	uint32_t _position = 0;
+	uint32_t _streamSize = 0;
 	uint32_t _stateVersion = 0;
 
+	//When saving into a caller-provided buffer, the stream can't grow - writes that don't fit are skipped but still counted
+	bool _growable = false;
+
+	//Size of the last stream-based save, used to allocate the whole buffer up front on the next save
+	uint32_t _lastSnapshotSize = 0;
+
+	//When set, the data that would be saved is added to the hash instead
+	StateHasher* _hasher = nullptr;
+
 	bool _inBlock = false;
+	uint32_t _blockStart = 0;
+
+	//When loading, blocks are read in place from the stream
 	uint8_t* _blockBuffer = nullptr;
 	uint32_t _blockSize = 0;
 	uint32_t _blockPosition = 0;
@@ -51,61 +65,59 @@ private:
 	bool _saving;
 
 private:
-	void EnsureCapacity(uint32_t typeSize)
+	bool EnsureCapacity(uint32_t typeSize)
 	{
-		//Make sure the current block/stream is large enough to fit the next write
-		uint32_t oldSize;
-		uint32_t sizeRequired;
-		uint8_t *oldBuffer;
-		if(_inBlock) {
-			oldBuffer = _blockBuffer;
-			oldSize = _blockSize;
-			sizeRequired = _blockPosition + typeSize;
-		} else {
-			oldBuffer = _stream;
-			oldSize = _streamSize;
-			sizeRequired = _position + typeSize;
+		//Make sure the stream is large enough to fit the next write
+		uint32_t sizeRequired = _position + typeSize;
+		if(sizeRequired <= _streamSize) {
+			return true;
+		} else if(!_growable) {
+			return false;
 		}
 
-		uint8_t *newBuffer = nullptr;
-		uint32_t newSize = oldSize * 2;
-		if(oldSize < sizeRequired) {
-			while(newSize < sizeRequired) {
-				newSize *= 2;
-			}
-
-			newBuffer = new uint8_t[newSize];
-			memcpy(newBuffer, oldBuffer, oldSize);
-			delete[] oldBuffer;
+		uint32_t newSize = _streamSize ? _streamSize * 2 : 0x1000;
+		while(newSize < sizeRequired) {
+			newSize *= 2;
 		}
-		
-		if(newBuffer) {
-			if(_inBlock) {
-				_blockBuffer = newBuffer;
-				_blockSize = newSize;
+
+		uint8_t *newBuffer = new uint8_t[newSize];
+		memcpy(newBuffer, _stream, _position);
+		delete[] _stream;
+
+		_stream = newBuffer;
+		_streamSize = newSize;
+		return true;
+	}
+
+	void WriteBytes(const void* source, uint32_t size)
+	{
+		if(_hasher) {
+			//Block sizes are written as placeholders (null source) and are not part of the hash
+			if(source) {
+				_hasher->Update(source, size);
+			}
+		} else if(EnsureCapacity(size)) {
+			if(source) {
+				memcpy(_stream + _position, source, size);
 			} else {
-				_stream = newBuffer;
-				_streamSize = newSize;
+				memset(_stream + _position, 0, size);
 			}
 		}
+		_position += size;
+	}
+
+	void WriteValueAt(uint32_t position, uint32_t value)
+	{
+		if(position + sizeof(value) <= _streamSize) {
+			memcpy(_stream + position, &value, sizeof(value));
+		}
 	}
 
 	template<typename T>
 	void StreamElement(T &value, T defaultValue = T())
 	{
 		if(_saving) {
-			uint8_t* bytes = (uint8_t*)&value;
-			int typeSize = sizeof(T);
-
-			EnsureCapacity(typeSize);
-
-			for(int i = 0; i < typeSize; i++) {
-				if(_inBlock) {
-					_blockBuffer[_blockPosition++] = bytes[i];
-				} else {
-					_stream[_position++] = bytes[i];
-				}
-			}
+			WriteBytes(&value, sizeof(T));
 		} else {
 			if(_inBlock) {
 				if(_blockPosition + sizeof(T) <= _blockSize) {
@@ -130,7 +142,9 @@ private:
 	template<typename T>
 	void InternalStream(EmptyInfo<T> &info)
 	{
-		if(_inBlock) {
+		if(_saving) {
+			WriteBytes(nullptr, sizeof(T));
+		} else if(_inBlock) {
 			_blockPosition += sizeof(T);
 		} else {
 			_position += sizeof(T);
@@ -138,10 +152,31 @@ private:
 	}
 
 	template<typename T>
-	void InternalStream(ArrayInfo<T> &info)
+	void StreamArray(T* array, uint32_t elementCount)
 	{
-		T* pointer = info.Array;
+		//Copies the whole array with a single memcpy rather than going through StreamElement for every element
+		uint32_t size = sizeof(T) * elementCount;
+		if(_saving) {
+			WriteBytes(array, size);
+			return;
+		}
 
+		uint8_t* source = _inBlock ? _blockBuffer : _stream;
+		uint32_t &position = _inBlock ? _blockPosition : _position;
+		uint32_t available = (_inBlock ? _blockSize : _streamSize) - position;
+		if(size <= available) {
+			memcpy(array, source + position, size);
+			position += size;
+		} else {
+			//Only load the elements that are complete, the remaining ones are left to their default value (0)
+			memcpy(array, source + position, available / sizeof(T) * sizeof(T));
+			position += available;
+		}
+	}
+
+	template<typename T>
+	void InternalStream(ArrayInfo<T> &info)
+	{
 		uint32_t count = info.ElementCount;
 		StreamElement<uint32_t>(count);
 
@@ -151,10 +186,7 @@ private:
 		}
 
 		//Load the number of elements requested, or the maximum possible (based on what is present in the save state)
-		for(uint32_t i = 0; i < info.ElementCount && i < count; i++) {
-			StreamElement<T>(*pointer);
-			pointer++;
-		}
+		StreamArray(info.Array, std::min(info.ElementCount, count));
 	}
 
 	template<typename T>
@@ -171,11 +203,7 @@ private:
 		}
 
 		//Load the number of elements requested
-		T* pointer = vector->data();
-		for(uint32_t i = 0; i < count; i++) {
-			StreamElement<T>(*pointer);
-			pointer++;
-		}
+		StreamArray(vector->data(), count);
 	}
 
 	template<typename T>
@@ -211,6 +239,9 @@ private:
 	void StreamStartBlock();
 	void StreamEndBlock();
 
+	void SaveSnapshotData();
+	void LoadSnapshotData(const uint8_t* data, uint32_t dataSize, uint32_t stateVersion);
+
 protected:
 	virtual void StreamState(bool saving) = 0;
 
@@ -232,6 +263,16 @@ public:
 	void SaveSnapshot(ostream* file);
 	void LoadSnapshot(istream* file, uint32_t stateVersion);
 
+	//Saves/loads the same data as the stream-based functions without allocating, returns the number of bytes used.
+	//When saving, the data is only valid if the returned size is <= capacity (use a null buffer to get the size needed)
+	uint32_t SaveSnapshot(uint8_t* buffer, uint32_t capacity);
+	uint32_t LoadSnapshot(const uint8_t* buffer, uint32_t bufferSize, uint32_t stateVersion);
+
+	//Adds the data that would be saved to the hash, without writing (or allocating) anything
+	void HashSnapshot(StateHasher &hasher);
+
 	static void WriteEmptyBlock(ostream* file);
 	static void SkipBlock(istream* file);
+	static uint32_t WriteEmptyBlock(uint8_t* buffer, uint32_t capacity);
+	static uint32_t SkipBlock(const uint8_t* buffer, uint32_t bufferSize);
 };
\ No newline at end of file
@@ -101,6 +101,11 @@ void SoundMixer::Reset()
 
 void SoundMixer::PlayAudioBuffer(uint32_t time)
 {
+	if(!_console->IsAudioEnabled()) {
+		DiscardFrame();
+		return;
+	}
+
 	UpdateTargetSampleRate();
 	EndFrame(time);
 
@@ -184,7 +189,8 @@ void SoundMixer::PlayAudioBuffer(uint32_t time)
 		}
 	}
 
-	if(_settings->NeedAudioSettingsUpdate()) {
+	//The run-ahead shadow console shares the settings, only the main console's mixer may clear their "changed" flag
+	if(!_console->IsRunAheadConsole() && _settings->NeedAudioSettingsUpdate()) {
 		if(_settings->GetSampleRate() != _sampleRate) {
 			//Update sample rate for next frame if setting changed
 			_sampleRate = _settings->GetSampleRate();
@@ -322,6 +328,18 @@ void SoundMixer::EndFrame(uint32_t time)
 	memset(_channelOutput, 0, sizeof(_channelOutput));
 }
 
+void SoundMixer::DiscardFrame()
+{
+	//Used when audio output is disabled (headless runs): keep the channel levels up to date, but skip mixing/resampling/filtering
+	for(uint32_t stamp : _timestamps) {
+		for(uint32_t j = 0; j < MaxChannelCount; j++) {
+			_currentOutput[j] += _channelOutput[j][stamp];
+			_channelOutput[j][stamp] = 0;
+		}
+	}
+	_timestamps.clear();
+}
+
 void SoundMixer::ApplyEqualizer(orfanidis_eq::eq1* equalizer, size_t sampleCount)
 {
 	if(equalizer) {
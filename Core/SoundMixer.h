@@ -78,6 +78,7 @@ private:
 	double GetChannelOutput(AudioChannel channel, bool forRightChannel);
 	int16_t GetOutputVolume(bool forRightChannel);
 	void EndFrame(uint32_t time);
+	void DiscardFrame();
 
 	void UpdateRates(bool forceUpdate);
 	
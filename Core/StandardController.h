@@ -124,7 +124,7 @@ public:
 			_stateBuffer |= 0x80000000;
 		}
 
-		if(addr == 0x4016 && IsPressed(StandardController::Buttons::Microphone)) {
+		if(addr == 0x4016 && _microphoneEnabled && IsPressed(StandardController::Buttons::Microphone)) {
 			output |= 0x04;
 		}
 
@@ -0,0 +1,52 @@
+#pragma once
+#include "stdafx.h"
+
+//Fast non-cryptographic 64-bit hash, used to compare emulation states between runs.
+//The result depends on how the data is split between Update calls and is not meant to be stored across versions.
+class StateHasher
+{
+private:
+	uint64_t _hash = 0x9E3779B97F4A7C15;
+
+	void Mix(uint64_t value)
+	{
+		_hash = (_hash ^ value) * 0xFF51AFD7ED558CCD;
+		_hash ^= _hash >> 29;
+	}
+
+public:
+	void Update(const void* data, size_t size)
+	{
+		const uint8_t* bytes = (const uint8_t*)data;
+		size_t i = 0;
+		for(; i + 8 <= size; i += 8) {
+			uint64_t value;
+			memcpy(&value, bytes + i, sizeof(value));
+			Mix(value);
+		}
+
+		//Remaining bytes are packed along with the length, so trailing zeroes change the hash
+		uint64_t tail = (uint64_t)size << 56;
+		for(size_t shift = 0; i < size; i++, shift += 8) {
+			tail |= (uint64_t)bytes[i] << shift;
+		}
+		Mix(tail);
+	}
+
+	void Update(uint64_t value)
+	{
+		Mix(value);
+	}
+
+	uint64_t GetHash()
+	{
+		//Final avalanche (from MurmurHash3's fmix64)
+		uint64_t hash = _hash;
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCD;
+		hash ^= hash >> 33;
+		hash *= 0xC4CEB9FE1A85EC53;
+		hash ^= hash >> 33;
+		return hash;
+	}
+};
@@ -51,6 +51,7 @@ public:
 	{
 		if(!_needReset) {
 			_needReset = true;
+			_console->InvalidateRunAhead();
 			return true;
 		}
 		return false;
@@ -60,6 +61,7 @@ public:
 	{
 		if(!_needPowerCycle) {
 			_needPowerCycle = true;
+			_console->InvalidateRunAhead();
 			return true;
 		}
 		return false;
@@ -12,7 +12,7 @@
 #include "../Utilities/HexUtilities.h"
 #include "../Utilities/FolderUtilities.h"
 
-string TraceLogger::_executionTrace = "";
+thread_local string TraceLogger::_executionTrace = "";
 
 TraceLogger::TraceLogger(Debugger* debugger, shared_ptr<MemoryManager> memoryManager, shared_ptr<LabelManager> labelManager)
 {
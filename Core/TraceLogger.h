@@ -55,7 +55,8 @@ private:
 	static constexpr int ExecutionLogSize = 30000;
 
 	//Must be static to be thread-safe when switching game
-	static string _executionTrace;
+	//Thread-local so that debuggers of different consoles (queried from different threads) don't share the same buffer
+	thread_local static string _executionTrace;
 	
 	TraceLoggerOptions _options;
 	string _outputFilepath;
@@ -16,6 +16,18 @@ namespace PSFlags
 	};
 }
 
+namespace CpuFeatures
+{
+	//Optional hooks in the CPU's memory access path
+	enum CpuFeatures : uint8_t
+	{
+		None = 0,
+		Debugger = 0x01,
+		Cheats = 0x02,
+		All = Debugger | Cheats
+	};
+}
+
 enum class AddrMode
 {
 	None, Acc, Imp, Imm, Rel,
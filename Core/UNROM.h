@@ -7,6 +7,7 @@ class UNROM : public BaseMapper
 	protected:
 		virtual uint16_t GetPRGPageSize() override { return 0x4000; }
 		virtual uint16_t GetCHRPageSize() override {	return 0x2000; }
+		bool AllowPpuCatchUp() override { return true; }
 
 		void InitMapper() override 
 		{
@@ -104,6 +104,11 @@ class VRC2_4 : public BaseMapper
 			if((_useHeuristics && _romInfo.MapperID != 22) || _variant >= VRCVariant::VRC4a) {
 				//Only VRC4 supports IRQs
 				_irq->ProcessCpuClock();
+				if(!_irq->IsEnabled()) {
+					SuspendCpuClock();
+				}
+			} else {
+				SuspendCpuClock();
 			}
 		}
 
@@ -22,8 +22,12 @@ VideoDecoder::VideoDecoder(shared_ptr<Console> console)
 {
 	_console = console;
 	_settings = _console->GetSettings();
-	_frameChanged = false;
 	_stopFlag = false;
+	for(int i = 0; i < 3; i++) {
+		_frames[i].PpuOutputBuffer.resize(PPU::PixelCount);
+		_frames[i].ScreenInfo = nullptr;
+		_frames[i].FrameNumber = 0;
+	}
 	UpdateVideoFilter();
 }
 
@@ -93,18 +97,15 @@ void VideoDecoder::UpdateVideoFilter()
 	}
 }
 
-void VideoDecoder::DecodeFrame(bool synchronous)
+uint32_t* VideoDecoder::ApplyFilters(uint16_t *ppuOutputBuffer, uint32_t frameNumber, FrameInfo &frameInfo, bool drawDebugHud)
 {
-	UpdateVideoFilter();
-
-	if(_hdFilterEnabled) {
-		((HdVideoFilter*)_videoFilter.get())->SetHdScreenTiles(_hdScreenInfo);
-	}
-	_videoFilter->SendFrame(_ppuOutputBuffer, _frameNumber);
+	_videoFilter->SendFrame(ppuOutputBuffer, frameNumber);
 
 	uint32_t* outputBuffer = _videoFilter->GetOutputBuffer();
-	FrameInfo frameInfo = _videoFilter->GetFrameInfo();
-	_console->GetDebugHud()->Draw(outputBuffer, _videoFilter->GetOverscan(), frameInfo.Width, _frameNumber);
+	frameInfo = _videoFilter->GetFrameInfo();
+	if(drawDebugHud) {
+		_console->GetDebugHud()->Draw(outputBuffer, _videoFilter->GetOverscan(), frameInfo.Width, frameNumber);
+	}
 
 	if(_rotateFilter) {
 		outputBuffer = _rotateFilter->ApplyFilter(outputBuffer, frameInfo.Width, frameInfo.Height);
@@ -112,10 +113,35 @@ void VideoDecoder::DecodeFrame(bool synchronous)
 	}
 
 	if(_scaleFilter) {
-		outputBuffer = _scaleFilter->ApplyFilter(outputBuffer, frameInfo.Width, frameInfo.Height, _console->GetSettings()->GetPictureSettings().ScanlineIntensity);
+		outputBuffer = _scaleFilter->ApplyFilter(outputBuffer, frameInfo.Width, frameInfo.Height, _console->GetSettings()->GetPictureSettings().ScanlineIntensity, _console->GetSettings()->GetVideoFilterThreadCount());
 		frameInfo = _scaleFilter->GetFrameInfo(frameInfo);
 	}
 
+	return outputBuffer;
+}
+
+uint32_t* VideoDecoder::FilterRewindFrame(uint16_t *ppuOutputBuffer, uint32_t frameNumber, FrameInfo &frameInfo)
+{
+	if(_hdFilterEnabled) {
+		//HD packs need the screen info that was captured along with the frame
+		return nullptr;
+	}
+
+	//The debug HUD is not drawn again, its commands have already expired or apply to the current frame
+	return ApplyFilters(ppuOutputBuffer, frameNumber, frameInfo, false);
+}
+
+void VideoDecoder::DecodeFrame(bool synchronous)
+{
+	UpdateVideoFilter();
+
+	if(_hdFilterEnabled) {
+		((HdVideoFilter*)_videoFilter.get())->SetHdScreenTiles(_hdScreenInfo);
+	}
+
+	FrameInfo frameInfo;
+	uint32_t* outputBuffer = ApplyFilters(_ppuOutputBuffer, _frameNumber, frameInfo, true);
+
 	if(_hud) {
 		_hud->DrawHud(_console, outputBuffer, frameInfo, _videoFilter->GetOverscan());
 	}
@@ -130,24 +156,29 @@ void VideoDecoder::DecodeFrame(bool synchronous)
 	
 	_lastFrameInfo = frameInfo;
 
-	_frameChanged = false;
-	
 	//Rewind manager will take care of sending the correct frame to the video renderer
-	_console->GetRewindManager()->SendFrame(outputBuffer, frameInfo.Width, frameInfo.Height, synchronous);
+	//HD packs can't be filtered again without their screen info, so only the final frame is sent for those
+	_console->GetRewindManager()->SendFrame(outputBuffer, frameInfo.Width, frameInfo.Height, _hdFilterEnabled ? nullptr : _ppuOutputBuffer, _frameNumber, synchronous);
 }
 
 void VideoDecoder::DecodeThread()
 {
 	//This thread will decode the PPU's output (color ID to RGB, intensify r/g/b and produce a HD version of the frame if needed)
 	while(!_stopFlag.load()) {
-		//DecodeFrame returns the final ARGB frame we want to display in the emulator window
-		while(!_frameChanged) {
+		//Always decode the newest frame - older frames that were not decoded in time are skipped
+		while(!_frameMailbox.Consume()) {
 			_waitForFrame.Wait();
 			if(_stopFlag.load()) {
 				return;
 			}
 		}
 
+		VideoDecoderFrame &frame = _frames[_frameMailbox.GetConsumerIndex()];
+		_frameNumber = frame.FrameNumber;
+		_hdScreenInfo = frame.ScreenInfo;
+		_ppuOutputBuffer = frame.PpuOutputBuffer.data();
+
+		//DecodeFrame returns the final ARGB frame we want to display in the emulator window
 		DecodeFrame();
 	}
 }
@@ -159,7 +190,7 @@ uint32_t VideoDecoder::GetFrameCount()
 
 void VideoDecoder::UpdateFrameSync(void *ppuOutputBuffer, HdScreenInfo *hdScreenInfo)
 {
-	if(_settings->IsRunAheadFrame()) {
+	if(_settings->IsRunAheadFrame() || _console->IsRunAheadMainFrame()) {
 		return;
 	}
 
@@ -172,35 +203,42 @@ void VideoDecoder::UpdateFrameSync(void *ppuOutputBuffer, HdScreenInfo *hdScreen
 
 void VideoDecoder::UpdateFrame(void *ppuOutputBuffer, HdScreenInfo *hdScreenInfo)
 {
-	if(_settings->IsRunAheadFrame()) {
+	if(_settings->IsRunAheadFrame() || _console->IsRunAheadMainFrame()) {
 		return;
 	}
 
-	if(_frameChanged) {
-		//Last frame isn't done decoding yet - sometimes Signal() introduces a 25-30ms delay
-		while(_frameChanged) {
-			//Spin until decode is done
-		}
-		//At this point, we are sure that the decode thread is no longer busy
-	}
-	
-	_frameNumber = _console->GetFrameCount();
-	_hdScreenInfo = hdScreenInfo;
-	_ppuOutputBuffer = (uint16_t*)ppuOutputBuffer;
-	_frameChanged = true;
+	//The decode thread never uses the producer's slot, so it can be written to while the previous frames are being decoded
+	VideoDecoderFrame &frame = _frames[_frameMailbox.GetProducerIndex()];
+	memcpy(frame.PpuOutputBuffer.data(), ppuOutputBuffer, PPU::PixelCount * sizeof(uint16_t));
+	frame.ScreenInfo = hdScreenInfo;
+	frame.FrameNumber = _console->GetFrameCount();
+
+	_frameMailbox.Publish();
 	_waitForFrame.Signal();
 
 	_frameCount++;
 }
 
+uint32_t VideoDecoder::GetFrameSlotIndex()
+{
+	return _frameMailbox.GetProducerIndex();
+}
+
+uint32_t VideoDecoder::GetDroppedFrameCount()
+{
+	return _frameMailbox.GetDroppedCount();
+}
+
 void VideoDecoder::StartThread()
 {
 #ifndef LIBRETRO
 	if(!_decodeThread) {	
 		_stopFlag = false;
-		_frameChanged = false;
 		_frameCount = 0;
 		_waitForFrame.Reset();
+
+		//Discard any frame sent while the thread wasn't running (its HD screen info may no longer exist)
+		_frameMailbox.Consume();
 		_hud.reset(new VideoHud());
 		_decodeThread.reset(new thread(&VideoDecoder::DecodeThread, this));
 	}
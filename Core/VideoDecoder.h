@@ -5,6 +5,7 @@ using std::thread;
 
 #include "../Utilities/SimpleLock.h"
 #include "../Utilities/AutoResetEvent.h"
+#include "../Utilities/TripleBuffer.h"
 #include "EmulationSettings.h"
 #include "FrameInfo.h"
 
@@ -23,6 +24,13 @@ struct ScreenSize
 	double Scale;
 };
 
+struct VideoDecoderFrame
+{
+	vector<uint16_t> PpuOutputBuffer;
+	HdScreenInfo *ScreenInfo;
+	uint32_t FrameNumber;
+};
+
 class VideoDecoder
 {
 private:
@@ -37,8 +45,11 @@ private:
 	unique_ptr<VideoHud> _hud;
 
 	AutoResetEvent _waitForFrame;
-	
-	atomic<bool> _frameChanged;
+
+	//Frames sent by UpdateFrame are handed off to the decode thread through a lock-free triple buffer
+	VideoDecoderFrame _frames[3];
+	TripleBuffer _frameMailbox;
+
 	atomic<bool> _stopFlag;
 	uint32_t _frameCount = 0;
 
@@ -52,6 +63,7 @@ private:
 	shared_ptr<RotateFilter> _rotateFilter;
 
 	void UpdateVideoFilter();
+	uint32_t* ApplyFilters(uint16_t *ppuOutputBuffer, uint32_t frameNumber, FrameInfo &frameInfo, bool drawDebugHud);
 
 	void DecodeThread();
 
@@ -60,6 +72,10 @@ public:
 	~VideoDecoder();
 
 	void DecodeFrame(bool synchronous = false);
+
+	//Runs a raw PPU frame through the current filters (without any HUD), used to display frames stored by the rewind manager.
+	//Must be called from the thread that decodes frames (i.e from RewindManager::SendFrame), returns nullptr if the frame can't be filtered
+	uint32_t* FilterRewindFrame(uint16_t *ppuOutputBuffer, uint32_t frameNumber, FrameInfo &frameInfo);
 	void TakeScreenshot();
 	void TakeScreenshot(std::stringstream &stream, bool rawScreenshot = false);
 
@@ -69,7 +85,15 @@ public:
 	void GetScreenSize(ScreenSize &size, bool ignoreScale);
 
 	void UpdateFrameSync(void* frameBuffer, HdScreenInfo *hdScreenInfo = nullptr);
+
+	//Sends a frame to the decode thread without ever waiting for it - if the decoder is still busy when the next frame is sent, this frame is dropped.
+	//The PPU's output is copied, but the HD screen info isn't: the HD PPU must draw the next frame's screen info in the buffer given by GetFrameSlotIndex()
 	void UpdateFrame(void* frameBuffer, HdScreenInfo *hdScreenInfo = nullptr);
+	uint32_t GetFrameSlotIndex();
+
+	//Number of frames that were replaced by a newer frame before the decode thread got to them
+	//(frames are never decoded twice, so there are no duplicated frames to count)
+	uint32_t GetDroppedFrameCount();
 
 	bool IsRunning();
 	void StartThread();
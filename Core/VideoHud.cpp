@@ -111,14 +111,14 @@ bool VideoHud::DisplayControllerInput(shared_ptr<Console> console, ControlDevice
 
 void VideoHud::DrawMovieIcons(shared_ptr<Console> console, uint32_t *outputBuffer, FrameInfo &frameInfo, OverscanDimensions &overscan)
 {
-	if(console->GetSettings()->CheckFlag(EmulationFlags::DisplayMovieIcons) && (MovieManager::Playing() || MovieManager::Recording())) {
+	if(console->GetSettings()->CheckFlag(EmulationFlags::DisplayMovieIcons) && (console->GetMovieManager()->Playing() || console->GetMovieManager()->Recording())) {
 		InputDisplaySettings settings = console->GetSettings()->GetInputDisplaySettings();
 		uint32_t xOffset = settings.VisiblePorts > 0 && settings.DisplayPosition == InputDisplayPosition::TopRight ? 50 : 27;
 		uint32_t* rgbaBuffer = (uint32_t*)outputBuffer;
 		int scale = frameInfo.Width / overscan.GetScreenWidth();
 		uint32_t yStart = 15 * scale;
 		uint32_t xStart = (frameInfo.Width - xOffset) * scale;
-		if(MovieManager::Playing()) {
+		if(console->GetMovieManager()->Playing()) {
 			for(int y = 0; y < 12 * scale; y++) {
 				for(int x = 0; x < 12 * scale; x++) {
 					uint32_t bufferPos = (yStart + y)*frameInfo.Width + (xStart + x);
@@ -132,7 +132,7 @@ void VideoHud::DrawMovieIcons(shared_ptr<Console> console, uint32_t *outputBuffe
 					}
 				}
 			}
-		} else if(MovieManager::Recording()) {
+		} else if(console->GetMovieManager()->Recording()) {
 			for(int y = 0; y < 12 * scale; y++) {
 				for(int x = 0; x < 12 * scale; x++) {
 					uint32_t bufferPos = (yStart + y)*frameInfo.Width + (xStart + x);
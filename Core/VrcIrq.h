@@ -52,6 +52,11 @@ public:
 		}
 	}
 
+	bool IsEnabled()
+	{
+		return _irqEnabled;
+	}
+
 	void SetReloadValue(uint8_t value)
 	{
 		_irqReloadValue = value;
@@ -78,6 +78,7 @@ public:
 		if(port < 4) {
 			_console->Pause();
 			_needInsertCoin[port] = VsSystemActionManager::InsertCoinFrameCount;
+			_console->InvalidateRunAhead();
 			MessageManager::DisplayMessage("VS System", "CoinInsertedSlot", std::to_string(port + 1));
 			_console->Resume();
 		}
@@ -87,6 +88,7 @@ public:
 	{
 		_console->Pause();
 		_needServiceButton[consoleId] = pressed;
+		_console->InvalidateRunAhead();
 		_console->Resume();
 	}
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "stdafx.h"
+#include <algorithm>
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(uint32_t threadCount)
+{
+	_nextTask = 0;
+	_pendingWorkers = 0;
+	_stopFlag = false;
+
+	//The calling thread is one of the threads
+	threadCount = std::max<uint32_t>(1, threadCount);
+	for(uint32_t i = 0; i < threadCount - 1; i++) {
+		_startSignals.push_back(unique_ptr<AutoResetEvent>(new AutoResetEvent()));
+	}
+
+	for(uint32_t i = 0; i < threadCount - 1; i++) {
+		_workers.push_back(unique_ptr<std::thread>(new std::thread(&WorkerPool::WorkerLoop, this, i)));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	_stopFlag = true;
+	for(unique_ptr<AutoResetEvent> &signal : _startSignals) {
+		signal->Signal();
+	}
+	for(unique_ptr<std::thread> &worker : _workers) {
+		worker->join();
+	}
+}
+
+uint32_t WorkerPool::GetThreadCount()
+{
+	return (uint32_t)_workers.size() + 1;
+}
+
+void WorkerPool::Run(uint32_t taskCount, const std::function<void(uint32_t)> &task)
+{
+	if(taskCount == 0) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_runLock);
+	_task = &task;
+	_taskCount = taskCount;
+	_nextTask = 0;
+
+	//Only wake up as many workers as needed
+	uint32_t workerCount = std::min<uint32_t>((uint32_t)_workers.size(), taskCount - 1);
+	_pendingWorkers = workerCount;
+	_batchDone.Reset();
+	for(uint32_t i = 0; i < workerCount; i++) {
+		_startSignals[i]->Signal();
+	}
+
+	ProcessTasks();
+
+	if(workerCount > 0) {
+		_batchDone.Wait();
+	}
+	_task = nullptr;
+}
+
+void WorkerPool::ProcessTasks()
+{
+	uint32_t taskIndex;
+	while((taskIndex = _nextTask++) < _taskCount) {
+		(*_task)(taskIndex);
+	}
+}
+
+void WorkerPool::WorkerLoop(uint32_t workerIndex)
+{
+	while(true) {
+		_startSignals[workerIndex]->Wait();
+		if(_stopFlag) {
+			break;
+		}
+
+		ProcessTasks();
+		if(--_pendingWorkers == 0) {
+			_batchDone.Signal();
+		}
+	}
+}
+
+shared_ptr<WorkerPool> WorkerPool::GetVideoFilterPool(uint32_t threadCount)
+{
+	static std::mutex poolLock;
+	static shared_ptr<WorkerPool> pool;
+
+	if(threadCount == 0) {
+		//Auto: past ~8 threads, the bands get too small for the extra threads to help much
+		threadCount = std::min<uint32_t>(8, std::max<uint32_t>(1, std::thread::hardware_concurrency()));
+	}
+
+	std::lock_guard<std::mutex> lock(poolLock);
+	if(!pool || pool->GetThreadCount() != threadCount) {
+		//Filters that are still using the previous pool keep it alive until they are done
+		pool.reset(new WorkerPool(threadCount));
+	}
+	return pool;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "stdafx.h"
+#include <thread>
+#include <mutex>
+#include <functional>
+#include "../Utilities/AutoResetEvent.h"
+
+//Runs a batch of independent tasks (e.g the horizontal bands of a video filter) on a fixed number of threads.
+//The calling thread processes tasks too, Run returns once every task in the batch is done.
+class WorkerPool
+{
+private:
+	vector<unique_ptr<std::thread>> _workers;
+	vector<unique_ptr<AutoResetEvent>> _startSignals;
+	AutoResetEvent _batchDone;
+	std::mutex _runLock;
+
+	const std::function<void(uint32_t)>* _task = nullptr;
+	uint32_t _taskCount = 0;
+	atomic<uint32_t> _nextTask;
+	atomic<uint32_t> _pendingWorkers;
+	atomic<bool> _stopFlag;
+
+	void WorkerLoop(uint32_t workerIndex);
+	void ProcessTasks();
+
+public:
+	WorkerPool(uint32_t threadCount);
+	~WorkerPool();
+
+	//Number of threads that process tasks, including the calling thread
+	uint32_t GetThreadCount();
+
+	//Calls task(0) to task(taskCount - 1), batches from different threads are run one after the other
+	void Run(uint32_t taskCount, const std::function<void(uint32_t)> &task);
+
+	//Pool shared by all video filters, recreated when the thread count setting changes (0 = automatic)
+	static shared_ptr<WorkerPool> GetVideoFilterPool(uint32_t threadCount);
+};
@@ -39,6 +39,7 @@ namespace Mesen.GUI.Config
 		[MinMax(0, 5000)] public UInt32 TurboSpeed = 300;
 		[MinMax(0, 5000)] public UInt32 RewindSpeed = 100;
 		[MinMax(0, 10)] public UInt32 RunAheadFrames = 0;
+		public bool RunAheadPreemptive = false;
 
 		public EmulationInfo()
 		{
@@ -51,6 +52,7 @@ namespace Mesen.GUI.Config
 			InteropEmu.SetEmulationSpeed(emulationInfo.EmulationSpeed);
 			InteropEmu.SetTurboRewindSpeed(emulationInfo.TurboSpeed, emulationInfo.RewindSpeed);
 			InteropEmu.SetRunAheadFrames(emulationInfo.RunAheadFrames);
+			InteropEmu.SetRunAheadPreemptive(emulationInfo.RunAheadPreemptive);
 
 			InteropEmu.SetFlag(EmulationFlags.Mmc3IrqAltBehavior, emulationInfo.UseAlternativeMmc3Irq);
 			InteropEmu.SetFlag(EmulationFlags.AllowInvalidInput, emulationInfo.AllowInvalidInput);
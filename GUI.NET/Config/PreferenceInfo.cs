@@ -80,6 +80,10 @@ namespace Mesen.GUI.Config
 		public bool ConfirmExitResetPower = false;
 
 		public UInt32 RewindBufferSize = 300;
+		public bool RewindDeltaCompression = true;
+		public UInt32 RewindMemoryLimit = 0;
+		public bool RewindRawVideo = true;
+		public bool HistoryViewerPreDecode = true;
 
 		public bool OverrideGameFolder = false;
 		public bool OverrideAviFolder = false;
@@ -214,6 +218,10 @@ namespace Mesen.GUI.Config
 			}
 
 			InteropEmu.SetRewindBufferSize(preferenceInfo.RewindBufferSize);
+			InteropEmu.SetRewindMemoryLimit(preferenceInfo.RewindMemoryLimit);
+			InteropEmu.SetRewindRawVideo(preferenceInfo.RewindRawVideo);
+			InteropEmu.SetHistoryViewerPreDecode(preferenceInfo.HistoryViewerPreDecode);
+			InteropEmu.SetFlag(EmulationFlags.RewindDeltaCompression, preferenceInfo.RewindDeltaCompression);
 
 			InteropEmu.SetFolderOverrides(ConfigManager.SaveFolder, ConfigManager.SaveStateFolder, ConfigManager.ScreenshotFolder);
 		}
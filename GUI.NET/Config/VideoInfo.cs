@@ -18,6 +18,7 @@ namespace Mesen.GUI.Config
 		[MinMax(0, 100)] public UInt32 OverscanBottom = 0;
 		[MinMax(0.1, 10.0)] public double VideoScale = 2;
 		public VideoFilterType VideoFilter = VideoFilterType.None;
+		[MinMax(0, 16)] public UInt32 VideoFilterThreadCount = 0;
 		public bool UseBilinearInterpolation = false;
 		public VideoAspectRatio AspectRatio = VideoAspectRatio.NoStretching;
 		public ScreenRotation ScreenRotation = ScreenRotation.None;
@@ -102,6 +103,7 @@ namespace Mesen.GUI.Config
 			InteropEmu.SetExclusiveRefreshRate((UInt32)videoInfo.ExclusiveFullscreenRefreshRate);
 
 			InteropEmu.SetVideoFilter(videoInfo.VideoFilter);
+			InteropEmu.SetVideoFilterThreadCount(videoInfo.VideoFilterThreadCount);
 			InteropEmu.SetVideoResizeFilter(videoInfo.UseBilinearInterpolation ? VideoResizeFilter.Bilinear : VideoResizeFilter.NearestNeighbor);
 			InteropEmu.SetVideoScale(videoInfo.VideoScale <= 10 ? videoInfo.VideoScale : 2);
 			InteropEmu.SetVideoAspectRatio(videoInfo.AspectRatio, videoInfo.CustomAspectRatio);
@@ -113,6 +113,7 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] public static extern Int32 NetPlayGetControllerPort();
 
 		[DllImport(DLLPath)] public static extern void TakeScreenshot();
+		[DllImport(DLLPath)] public static extern UInt32 GetDroppedFrameCount();
 
 		[DllImport(DLLPath)] public static extern IntPtr RegisterNotificationCallback(ConsoleId consoleId, NotificationListener.NotificationCallback callback);
 		[DllImport(DLLPath)] public static extern void UnregisterNotificationCallback(IntPtr notificationListener);
@@ -147,6 +148,7 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] public static extern void LoadState(UInt32 stateIndex);
 		[DllImport(DLLPath)] public static extern void SaveStateFile([MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(UTF8Marshaler))]string filepath);
 		[DllImport(DLLPath)] public static extern void LoadStateFile([MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(UTF8Marshaler))]string filepath);
+		[DllImport(DLLPath)] public static extern UInt64 GetStateHash();
 
 		[DllImport(DLLPath, EntryPoint = "GetSaveStatePreview")] private static extern Int32 GetSaveStatePreviewWrapper([MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(UTF8Marshaler))]string saveStatePath, [Out]byte[] imgData);
 		public static Image GetSaveStatePreview(string saveStatePath)
@@ -210,6 +212,7 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] public static extern void SetAudioLatency(UInt32 msLatency);
 		[DllImport(DLLPath)] public static extern void SetAudioFilterSettings(AudioFilterSettings settings);
 		[DllImport(DLLPath)] public static extern void SetRunAheadFrames(UInt32 frameCount);
+		[DllImport(DLLPath)] public static extern void SetRunAheadPreemptive([MarshalAs(UnmanagedType.I1)]bool enabled);
 
 		[DllImport(DLLPath)] public static extern NesModel GetNesModel();
 		[DllImport(DLLPath)] public static extern void SetNesModel(NesModel model);
@@ -219,6 +222,9 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] public static extern UInt32 GetEmulationSpeed();
 		[DllImport(DLLPath)] public static extern void SetTurboRewindSpeed(UInt32 turboSpeed, UInt32 rewindSpeed);
 		[DllImport(DLLPath)] public static extern void SetRewindBufferSize(UInt32 seconds);
+		[DllImport(DLLPath)] public static extern void SetRewindMemoryLimit(UInt32 megabytes);
+		[DllImport(DLLPath)] public static extern void SetRewindRawVideo([MarshalAs(UnmanagedType.I1)]bool enabled);
+		[DllImport(DLLPath)] public static extern void SetHistoryViewerPreDecode([MarshalAs(UnmanagedType.I1)]bool enabled);
 		[DllImport(DLLPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool IsRewinding();
 		[DllImport(DLLPath)] public static extern void SetPpuNmiConfig(UInt32 extraScanlinesBeforeNmi, UInt32 extraScanlineAfterNmi);
 		[DllImport(DLLPath)] public static extern void SetOverscanDimensions(UInt32 left, UInt32 right, UInt32 top, UInt32 bottom);
@@ -227,6 +233,7 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] public static extern void SetExclusiveRefreshRate(UInt32 refreshRate);
 		[DllImport(DLLPath)] public static extern void SetVideoAspectRatio(VideoAspectRatio aspectRatio, double customRatio);
 		[DllImport(DLLPath)] public static extern void SetVideoFilter(VideoFilterType filter);
+		[DllImport(DLLPath)] public static extern void SetVideoFilterThreadCount(UInt32 threadCount);
 		[DllImport(DLLPath)] public static extern void SetVideoResizeFilter(VideoResizeFilter filter);
 		[DllImport(DLLPath)] public static extern void SetRgbPalette(byte[] palette, UInt32 paletteSize);
 		[DllImport(DLLPath)] public static extern void SetPictureSettings(double brightness, double contrast, double saturation, double hue, double scanlineIntensity);
@@ -1655,6 +1662,7 @@ namespace Mesen.GUI
 		DisableDynamicSampleRate = 0x80,
 
 		PauseOnMovieEnd = 0x0100,
+		RewindDeltaCompression = 0x0200,
 
 		AllowBackgroundInput = 0x0400,
 		ReduceSoundInBackground = 0x0800,
@@ -1731,6 +1739,9 @@ namespace Mesen.GUI
 
 		RandomizeCpuPpuAlignment = 0x800000000000000,
 
+		PpuCatchUpSync = 0x1000000000000000,
+		RunAheadShadowConsole = 0x2000000000000000,
+
 		ForceMaxSpeed = 0x4000000000000000,
 		ConsoleMode = 0x8000000000000000,
 	}
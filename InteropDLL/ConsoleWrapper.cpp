@@ -376,6 +376,18 @@ namespace InteropEmu {
 			}
 		}
 
+		DllExport double __stdcall RunFrames(uint32_t frameCount, bool decodeVideo, bool processAudio, bool sendNotifications)
+		{
+			if(_console) {
+				HeadlessRunOptions options;
+				options.DecodeVideo = decodeVideo;
+				options.ProcessAudio = processAudio;
+				options.SendNotifications = sendNotifications;
+				return _console->RunFrames(frameCount, options).Fps;
+			}
+			return 0;
+		}
+
 		DllExport void __stdcall Resume(ConsoleId consoleId) { GetConsoleById(consoleId)->GetSettings()->ClearFlags(EmulationFlags::Paused); }
 		DllExport bool __stdcall IsPaused(ConsoleId consoleId) { return GetConsoleById(consoleId)->GetSettings()->CheckFlag(EmulationFlags::Paused); }
 		DllExport void __stdcall Pause(ConsoleId consoleId)
@@ -509,6 +521,7 @@ namespace InteropEmu {
 		}
 
 		DllExport void __stdcall TakeScreenshot() { _console->GetVideoDecoder()->TakeScreenshot(); }
+		DllExport uint32_t __stdcall GetDroppedFrameCount() { return _console->GetVideoDecoder()->GetDroppedFrameCount(); }
 
 		DllExport INotificationListener* __stdcall RegisterNotificationCallback(ConsoleId consoleId, NotificationListenerCallback callback)
 		{
@@ -545,21 +558,29 @@ namespace InteropEmu {
 		DllExport void __stdcall LoadState(uint32_t stateIndex) { _console->GetSaveStateManager()->LoadState(stateIndex); }
 		DllExport void __stdcall SaveStateFile(char* filepath) { _console->GetSaveStateManager()->SaveState(filepath); }
 		DllExport void __stdcall LoadStateFile(char* filepath) { _console->GetSaveStateManager()->LoadState(filepath); }
+
+		DllExport uint64_t __stdcall GetStateHash()
+		{
+			_console->Pause();
+			uint64_t hash = _console->GetStateHash();
+			_console->Resume();
+			return hash;
+		}
 		
 		DllExport int32_t __stdcall GetSaveStatePreview(char* saveStatePath, uint8_t* pngData) { return _console->GetSaveStateManager()->GetSaveStatePreview(saveStatePath, pngData); }
 
 
-		DllExport void __stdcall MoviePlay(char* filename) { MovieManager::Play(string(filename), _console); }
+		DllExport void __stdcall MoviePlay(char* filename) { _console->GetMovieManager()->Play(string(filename)); }
 		
 		DllExport void __stdcall MovieRecord(RecordMovieOptions *options)
 		{
 			RecordMovieOptions opt = *options;
-			MovieManager::Record(opt, _console);
+			_console->GetMovieManager()->Record(opt);
 		}
 
-		DllExport void __stdcall MovieStop() { MovieManager::Stop(); }
-		DllExport bool __stdcall MoviePlaying() { return MovieManager::Playing(); }
-		DllExport bool __stdcall MovieRecording() { return MovieManager::Recording(); }
+		DllExport void __stdcall MovieStop() { _console->GetMovieManager()->Stop(); }
+		DllExport bool __stdcall MoviePlaying() { return _console->GetMovieManager()->Playing(); }
+		DllExport bool __stdcall MovieRecording() { return _console->GetMovieManager()->Recording(); }
 
 		DllExport void __stdcall AviRecord(char* filename, VideoCodec codec, uint32_t compressionLevel) { _console->GetVideoRenderer()->StartRecording(filename, codec, compressionLevel); }
 		DllExport void __stdcall AviStop() { _console->GetVideoRenderer()->StopRecording(); }
@@ -633,6 +654,7 @@ namespace InteropEmu {
 		DllExport void __stdcall SetAudioLatency(uint32_t msLatency) { _settings->SetAudioLatency(msLatency); }
 		DllExport void __stdcall SetAudioFilterSettings(AudioFilterSettings settings) { _settings->SetAudioFilterSettings(settings); }
 		DllExport void __stdcall SetRunAheadFrames(uint32_t frameCount) { _settings->SetRunAheadFrames(frameCount); }
+		DllExport void __stdcall SetRunAheadPreemptive(bool enabled) { _settings->SetRunAheadPreemptive(enabled); }
 
 		DllExport NesModel __stdcall GetNesModel() { return _console->GetModel(); }
 		DllExport void __stdcall SetNesModel(uint32_t model) { _settings->SetNesModel((NesModel)model); }
@@ -643,6 +665,9 @@ namespace InteropEmu {
 		DllExport uint32_t __stdcall GetEmulationSpeed() { return _settings->GetEmulationSpeed(true); }
 		DllExport void __stdcall SetTurboRewindSpeed(uint32_t turboSpeed, uint32_t rewindSpeed) { _settings->SetTurboRewindSpeed(turboSpeed, rewindSpeed); }
 		DllExport void __stdcall SetRewindBufferSize(uint32_t seconds) { _settings->SetRewindBufferSize(seconds); }
+		DllExport void __stdcall SetRewindMemoryLimit(uint32_t megabytes) { _settings->SetRewindMemoryLimit(megabytes); }
+		DllExport void __stdcall SetRewindRawVideo(bool enabled) { _settings->SetRewindRawVideo(enabled); }
+		DllExport void __stdcall SetHistoryViewerPreDecode(bool enabled) { _settings->SetHistoryViewerPreDecode(enabled); }
 		DllExport bool __stdcall IsRewinding() {
 			shared_ptr<RewindManager> rewindManager = _console->GetRewindManager();
 			return rewindManager ? rewindManager->IsRewinding() : false;
@@ -653,6 +678,7 @@ namespace InteropEmu {
 		DllExport void __stdcall SetExclusiveRefreshRate(uint32_t angle) { _settings->SetExclusiveRefreshRate(angle); }
 		DllExport void __stdcall SetVideoAspectRatio(VideoAspectRatio aspectRatio, double customRatio) { _settings->SetVideoAspectRatio(aspectRatio, customRatio); }
 		DllExport void __stdcall SetVideoFilter(VideoFilterType filter) { _settings->SetVideoFilterType(filter); }
+		DllExport void __stdcall SetVideoFilterThreadCount(uint32_t threadCount) { _settings->SetVideoFilterThreadCount(threadCount); }
 		DllExport void __stdcall SetVideoResizeFilter(VideoResizeFilter filter) { _settings->SetVideoResizeFilter(filter); }
 		DllExport void __stdcall GetRgbPalette(uint32_t *paletteBuffer) { _settings->GetUserRgbPalette(paletteBuffer); }
 		DllExport void __stdcall SetRgbPalette(uint32_t *paletteBuffer, uint32_t paletteSize) { _settings->SetUserRgbPalette(paletteBuffer, paletteSize); }
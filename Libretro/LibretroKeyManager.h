@@ -118,7 +118,18 @@ public:
 
 	virtual vector<uint32_t> GetPressedKeys() override
 	{
-		return vector<uint32_t>();
+		//Uses the same key codes as IsKeyPressed (port in the upper bits, button id + 1 in the lower 8 bits)
+		vector<uint32_t> keys;
+		if(_getInputState) {
+			for(uint32_t port = 0; port < 5; port++) {
+				for(uint32_t id = 0; id <= RETRO_DEVICE_ID_JOYPAD_R3; id++) {
+					if(_getInputState(port, RETRO_DEVICE_JOYPAD, 0, id)) {
+						keys.push_back((port << 8) | (id + 1));
+					}
+				}
+			}
+		}
+		return keys;
 	}
 	
 	virtual string GetKeyName(uint32_t keyCode) override
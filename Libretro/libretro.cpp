@@ -2,6 +2,7 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
 #include "LibretroRenderer.h"
 #include "LibretroSoundManager.h"
 #include "LibretroKeyManager.h"
@@ -11,6 +12,7 @@
 #include "../Core/VideoDecoder.h"
 #include "../Core/VideoRenderer.h"
 #include "../Core/EmulationSettings.h"
+#include "../Core/ControlManager.h"
 #include "../Core/CheatManager.h"
 #include "../Core/HdData.h"
 #include "../Core/SaveStateManager.h"
@@ -49,6 +51,21 @@ static struct retro_memory_map _memoryMap;
 static bool _shiftButtonsClockwise = false;
 static int32_t _audioSampleRate = 44100;
 
+//Copies of the memory exposed to the frontend, taken after each frame while the internal run-ahead is enabled
+static vector<uint8_t> _systemRamCopy;
+static vector<uint8_t> _saveRamCopy;
+
+//Frame time statistics, logged periodically while the internal run-ahead is enabled
+static constexpr uint32_t FrameTimeLogInterval = 600;
+static double _frameTimeTotal = 0;
+static double _frameTimeMax = 0;
+static uint32_t _frameTimeCount = 0;
+static uint32_t _lastRollbackCount = 0;
+
+//Libretro save states: "MLS" + format version, followed by the console's state (see Console::SaveState)
+static constexpr char LibretroStateMagic[3] = { 'M', 'L', 'S' };
+static constexpr size_t LibretroStateHeaderSize = 3 + sizeof(uint32_t);
+
 //Include game database as a byte array (representing the MesenDB.txt file)
 #include "MesenDB.inc"
 
@@ -80,6 +97,8 @@ static constexpr const char* MesenSwapDutyCycle = "mesen_swap_duty_cycle";
 static constexpr const char* MesenDisableNoiseModeFlag = "mesen_disable_noise_mode_flag";
 static constexpr const char* MesenShiftButtonsClockwise = "mesen_shift_buttons_clockwise";
 static constexpr const char* MesenAudioSampleRate = "mesen_audio_sample_rate";
+static constexpr const char* MesenRunAhead = "mesen_runahead";
+static constexpr const char* MesenRunAheadMode = "mesen_runahead_mode";
 
 uint32_t defaultPalette[0x40] { 0xFF666666, 0xFF002A88, 0xFF1412A7, 0xFF3B00A4, 0xFF5C007E, 0xFF6E0040, 0xFF6C0600, 0xFF561D00, 0xFF333500, 0xFF0B4800, 0xFF005200, 0xFF004F08, 0xFF00404D, 0xFF000000, 0xFF000000, 0xFF000000, 0xFFADADAD, 0xFF155FD9, 0xFF4240FF, 0xFF7527FE, 0xFFA01ACC, 0xFFB71E7B, 0xFFB53120, 0xFF994E00, 0xFF6B6D00, 0xFF388700, 0xFF0C9300, 0xFF008F32, 0xFF007C8D, 0xFF000000, 0xFF000000, 0xFF000000, 0xFFFFFEFF, 0xFF64B0FF, 0xFF9290FF, 0xFFC676FF, 0xFFF36AFF, 0xFFFE6ECC, 0xFFFE8170, 0xFFEA9E22, 0xFFBCBE00, 0xFF88D800, 0xFF5CE430, 0xFF45E082, 0xFF48CDDE, 0xFF4F4F4F, 0xFF000000, 0xFF000000, 0xFFFFFEFF, 0xFFC0DFFF, 0xFFD3D2FF, 0xFFE8C8FF, 0xFFFBC2FF, 0xFFFEC4EA, 0xFFFECCC5, 0xFFF7D8A5, 0xFFE4E594, 0xFFCFEF96, 0xFFBDF4AB, 0xFFB3F3CC, 0xFFB5EBF2, 0xFFB8B8B8, 0xFF000000, 0xFF000000 };
 uint32_t unsaturatedPalette[0x40] { 0xFF6B6B6B, 0xFF001E87, 0xFF1F0B96, 0xFF3B0C87, 0xFF590D61, 0xFF5E0528, 0xFF551100, 0xFF461B00, 0xFF303200, 0xFF0A4800, 0xFF004E00, 0xFF004619, 0xFF003A58, 0xFF000000, 0xFF000000, 0xFF000000, 0xFFB2B2B2, 0xFF1A53D1, 0xFF4835EE, 0xFF7123EC, 0xFF9A1EB7, 0xFFA51E62, 0xFFA52D19, 0xFF874B00, 0xFF676900, 0xFF298400, 0xFF038B00, 0xFF008240, 0xFF007891, 0xFF000000, 0xFF000000, 0xFF000000, 0xFFFFFFFF, 0xFF63ADFD, 0xFF908AFE, 0xFFB977FC, 0xFFE771FE, 0xFFF76FC9, 0xFFF5836A, 0xFFDD9C29, 0xFFBDB807, 0xFF84D107, 0xFF5BDC3B, 0xFF48D77D, 0xFF48CCCE, 0xFF555555, 0xFF000000, 0xFF000000, 0xFFFFFFFF, 0xFFC4E3FE, 0xFFD7D5FE, 0xFFE6CDFE, 0xFFF9CAFE, 0xFFFEC9F0, 0xFFFED1C7, 0xFFF7DCAC, 0xFFE8E89C, 0xFFD1F29D, 0xFFBFF4B1, 0xFFB7F5CD, 0xFFB7F0EE, 0xFFBEBEBE, 0xFF000000, 0xFF000000 };
@@ -172,6 +191,8 @@ extern "C" {
 			{ MesenFdsAutoSelectDisk, "FDS: Automatically insert disks; disabled|enabled" },
 			{ MesenFdsFastForwardLoad, "FDS: Fast forward while loading; disabled|enabled" },
 			{ MesenAudioSampleRate, "Sound Output Sample Rate; 96000|192000|384000|11025|22050|44100|48000" },
+			{ MesenRunAhead, "Run-ahead (internal); disabled|1 frame|2 frames|3 frames|4 frames|5 frames|6 frames" },
+			{ MesenRunAheadMode, "Run-ahead mode; Second instance|Preemptive frames" },
 			{ NULL, NULL },
 		};
 
@@ -411,6 +432,22 @@ extern "C" {
 			}
 		}
 
+		if(readVariable(MesenRunAhead, var)) {
+			//Uses a hidden second console to run ahead, the frontend's own run-ahead feature should be disabled when this is used
+			string value = string(var.value);
+			uint32_t frameCount = value == "disabled" ? 0 : (uint32_t)std::stoi(value);
+			_console->GetSettings()->SetRunAheadFrames(frameCount);
+			if(frameCount > 0) {
+				_console->GetSettings()->SetFlags(EmulationFlags::RunAheadShadowConsole);
+			} else {
+				_console->GetSettings()->ClearFlags(EmulationFlags::RunAheadShadowConsole);
+			}
+		}
+
+		if(readVariable(MesenRunAheadMode, var)) {
+			_console->GetSettings()->SetRunAheadPreemptive(string(var.value) == "Preemptive frames");
+		}
+
 		if(readVariable(MesenOverclock, var)) {
 			string value = string(var.value);
 			int lineCount = 0;
@@ -646,8 +683,65 @@ extern "C" {
 		retroEnv(RETRO_ENVIRONMENT_SET_GEOMETRY, &avInfo);
 	}
 
+	void update_frame_time(double frameTime)
+	{
+		if(_console->GetSettings()->GetRunAheadFrames() == 0) {
+			_frameTimeCount = 0;
+			_lastRollbackCount = _console->GetRunAheadRollbackCount();
+			return;
+		}
+
+		if(_frameTimeCount == 0) {
+			_frameTimeTotal = 0;
+			_frameTimeMax = 0;
+		}
+
+		_frameTimeTotal += frameTime;
+		_frameTimeMax = std::max(_frameTimeMax, frameTime);
+		_frameTimeCount++;
+
+		if(_frameTimeCount == FrameTimeLogInterval) {
+			uint32_t rollbackCount = _console->GetRunAheadRollbackCount();
+			std::stringstream ss;
+			ss << "[Mesen] Run-ahead (" << _console->GetSettings()->GetRunAheadFrames() << " frames" << (_console->GetSettings()->IsRunAheadPreemptive() ? ", preemptive" : "") << "): ";
+			ss << "avg " << (_frameTimeTotal / _frameTimeCount) << " ms, max " << _frameTimeMax << " ms per frame, ";
+			ss << (rollbackCount - _lastRollbackCount) << " rollbacks in the last " << _frameTimeCount << " frames" << std::endl;
+			logMessage(RETRO_LOG_INFO, ss.str().c_str());
+			_frameTimeCount = 0;
+			_lastRollbackCount = rollbackCount;
+		}
+	}
+
+	//The frontend can write to the memory it was given (cheats, achievements) between frames, without going through the core.
+	//Returns true when the memory no longer matches the copy taken after the last frame (and updates the copy when updateCopy is set)
+	bool check_exposed_memory(DebugMemoryType memoryType, vector<uint8_t> &copy, bool updateCopy)
+	{
+		uint32_t size = 0;
+		int32_t startAddr = 0;
+		uint8_t* ram = _console->GetRamBuffer(memoryType, size, startAddr);
+		if(!ram) {
+			size = 0;
+		}
+
+		bool changed = copy.size() == size && size > 0 && memcmp(copy.data(), ram, size) != 0;
+		if(updateCopy) {
+			copy.assign(ram, ram + size);
+		}
+		return changed;
+	}
+
 	RETRO_API void retro_run()
 	{
+		bool runAhead = _console->GetSettings()->GetRunAheadFrames() > 0;
+		if(runAhead) {
+			bool systemRamChanged = check_exposed_memory(DebugMemoryType::InternalRam, _systemRamCopy, false);
+			bool saveRamChanged = check_exposed_memory(DebugMemoryType::SaveRam, _saveRamCopy, false);
+			if(systemRamChanged || saveRamChanged) {
+				//The run-ahead frames were run without the frontend's changes
+				_console->InvalidateRunAhead();
+			}
+		}
+
 		if(_console->GetSettings()->CheckFlag(EmulationFlags::ForceMaxSpeed)) {
 			//Skip frames to speed up emulation while still outputting at 50/60 fps (needed for FDS fast forward while loading)
 			_renderer->SetSkipMode(true);
@@ -672,35 +766,67 @@ extern "C" {
 			}
 		}
 
+		auto frameStart = std::chrono::high_resolution_clock::now();
 		_console->RunSingleFrame();
+		update_frame_time(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count());
+
+		if(runAhead) {
+			check_exposed_memory(DebugMemoryType::InternalRam, _systemRamCopy, true);
+			check_exposed_memory(DebugMemoryType::SaveRam, _saveRamCopy, true);
+		}
 
 		if(updated) {
 			//Update geometry after running the frame, in case the console's region changed (affects "auto" aspect ratio)
 			retro_system_av_info avInfo = {};
 			_renderer->GetSystemAudioVideoInfo(avInfo);
 			retroEnv(RETRO_ENVIRONMENT_SET_GEOMETRY, &avInfo);
+
+			//Controller changes are applied during the frame and can change the state's size
+			_saveStateSize = (int32_t)(LibretroStateHeaderSize + _console->GetMaxSaveStateSize());
 		}
 	}
 
 	RETRO_API size_t retro_serialize_size()
 	{
-		return _saveStateSize;
+		return _saveStateSize > 0 ? _saveStateSize : 0;
 	}
 
 	RETRO_API bool retro_serialize(void *data, size_t size)
 	{
-		std::stringstream ss;
-		_console->GetSaveStateManager()->SaveState(ss);
-		
-		string saveStateData = ss.str();
-		memset(data, 0, size);
-		memcpy(data, saveStateData.c_str(), std::min(size, saveStateData.size()));
+		//The state is written directly in the frontend's buffer, without the regular header (screenshot, rom name, etc.)
+		if(size < LibretroStateHeaderSize) {
+			return false;
+		}
 
+		uint8_t* buffer = (uint8_t*)data;
+		uint32_t formatVersion = SaveStateManager::FileFormatVersion;
+		memcpy(buffer, LibretroStateMagic, 3);
+		memcpy(buffer + 3, &formatVersion, sizeof(formatVersion));
+
+		size_t stateSize = LibretroStateHeaderSize + _console->SaveState(buffer + LibretroStateHeaderSize, size - LibretroStateHeaderSize);
+
+		if(stateSize > size) {
+			return false;
+		}
+
+		//Clear the unused part of the buffer to keep the data deterministic (netplay compares states)
+		memset(buffer + stateSize, 0, size - stateSize);
 		return true;
 	}
 
 	RETRO_API bool retro_unserialize(const void *data, size_t size)
 	{
+		const uint8_t* buffer = (const uint8_t*)data;
+		if(size >= LibretroStateHeaderSize && memcmp(buffer, LibretroStateMagic, 3) == 0) {
+			uint32_t formatVersion;
+			memcpy(&formatVersion, buffer + 3, sizeof(formatVersion));
+			if(formatVersion < 14 || formatVersion > SaveStateManager::FileFormatVersion) {
+				return false;
+			}
+			return _console->LoadState(buffer + LibretroStateHeaderSize, size - LibretroStateHeaderSize, formatVersion) > 0;
+		}
+
+		//Regular save state, with a "MST" header (e.g from older versions of the core)
 		std::stringstream ss;
 		ss.write((char*)data, size);
 
@@ -985,6 +1111,12 @@ extern "C" {
 			_inputDevices[port] = device;
 			update_core_controllers();
 			update_input_descriptors();
+
+			if(_saveStateSize != -1) {
+				//Apply the change right away, the controllers' state is part of the save state
+				_console->GetControlManager()->UpdateControlDevices();
+				_saveStateSize = (int32_t)(LibretroStateHeaderSize + _console->GetMaxSaveStateSize());
+			}
 		}
 	}
 
@@ -1036,14 +1168,14 @@ extern "C" {
 			update_core_controllers();
 			update_input_descriptors();
 
-			//Savestates in Mesen may change size over time
-			//Retroarch doesn't like this for netplay or rewinding - it requires the states to always be the exact same size
-			//So we need to send a large enough size to Retroarch to ensure Mesen's state will always fit within that buffer.
-			std::stringstream ss;
-			_console->GetSaveStateManager()->SaveState(ss);
+			//Frontends allocate their buffers based on the first call to retro_serialize_size, so report a size that leaves room for
+			//the state to grow while the game runs (FDS disk writes) - only controller changes can change the reported size
+			_console->GetControlManager()->UpdateControlDevices();
+			_saveStateSize = (int32_t)(LibretroStateHeaderSize + _console->GetMaxSaveStateSize());
+
+			uint64_t quirks = RETRO_SERIALIZATION_QUIRK_CORE_VARIABLE_SIZE | RETRO_SERIALIZATION_QUIRK_ENDIAN_DEPENDENT;
+			retroEnv(RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS, &quirks);
 
-			//Round up to the next 1kb multiple
-			_saveStateSize = ((ss.str().size() * 2) + 0x400) & ~0x3FF;
 			retro_set_memory_maps();
 		}
 
@@ -24,6 +24,20 @@
 #include "../Core/MessageManager.h"
 #include "../Core/ControlManager.h"
 #include "../Core/EmulationSettings.h"
+#include "../Core/Console.h"
+#include "../Core/ConsolePool.h"
+#include "../Core/CPU.h"
+#include "../Core/Snapshotable.h"
+#include "../Core/SaveStateManager.h"
+#include "../Core/PPU.h"
+#include "../Core/DefaultVideoFilter.h"
+#include "../Core/NtscFilter.h"
+#include "../Core/BisqwitNtscFilter.h"
+#include "../Core/RawVideoFilter.h"
+#include "../Core/ScaleFilter.h"
+#include "../Core/MemoryManager.h"
+#include "../Core/BaseMapper.h"
+#include "../Core/DirtyPageTracker.h"
 
 using namespace std;
 
@@ -32,12 +46,15 @@ typedef void (__stdcall *NotificationListenerCallback)(int, void*);
 extern "C" {
 	void __stdcall InitDll();
 	void __stdcall SetFlags(uint64_t flags);
+	void __stdcall ClearFlags(uint64_t flags);
 	void __stdcall InitializeEmu(const char* homeFolder, void*, void*, bool, bool, bool);
 	void __stdcall SetControllerType(uint32_t port, ControllerType type);
 	int __stdcall RunAutomaticTest(char* filename);
 	int __stdcall RunRecordedTest(char* filename);
 	void __stdcall Run();
 	void __stdcall Stop();
+	void __stdcall LoadROM(char* filename, char* patchFile);
+	double __stdcall RunFrames(uint32_t frameCount, bool decodeVideo, bool processAudio, bool sendNotifications);
 	INotificationListener* __stdcall RegisterNotificationCallback(int32_t consoleId, NotificationListenerCallback callback);
 }
 
@@ -46,9 +63,10 @@ std::atomic<int> testIndex;
 vector<string> testFilenames;
 vector<string> failedTests;
 vector<int32_t> failedTestErrorCode;
-SimpleLock lock;
+SimpleLock testLock;
 Timer timer;
 bool automaticTests = false;
+bool ppuCatchUpSync = false;
 
 void RunEmu()
 {
@@ -74,9 +92,9 @@ void __stdcall OnNotificationReceived(int type, void* parameter)
 void RunTest()
 {
 	while(true) {
-		lock.Acquire();
+		testLock.Acquire();
 		size_t index = testIndex++;
-		lock.Release();
+		testLock.Release();
 
 		if(index < testFilenames.size()) {
 			string filepath = testFilenames[index];
@@ -91,15 +109,15 @@ void RunTest()
 				#endif
 			} else {
 				#ifdef _WIN32
-					command = "TestHelper.exe /testrom \"" + filepath + "\"";
+					command = string("TestHelper.exe ") + (ppuCatchUpSync ? "/ppucatchup " : "") + "/testrom \"" + filepath + "\"";
 				#else
-					command = "./testhelper /testrom \"" + filepath + "\"";
+					command = string("./testhelper ") + (ppuCatchUpSync ? "/ppucatchup " : "") + "/testrom \"" + filepath + "\"";
 				#endif
 			}
 
-			lock.Acquire();
+			testLock.Acquire();
 			std::cout << std::to_string(index) << ") " << filename << std::endl;
-			lock.Release();
+			testLock.Release();
 
 			int failedFrames = std::system(command.c_str());
 			#ifdef __GNUC__
@@ -108,11 +126,11 @@ void RunTest()
 
 			if(failedFrames != 0) {
 				//Test failed
-				lock.Acquire();
+				testLock.Acquire();
 				failedTests.push_back(filename);
 				failedTestErrorCode.push_back(failedFrames);
 				std::cout << "  ****  " << std::to_string(index) << ") " << filename << " failed (" << failedFrames << ")" << std::endl;
-				lock.Release();
+				testLock.Release();
 			}
 		} else {
 			break;
@@ -120,6 +138,340 @@ void RunTest()
 	}
 }
 
+//Initializes the emulator in console mode, without any audio/video/input
+void InitializeBenchmark(string mesenFolder)
+{
+	InitDll();
+	SetFlags(EmulationFlags::ConsoleMode);
+	InitializeEmu(mesenFolder.c_str(), nullptr, nullptr, true, true, true);
+}
+
+//Returns a console running the rom (or nullptr if the rom could not be loaded)
+shared_ptr<Console> CreateBenchmarkConsole(string romFilename)
+{
+	shared_ptr<Console> console(new Console());
+	console->Init();
+	if(!console->Initialize(romFilename)) {
+		std::cout << "Could not load " << romFilename << std::endl;
+		return nullptr;
+	}
+	return console;
+}
+
+void RunBenchmark(string mesenFolder, char* romFilename, uint32_t frameCount)
+{
+	InitializeBenchmark(mesenFolder);
+	SetControllerType(0, ControllerType::StandardController);
+	SetControllerType(1, ControllerType::StandardController);
+	LoadROM(romFilename, (char*)"");
+
+	struct BenchmarkConfig {
+		const char* name;
+		bool decodeVideo;
+		bool processAudio;
+		bool sendNotifications;
+	};
+
+	BenchmarkConfig configs[] = {
+		{ "Emulation only", false, false, false },
+		{ "+ Notifications", false, false, true },
+		{ "+ Audio", false, true, true },
+		{ "+ Video decode", true, true, true }
+	};
+
+	for(BenchmarkConfig &cfg : configs) {
+		double fps = RunFrames(frameCount, cfg.decodeVideo, cfg.processAudio, cfg.sendNotifications);
+		std::cout << cfg.name << ": " << std::to_string(fps) << " fps" << std::endl;
+	}
+}
+
+void RunPpuSyncBenchmark(string mesenFolder, char* romFilename, uint32_t frameCount)
+{
+	InitializeBenchmark(mesenFolder);
+	SetControllerType(0, ControllerType::StandardController);
+	SetControllerType(1, ControllerType::StandardController);
+
+	for(int i = 0; i < 2; i++) {
+		if(i == 0) {
+			ClearFlags(EmulationFlags::PpuCatchUpSync);
+		} else {
+			SetFlags(EmulationFlags::PpuCatchUpSync);
+		}
+
+		//Reload the rom to start both runs from the same power on state
+		LoadROM(romFilename, (char*)"");
+		double fps = RunFrames(frameCount, false, false, false);
+		std::cout << (i == 0 ? "Per-cycle PPU sync: " : "Catch-up PPU sync: ") << std::to_string(fps) << " fps" << std::endl;
+	}
+}
+
+void RunCpuFeatureBenchmark(string mesenFolder, string romFilename, uint32_t frameCount)
+{
+	InitializeBenchmark(mesenFolder);
+
+	shared_ptr<Console> console = CreateBenchmarkConsole(romFilename);
+	if(!console) {
+		return;
+	}
+
+	//No debugger/cheats are active, this only measures the cost of the hooks in each CPU instantiation
+	uint8_t features[] = { CpuFeatures::None, CpuFeatures::Debugger, CpuFeatures::Cheats, CpuFeatures::All };
+	const char* names[] = { "None", "Debugger", "Cheats", "Debugger+Cheats" };
+	for(int i = 0; i < 4; i++) {
+		if(i > 0) {
+			//Reload the rom to start every run from the same power on state
+			console->Initialize(romFilename);
+		}
+		console->GetCpu()->SetFeatures(features[i]);
+
+		HeadlessRunResult result = console->RunFrames(frameCount, HeadlessRunOptions());
+		double fps = result.FrameCount / (result.ElapsedMs / 1000);
+		std::cout << names[i] << ": " << std::to_string(fps) << " fps" << std::endl;
+	}
+
+	console->Release(true);
+}
+
+void RunSaveStateBenchmark(string mesenFolder, string romFilename, uint32_t iterations)
+{
+	InitializeBenchmark(mesenFolder);
+
+	shared_ptr<Console> console = CreateBenchmarkConsole(romFilename);
+	if(!console) {
+		return;
+	}
+	console->RunFrames(60, HeadlessRunOptions());
+
+	Timer timer;
+	for(uint32_t i = 0; i < iterations; i++) {
+		stringstream state;
+		console->SaveState(state);
+		console->LoadState(state);
+	}
+	double elapsed = timer.GetElapsedMS();
+	std::cout << "stringstream: " << std::to_string(iterations / (elapsed / 1000)) << " save+load/sec" << std::endl;
+
+	vector<uint8_t> buffer(console->SaveState(nullptr, 0));
+	timer.Reset();
+	for(uint32_t i = 0; i < iterations; i++) {
+		size_t size = console->SaveState(buffer.data(), buffer.size());
+		console->LoadState(buffer.data(), size);
+	}
+	elapsed = timer.GetElapsedMS();
+	std::cout << "Buffer (" << std::to_string(buffer.size()) << " bytes): " << std::to_string(iterations / (elapsed / 1000)) << " save+load/sec" << std::endl;
+
+	console->Release(true);
+}
+
+//Mimics the state of a mapper with a large amount of work ram (plus the usual mapping tables)
+class WorkRamSnapshot : public Snapshotable
+{
+public:
+	vector<uint8_t> WorkRam;
+	uint8_t ChrRam[0x2000] = {};
+	uint32_t PrgPageNumbers[0x100] = {};
+	uint8_t Registers[16] = {};
+
+	WorkRamSnapshot(uint32_t workRamSize) : WorkRam(workRamSize) {}
+
+protected:
+	void StreamState(bool saving) override
+	{
+		ArrayInfo<uint8_t> workRam = { WorkRam.data(), (uint32_t)WorkRam.size() };
+		ArrayInfo<uint8_t> chrRam = { ChrRam, sizeof(ChrRam) };
+		ArrayInfo<uint32_t> prgPages = { PrgPageNumbers, 0x100 };
+		ArrayInfo<uint8_t> registers = { Registers, sizeof(Registers) };
+		Stream(workRam, chrRam, prgPages, registers);
+	}
+};
+
+void RunSnapshotBenchmark(uint32_t workRamKb, uint32_t iterations)
+{
+	WorkRamSnapshot snapshot(workRamKb * 1024);
+	for(size_t i = 0; i < snapshot.WorkRam.size(); i++) {
+		snapshot.WorkRam[i] = (uint8_t)(i * 7);
+	}
+
+	vector<uint8_t> buffer(snapshot.SaveSnapshot(nullptr, 0));
+	Timer timer;
+	for(uint32_t i = 0; i < iterations; i++) {
+		snapshot.SaveSnapshot(buffer.data(), (uint32_t)buffer.size());
+	}
+	double saveMs = timer.GetElapsedMS();
+
+	timer.Reset();
+	for(uint32_t i = 0; i < iterations; i++) {
+		snapshot.LoadSnapshot(buffer.data(), (uint32_t)buffer.size(), SaveStateManager::FileFormatVersion);
+	}
+	double loadMs = timer.GetElapsedMS();
+
+	double mb = (double)buffer.size() * iterations / (1024 * 1024);
+	std::cout << "Work ram: " << std::to_string(workRamKb) << " KB, state size: " << std::to_string(buffer.size()) << " bytes" << std::endl;
+	std::cout << "Save: " << std::to_string(mb / (saveMs / 1000)) << " MB/sec" << std::endl;
+	std::cout << "Load: " << std::to_string(mb / (loadMs / 1000)) << " MB/sec" << std::endl;
+}
+
+void RunPoolBenchmark(string mesenFolder, string romFilename, uint32_t consoleCount, uint32_t frameCount)
+{
+	InitializeBenchmark(mesenFolder);
+
+	vector<shared_ptr<Console>> consoles;
+	for(uint32_t i = 0; i < consoleCount; i++) {
+		shared_ptr<Console> console = CreateBenchmarkConsole(romFilename);
+		if(!console) {
+			return;
+		}
+		consoles.push_back(console);
+	}
+
+	uint32_t maxThreads = std::max<uint32_t>(1, std::thread::hardware_concurrency());
+	for(uint32_t threadCount = 1; ; threadCount = std::min(threadCount * 2, maxThreads)) {
+		ConsolePool pool(threadCount);
+		for(shared_ptr<Console> &console : consoles) {
+			pool.AddConsole(console);
+		}
+
+		Timer timer;
+		pool.RunFrames(frameCount, HeadlessRunOptions());
+		double elapsed = timer.GetElapsedMS();
+
+		double fps = consoleCount * frameCount / (elapsed / 1000);
+		std::cout << std::to_string(threadCount) << " thread(s): " << std::to_string(fps) << " frames/sec (" << std::to_string(fps / consoleCount) << " fps per console)" << std::endl;
+
+		if(threadCount == maxThreads) {
+			break;
+		}
+	}
+
+	for(shared_ptr<Console> &console : consoles) {
+		console->Release(true);
+	}
+}
+
+void RunFilterBenchmark(string mesenFolder, string romFilename, uint32_t frameCount)
+{
+	InitializeBenchmark(mesenFolder);
+
+	shared_ptr<Console> console = CreateBenchmarkConsole(romFilename);
+	if(!console) {
+		return;
+	}
+
+	//Filters are timed on a second's worth of actual frames, taken after the game's first few seconds
+	console->RunFrames(300, HeadlessRunOptions());
+	vector<vector<uint16_t>> frames;
+	for(int i = 0; i < 60; i++) {
+		console->RunFrames(1, HeadlessRunOptions());
+		uint16_t* screen = console->GetPpu()->GetScreenBuffer(false);
+		frames.push_back(vector<uint16_t>(screen, screen + PPU::PixelCount));
+	}
+
+	const char* filterNames[] = {
+		"None", "NTSC (blargg)", "NTSC (Bisqwit, 1/4 res)", "NTSC (Bisqwit, 1/2 res)", "NTSC (Bisqwit)",
+		"xBRZ 2x", "xBRZ 3x", "xBRZ 4x", "xBRZ 5x", "xBRZ 6x", "HQ2x", "HQ3x", "HQ4x", "Scale2x", "Scale3x", "Scale4x",
+		"2xSaI", "Super2xSaI", "SuperEagle", "Prescale 2x", "Prescale 3x", "Prescale 4x", "Prescale 6x", "Prescale 8x", "Prescale 10x", "Raw"
+	};
+
+	for(int i = (int)VideoFilterType::None; i <= (int)VideoFilterType::Raw; i++) {
+		VideoFilterType filterType = (VideoFilterType)i;
+		console->GetSettings()->SetVideoFilterType(filterType);
+
+		//Same setup as VideoDecoder::UpdateVideoFilter (scale filters are applied on the default filter's output)
+		unique_ptr<BaseVideoFilter> filter;
+		shared_ptr<ScaleFilter> scaleFilter;
+		switch(filterType) {
+			case VideoFilterType::NTSC: filter.reset(new NtscFilter(console)); break;
+			case VideoFilterType::BisqwitNtsc: filter.reset(new BisqwitNtscFilter(console, 1)); break;
+			case VideoFilterType::BisqwitNtscHalfRes: filter.reset(new BisqwitNtscFilter(console, 2)); break;
+			case VideoFilterType::BisqwitNtscQuarterRes: filter.reset(new BisqwitNtscFilter(console, 4)); break;
+			case VideoFilterType::Raw: filter.reset(new RawVideoFilter(console)); break;
+			default:
+				filter.reset(new DefaultVideoFilter(console));
+				scaleFilter = ScaleFilter::GetScaleFilter(filterType);
+				break;
+		}
+
+		//Multi-threaded filters are timed with 1, 2, 4 and 8 threads
+		bool multiThreaded = scaleFilter != nullptr || filterType == VideoFilterType::NTSC || filterType == VideoFilterType::BisqwitNtsc || filterType == VideoFilterType::BisqwitNtscHalfRes || filterType == VideoFilterType::BisqwitNtscQuarterRes;
+		for(uint32_t threadCount = 1; threadCount <= (multiThreaded ? 8u : 1u); threadCount *= 2) {
+			console->GetSettings()->SetVideoFilterThreadCount(threadCount);
+
+			Timer timer;
+			for(uint32_t frame = 0; frame < frameCount; frame++) {
+				filter->SendFrame(frames[frame % frames.size()].data(), frame);
+				if(scaleFilter) {
+					FrameInfo frameInfo = filter->GetFrameInfo();
+					scaleFilter->ApplyFilter(filter->GetOutputBuffer(), frameInfo.Width, frameInfo.Height, 0, threadCount);
+				}
+			}
+			double elapsed = timer.GetElapsedMS();
+
+			std::cout << filterNames[i];
+			if(multiThreaded) {
+				std::cout << " (" << std::to_string(threadCount) << " thread(s))";
+			}
+			std::cout << ": " << std::to_string((uint64_t)(elapsed * 1000000 / frameCount)) << " ns/frame" << std::endl;
+		}
+	}
+
+	console->GetSettings()->SetVideoFilterThreadCount(0);
+
+	console->Release(true);
+}
+
+//Checks that CPU/PPU writes flag the matching dirty pages and that resetting the tracker clears them (returns 1 on failure)
+int RunDirtyPageTest(string mesenFolder, string romFilename)
+{
+	InitializeBenchmark(mesenFolder);
+
+	shared_ptr<Console> console = CreateBenchmarkConsole(romFilename);
+	if(!console) {
+		return 1;
+	}
+	console->RunFrames(60, HeadlessRunOptions());
+
+	int failCount = 0;
+	auto check = [&failCount](bool result, const char* name) {
+		std::cout << (result ? "Passed: " : "Failed: ") << name << std::endl;
+		if(!result) {
+			failCount++;
+		}
+	};
+
+	DirtyPageTracker* tracker = console->SubscribeDirtyPageTracking();
+	check(tracker->HasDirtyPages(DebugMemoryType::InternalRam), "all pages are dirty after subscribing");
+
+	tracker->Reset();
+	check(!tracker->HasDirtyPages(DebugMemoryType::InternalRam) && !tracker->HasDirtyPages(DebugMemoryType::NametableRam), "no pages are dirty after a reset");
+
+	//CPU write to $0305 (internal RAM page 3)
+	console->GetMemoryManager()->Write(0x0305, 0x12, MemoryOperationType::Write);
+	vector<uint32_t> pages;
+	tracker->GetDirtyPages(DebugMemoryType::InternalRam, pages);
+	check(pages.size() == 1 && pages[0] == 3, "a CPU write flags its internal RAM page");
+
+	//PPU write to the first byte of the first nametable
+	console->GetMapper()->WriteVRAM(0x2000, 0x34);
+	PpuAddressTypeInfo addressInfo;
+	console->GetMapper()->GetPpuAbsoluteAddressAndType(0x2000, &addressInfo);
+	if(addressInfo.Type == PpuAddressType::NametableRam) {
+		check(tracker->IsPageDirty(DebugMemoryType::NametableRam, addressInfo.Address >> DirtyPageTracker::PageShift), "a PPU write flags its nametable page");
+	}
+
+	tracker->Reset(DebugMemoryType::InternalRam);
+	check(!tracker->HasDirtyPages(DebugMemoryType::InternalRam), "resetting a memory type clears its pages");
+	check(addressInfo.Type != PpuAddressType::NametableRam || tracker->HasDirtyPages(DebugMemoryType::NametableRam), "resetting a memory type keeps the other types' pages");
+
+	tracker->Reset();
+	check(!tracker->HasDirtyPages(DebugMemoryType::InternalRam) && !tracker->HasDirtyPages(DebugMemoryType::NametableRam), "a reset clears all pages");
+
+	console->UnsubscribeDirtyPageTracking();
+	check(console->GetDirtyPageTracker() == nullptr, "unsubscribing disables tracking");
+
+	console->Release(true);
+	return failCount > 0 ? 1 : 0;
+}
+
 #ifdef __GNUC__
 	void handler(int sig) {
 		void *array[20];
@@ -142,6 +494,60 @@ int main(int argc, char* argv[])
 		signal(SIGSEGV, handler);		
 	#endif
 
+	if(argc >= 3 && strcmp(argv[1], "/benchmark") == 0) {
+		//Usage: /benchmark <rom> [frame count]
+		RunBenchmark(mesenFolder, argv[2], argc >= 4 ? (uint32_t)std::stoul(argv[3]) : 3000);
+		return 0;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "/ppusyncbenchmark") == 0) {
+		//Usage: /ppusyncbenchmark <rom> [frame count]
+		RunPpuSyncBenchmark(mesenFolder, argv[2], argc >= 4 ? (uint32_t)std::stoul(argv[3]) : 3000);
+		return 0;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "/cpufeaturebenchmark") == 0) {
+		//Usage: /cpufeaturebenchmark <rom> [frame count]
+		RunCpuFeatureBenchmark(mesenFolder, argv[2], argc >= 4 ? (uint32_t)std::stoul(argv[3]) : 3000);
+		return 0;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "/savestatebenchmark") == 0) {
+		//Usage: /savestatebenchmark <rom> [iterations]
+		RunSaveStateBenchmark(mesenFolder, argv[2], argc >= 4 ? (uint32_t)std::stoul(argv[3]) : 10000);
+		return 0;
+	}
+
+	if(argc >= 2 && strcmp(argv[1], "/snapshotbenchmark") == 0) {
+		//Usage: /snapshotbenchmark [work ram size in KB] [iterations]
+		RunSnapshotBenchmark(argc >= 3 ? (uint32_t)std::stoul(argv[2]) : 512, argc >= 4 ? (uint32_t)std::stoul(argv[3]) : 1000);
+		return 0;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "/filterbenchmark") == 0) {
+		//Usage: /filterbenchmark <rom> [frame count]
+		RunFilterBenchmark(mesenFolder, argv[2], argc >= 4 ? (uint32_t)std::stoul(argv[3]) : 600);
+		return 0;
+	}
+
+	if(argc >= 2 && strcmp(argv[1], "/ppucatchup") == 0) {
+		//Usage: /ppucatchup [test folder] - runs the recorded tests with catch-up PPU sync enabled, results must match the normal mode
+		ppuCatchUpSync = true;
+		argv++;
+		argc--;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "/poolbenchmark") == 0) {
+		//Usage: /poolbenchmark <rom> [console count] [frame count]
+		RunPoolBenchmark(mesenFolder, argv[2], argc >= 4 ? (uint32_t)std::stoul(argv[3]) : 32, argc >= 5 ? (uint32_t)std::stoul(argv[4]) : 600);
+		return 0;
+	}
+
+	if(argc >= 3 && strcmp(argv[1], "/dirtypagetest") == 0) {
+		//Usage: /dirtypagetest <rom>
+		return RunDirtyPageTest(mesenFolder, argv[2]);
+	}
+
 	if(argc >= 3 && strcmp(argv[1], "/auto") == 0) {
 		string romFolder = argv[2];
 		testFilenames = FolderUtilities::GetFilesInFolder(romFolder, { ".nes" }, true);
@@ -191,7 +597,10 @@ int main(int argc, char* argv[])
 	} else if(argc == 3) {
 		char* testFilename = argv[2];
 		InitDll();
-		SetFlags(0x8000000000000000); //EmulationFlags::ConsoleMode
+		SetFlags(EmulationFlags::ConsoleMode);
+		if(ppuCatchUpSync) {
+			SetFlags(EmulationFlags::PpuCatchUpSync);
+		}
 		InitializeEmu(mesenFolder.c_str(), nullptr, nullptr, false, false, false);
 		RegisterNotificationCallback(0, (NotificationListenerCallback)OnNotificationReceived);
 		SetControllerType(0, ControllerType::StandardController);
@@ -5,6 +5,11 @@
 #include <Windows.h>
 #endif
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
 bool PlatformUtilities::_highResTimerEnabled = false;
 
 void PlatformUtilities::DisableScreensaver()
@@ -42,4 +47,32 @@ void PlatformUtilities::RestoreTimerResolution()
 		_highResTimerEnabled = false;
 	}
 	#endif
+}
+
+bool PlatformUtilities::IsAvx2Supported()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	static bool supported = []() {
+		int info[4];
+		__cpuid(info, 0);
+		if(info[0] < 7) {
+			return false;
+		}
+
+		//AVX needs OSXSAVE and the OS must save the YMM registers on context switches
+		__cpuid(info, 1);
+		if(!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 0x06) != 0x06) {
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}();
+	return supported;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	static bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+#else
+	return false;
+#endif
 }
\ No newline at end of file
@@ -1,6 +1,16 @@
 #pragma once
 #include "stdafx.h"
 
+#if defined(_M_X64) || defined(__x86_64__)
+	//Functions marked with AVX2_TARGET can use AVX2 intrinsics, they must only be called when IsAvx2Supported() returns true
+	#define HAS_AVX2_TARGET
+	#ifdef _MSC_VER
+		#define AVX2_TARGET
+	#else
+		#define AVX2_TARGET __attribute__((target("avx2")))
+	#endif
+#endif
+
 class PlatformUtilities
 {
 private:
@@ -12,4 +22,7 @@ public:
 
 	static void EnableHighResolutionTimer();
 	static void RestoreTimerResolution();
+
+	//True when the CPU (and OS) support AVX2 - code paths that use it must be compiled with the AVX2 target enabled
+	static bool IsAvx2Supported();
 };
\ No newline at end of file
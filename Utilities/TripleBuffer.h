@@ -0,0 +1,70 @@
+#pragma once
+#include "stdafx.h"
+
+//Lock-free triple buffering between a single producer thread and a single consumer thread.
+//The buffers themselves are owned by the caller, this only hands out the indexes (0-2) of the buffer each side may use:
+//the producer always has a buffer to write to and the consumer always gets the newest complete buffer - neither side ever waits.
+class TripleBuffer
+{
+private:
+	static constexpr uint8_t IndexMask = 0x03;
+	static constexpr uint8_t NewDataFlag = 0x04;
+
+	//Index of the buffer that holds the newest complete data, along with NewDataFlag until the consumer takes it
+	atomic<uint8_t> _pendingIndex;
+	atomic<uint32_t> _droppedCount;
+
+	uint8_t _producerIndex; //Only used by the producer thread
+	uint8_t _consumerIndex; //Only used by the consumer thread
+
+public:
+	TripleBuffer()
+	{
+		_producerIndex = 0;
+		_consumerIndex = 1;
+		_pendingIndex = 2;
+		_droppedCount = 0;
+	}
+
+	//Buffer the producer is currently writing to
+	uint8_t GetProducerIndex()
+	{
+		return _producerIndex;
+	}
+
+	//Makes the producer's buffer the newest data and gives the producer another buffer to write to.
+	//Returns false when the previous data was replaced before the consumer took it (i.e it was dropped)
+	bool Publish()
+	{
+		uint8_t previous = _pendingIndex.exchange(_producerIndex | NewDataFlag);
+		_producerIndex = previous & IndexMask;
+		if(previous & NewDataFlag) {
+			_droppedCount++;
+			return false;
+		}
+		return true;
+	}
+
+	//Takes the newest data, if anything was published since the last call (returns false otherwise)
+	bool Consume()
+	{
+		if(!(_pendingIndex.load() & NewDataFlag)) {
+			return false;
+		}
+
+		//Only the consumer clears the flag, so the exchange returns new data even if the producer published again in the meantime
+		_consumerIndex = _pendingIndex.exchange(_consumerIndex) & IndexMask;
+		return true;
+	}
+
+	//Buffer the consumer got from the last successful Consume call
+	uint8_t GetConsumerIndex()
+	{
+		return _consumerIndex;
+	}
+
+	uint32_t GetDroppedCount()
+	{
+		return _droppedCount;
+	}
+};